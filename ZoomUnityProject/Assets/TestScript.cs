@@ -47,12 +47,22 @@ public class TestScript : MonoBehaviour
     // authorization
     [DllImport(dll, CallingConvention = CallingConvention.Cdecl)]
     private static extern int GetAuth(string token, bool useDefault);
-    [DllImport(dll)]
-    private static extern int GetAuthCode(); //returns 0 on successful authorization
 
-    // retrieves meeting status
+    // sdk callbacks queued since the last frame, auth and meeting status included
+    // order matches SDKEventType in sdk_event_queue.h
+    public enum SDKEventType { Dropped, AuthResult, MeetingStatus, UserJoin, UserLeft, HostChange, HandStatus, UserNameChanged, StatisticsWarning }
+    // layout matches SDKEvent in sdk_event_queue.h
+    [StructLayout(LayoutKind.Sequential)]
+    public struct SDKEvent
+    {
+        public uint type; // SDKEventType
+        public int value; // AuthResult (0 = success), MeetingStatus, 1 = hand raised, events lost for Dropped
+        public int result;
+        public uint userId;
+        public long timestampUs;
+    }
     [DllImport(dll)]
-    private static extern int GetMeetingCode();
+    private static extern uint DrainEvents([Out] SDKEvent[] events, uint capacity);
 
     // join
     [DllImport(dll, CallingConvention = CallingConvention.Cdecl)]
@@ -89,10 +99,14 @@ public class TestScript : MonoBehaviour
     [DllImport(dll)]
     private static extern int GetCamerasCount();
     [DllImport(dll)]
-    private static extern IntPtr GetCameraName(int pos);
+    private static extern uint GetCameraNameHandle(int pos);
+
+    // names and device labels as handles into a native UTF-8 table, see lookupString
+    [DllImport(dll)]
+    private static extern int GetStringBytes(uint handle, byte[] buffer, uint capacity); // returns the length, -1 = handle from before the last Join
     [DllImport(dll, CallingConvention = CallingConvention.Cdecl)]
     private static extern void SelectNewCam(int pos);
-    
+
     // Initializing and retrieving window handle
     private System.IntPtr ptr = System.IntPtr.Zero;
 
@@ -113,6 +127,10 @@ public class TestScript : MonoBehaviour
     private bool checkingAuth;
     private bool authComplete;
     private bool authorized = false;
+    private int meetingCode = -1;
+    private SDKEvent[] sdkEvents = new SDKEvent[64];
+    private System.Collections.Generic.Dictionary<uint, string> strings = new System.Collections.Generic.Dictionary<uint, string>();
+    private byte[] stringBytes = new byte[256];
 
     private void Start()
     {
@@ -177,8 +195,6 @@ public class TestScript : MonoBehaviour
         Debug.Log("Init: " + getSDKError(Init()));
         // authorize
         Debug.Log("Auth: " + getSDKError(GetAuth(jwtToken, useDefaultJWTToken)));
-        // get meeting status
-        Debug.Log(translateMC(GetMeetingCode()));
         checkingAuth = true;
         loading.gameObject.SetActive(true);
     }
@@ -234,42 +250,103 @@ public class TestScript : MonoBehaviour
 
     void Update(){
 
-        //checks for when the user has been successfully authenticated
-        if (checkingAuth)
+        //handles everything the sdk reported since the last frame, in order
+        uint count;
+        do
         {
-            if(GetAuthCode() == 0)
+            count = DrainEvents(sdkEvents, (uint)sdkEvents.Length);
+            for (uint i = 0; i < count; i++)
             {
-                authComplete = true;
-                checkingAuth = false;
-                Debug.Log("can now join rooms");
-                loading.gameObject.SetActive(false);
-                joinPanel.SetActive(true);
+                OnSDKEvent(sdkEvents[i]);
             }
-        }
-        
-        
-        if(authorized){
-            //prints meeting status
-            Debug.Log(translateMC(GetMeetingCode()));
+        } while (count == sdkEvents.Length);
+    }
 
-            if(GetMeetingCode() == 3){ //if successfully joined meeting
-                meetingPanel.SetActive(true);
+    private void OnSDKEvent(SDKEvent e)
+    {
+        switch ((SDKEventType)e.type)
+        {
+            case SDKEventType.AuthResult:
+                //checks for when the user has been successfully authenticated
+                if (checkingAuth && e.value == 0)
+                {
+                    authComplete = true;
+                    checkingAuth = false;
+                    Debug.Log("can now join rooms");
+                    loading.gameObject.SetActive(false);
+                    joinPanel.SetActive(true);
+                }
+                break;
 
-                //populates list of camera devices
-                int cameraCount = GetCamerasCount();
-                for (int i = 0; i < cameraCount; i++)
+            case SDKEventType.MeetingStatus:
+                meetingCode = e.value;
+                //prints meeting status
+                Debug.Log(translateMC(meetingCode));
+                if (authorized && meetingCode == 3)
                 {
-                    Dropdown.OptionData cameras = new Dropdown.OptionData();
-                    cameras.text = Marshal.PtrToStringAnsi(GetCameraName(i));
-                    options.options.Add(cameras);
+                    OnMeetingJoined();
                 }
+                break;
 
+            case SDKEventType.UserJoin:
+                Debug.Log("user joined: " + e.userId);
+                break;
 
-                authorized = false;
-            }
+            case SDKEventType.UserLeft:
+                Debug.Log("user left: " + e.userId);
+                break;
+
+            case SDKEventType.UserNameChanged:
+                Debug.Log("user " + e.userId + " is now " + lookupString((uint)e.value));
+                break;
+
+            case SDKEventType.Dropped:
+                Debug.Log(e.value + " sdk events were lost");
+                break;
+        }
+    }
+
+    //the text of a string table handle, copied from the dll only the first time the handle is seen
+    private string lookupString(uint handle){
+        string text;
+        if (handle == 0)
+        {
+            return "";
+        }
+        if (strings.TryGetValue(handle, out text))
+        {
+            return text;
         }
 
+        int length = GetStringBytes(handle, stringBytes, (uint)stringBytes.Length);
+        if (length > stringBytes.Length)
+        {
+            stringBytes = new byte[length];
+            length = GetStringBytes(handle, stringBytes, (uint)stringBytes.Length);
+        }
+        if (length < 0)
+        {
+            return "";
+        }
+        text = System.Text.Encoding.UTF8.GetString(stringBytes, 0, length);
+        strings[handle] = text;
+        return text;
+    }
+
+    //shows the meeting controls once the meeting has been joined
+    private void OnMeetingJoined(){
+        meetingPanel.SetActive(true);
+
+        //populates list of camera devices
+        int cameraCount = GetCamerasCount();
+        for (int i = 0; i < cameraCount; i++)
+        {
+            Dropdown.OptionData cameras = new Dropdown.OptionData();
+            cameras.text = lookupString(GetCameraNameHandle(i));
+            options.options.Add(cameras);
+        }
 
+        authorized = false;
     }
 
     void OnDestroy()
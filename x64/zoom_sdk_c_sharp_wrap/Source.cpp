@@ -8,11 +8,38 @@
 
 namespace ZOOM_SDK_DOTNET_WRAP {
 
-	static int authCode = -1;
-	static int meetingCode = -1;
-	static int recordingCode = -1;
-	static gcroot <array<unsigned int>^> participantList;
 	static unsigned int myUserID = -1;
+	//the sdk callbacks are added once, adding them again would queue every event twice
+	static bool authEventsAdded = false;
+	static bool meetingEventsAdded = false;
+
+	//filters for the outgoing camera, see StartVideoFilters
+	static ZOOMSDK::CRawDataBrightnessContrastFilter brightnessFilter;
+	static ZOOMSDK::CRawDataBackgroundDimFilter backgroundDimFilter;
+	static ZOOMSDK::CRawDataVignetteFilter vignetteFilter;
+
+	//The Unity sample, ZoomUnityProject/Assets/TestScript.cs, only imports what it calls. The other exports are
+	//documented where they are defined below:
+	//  participants: GetMyUserID, GetParticipantsSnapshot, GetUserNameHandle, GetRoster, GetRosterChanges
+	//  devices: GetCameraName, the sample reads camera names through GetCameraNameHandle
+	//  video level of detail: InitVideoLOD, SetVideoLODHysteresis, SetUserScreenSize, SetVideoLODDistanceReference,
+	//    SetUserDistance, RemoveLODUser, UpdateVideoLOD, GetUserVideoResolution, UninitVideoLOD
+	//  raw video frames: AcquireFrame, ReleaseFrame
+	//  share tiles: StartShareTiles, PollShareTiles, GetDirtyTiles, StopShareTiles
+	//  video atlas: InitVideoAtlas, SetVideoAtlasChangeDetection, ComposeVideoAtlas, GetVideoAtlasBuffer,
+	//    GetVideoAtlasLayoutVersion, GetVideoAtlasRects, GetVideoAtlasRect, UninitVideoAtlas
+	//  avatar camera: StartAvatarCamera, PushAvatarFrame, GetAvatarCameraSize, UpdateAvatarCameraQuality, StopAvatarCamera
+	//  venue share: StartVenueShare, PushVenueFrame, StopVenueShare
+	//  camera filters: StartVideoFilters, SetVideoBrightnessContrast, SetVideoBackgroundDim, SetVideoVignette,
+	//    GetVideoFilterTime, StopVideoFilters
+	//  speaker audio: StartSpeakerAudio, ReadSpeakerAudio, GetSpeakerSampleRate, GetActiveSpeakers, GetSpeakerLevels,
+	//    GetSpeakerVisemes, StopSpeakerAudio
+	//  audio recording: StartAudioRecording, StopAudioRecording, GetAudioRecordingLost
+	//  fixture recording: StartFixtureRecording, StopFixtureRecording, GetFixtureRecordCount
+	//  spatial voice: SetSpatialListener, SetSpatialSource, RemoveSpatialSource, SetSpatialDistance, MixSpatialAudio
+	//On the C# side, structs passed by pointer are [StructLayout(LayoutKind.Sequential)] copies of the struct of
+	//the same name in the wrap headers, pointers the dll writes one value to are out parameters, arrays it fills
+	//are [Out] arrays, and returned buffers are IntPtr.
 
 	extern "C" {
 
@@ -38,44 +65,96 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 
 
 		//Get various status codes methods
-		
-		DllExport int GetAuthCode() {
-			return authCode;
-		}
 
-		DllExport int GetMeetingCode() {
-			return meetingCode;
+		// copies up to capacity of the sdk events queued since the last call, in the order they happened, see
+		// SDKEventType in sdk_event_queue.h. Call it until it returns less than capacity to empty the queue.
+		DllExport unsigned int DrainEvents(ZOOMSDK::SDKEvent* events, unsigned int capacity) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Drain(events, capacity);
 		}
 
 		DllExport unsigned int GetMyUserID() {
 			if (myUserID != -1) { // if user ID has already been initialized, return it
 				return myUserID;
 			}
-			else {
-				array<unsigned int >^ userIDs = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->GetParticipantsList();
-				int userCount = userIDs->Length;
-				for (int i = 0; i < userCount; i++) {
-					IUserInfoDotNetWrap^ participant = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->GetUserByUserID(i);
-					if (participant->IsMySelf()) {
-						myUserID = participant->GetUserID();
-						return myUserID;
-					}
-				}
+			ZOOMSDK::IUserInfo* self = ZOOMSDK::CMeetingParticipantsSnapshot::GetMySelf(ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController());
+			if (self) {
+				myUserID = self->GetUserID();
 			}
+			return myUserID;
+		}
+
+		// fills one entry per participant of each array, flags are ParticipantFlag bits and roles UserRole values, see
+		// meeting_participants_snapshot.h. flags, voiceLevels and roles may be null. Returns the number of participants,
+		// when that is more than capacity only the first capacity were written and the arrays should grow.
+		DllExport unsigned int GetParticipantsSnapshot(unsigned int* userIds, unsigned int* flags, int* voiceLevels, int* roles, unsigned int capacity) {
+			return ZOOMSDK::CMeetingParticipantsSnapshot::Take(ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController(),
+				userIds, flags, voiceLevels, roles, capacity);
+		}
+
+		// handle of the user's name in the string table, 0 when the user is not in the meeting
+		DllExport unsigned int GetUserNameHandle(unsigned int userId) {
+			ZOOMSDK::IUserInfo* user = ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController().GetUserByUserID(userId);
+			return user ? ZOOMSDK::CSDKWrap::GetInst().GetStringTable().Intern(user->GetUserName()) : 0;
+		}
+
+		// copies the UTF-8 bytes of a name or device label handle, without a terminating zero. Returns the length, which
+		// may be more than capacity, or -1 for a handle from before the last Join.
+		DllExport int GetStringBytes(unsigned int handle, unsigned char* buffer, unsigned int capacity) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetStringTable().CopyString(handle, (char*)buffer, capacity);
+		}
+
+		// the roster kept from the participant callbacks, flags hold the ParticipantFlag bits it tracks. Returns the number
+		// of participants, version gets what to pass to GetRosterChanges next.
+		DllExport unsigned int GetRoster(unsigned int* userIds, unsigned int* flags, unsigned int capacity, unsigned long long* version) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetParticipantsRoster().GetRoster(userIds, flags, capacity, version);
+		}
+
+		// the participants changed after sinceVersion with their current flags, ParticipantFlag_Left for those gone.
+		// Returns how many were written, call again from version while that equals capacity. -1 means sinceVersion is
+		// too old and GetRoster has to be read again.
+		DllExport int GetRosterChanges(unsigned long long sinceVersion, unsigned int* userIds, unsigned int* flags, unsigned int capacity, unsigned long long* version) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetParticipantsRoster().GetChanges(sinceVersion, userIds, flags, capacity, version);
 		}
 
-		//various callbacks
+		//various callbacks, queued for DrainEvents
 
 		void AuthReturn(AuthResult ret) {
-			authCode = (int)ret;
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_AuthResult, (int)ret);
 		}
 		
 		void MeetingStatusCB(MeetingStatus status, int iResult) {
-			meetingCode = (int)status;
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_MeetingStatus, (int)status, iResult);
+		}
+
+		void StatisticsWarningCB(StatisticsWarningType type) {
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_StatisticsWarning, (int)type);
 		}
 
 		void UserJoinCB(array<unsigned int>^ userIds) {
-			participantList = userIds;
+			for (int i = 0; i < userIds->Length; i++)
+				ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_UserJoin, 0, 0, userIds[i]);
+		}
+
+		void UserLeftCB(array<unsigned int>^ userIds) {
+			for (int i = 0; i < userIds->Length; i++)
+				ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_UserLeft, 0, 0, userIds[i]);
+		}
+
+		void HostChangeCB(unsigned int userId) {
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_HostChange, 0, 0, userId);
+		}
+
+		void HandStatusCB(bool bLow, unsigned int userId) {
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_HandStatus, bLow ? 0 : 1, 0, userId);
+		}
+
+		void UserNameChangedCB(unsigned int userId, String^ userName) {
+			uint32_t name = 0;
+			if (userName != nullptr) {
+				pin_ptr<const wchar_t> chars = PtrToStringChars(userName);
+				name = ZOOMSDK::CSDKWrap::GetInst().GetStringTable().Intern(chars);
+			}
+			ZOOMSDK::CSDKWrap::GetInst().GetEventQueue().Push(ZOOMSDK::SDKEvent_UserNameChanged, (int)name, 0, userId);
 		}
 
 		//methods relating to functionalities
@@ -84,8 +163,11 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 			//create callback for authentication
 			String^ jwtToken = gcnew String(token);
 			
-			onAuthenticationReturn^ authFunc = gcnew onAuthenticationReturn(AuthReturn);
-			CZoomSDKeDotNetWrap::Instance->GetAuthServiceWrap()->Add_CB_onAuthenticationReturn(authFunc);
+			if (!authEventsAdded) {
+				onAuthenticationReturn^ authFunc = gcnew onAuthenticationReturn(AuthReturn);
+				CZoomSDKeDotNetWrap::Instance->GetAuthServiceWrap()->Add_CB_onAuthenticationReturn(authFunc);
+				authEventsAdded = true;
+			}
 			
 			SDKError result;
 
@@ -123,12 +205,24 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 			param.userType = SDKUserType::SDK_UT_WITHOUT_LOGIN;
 			param.withoutloginJoin = join_param;
 
-			//create callback for when meeting status code changes
-			onMeetingStatusChanged^ meetingChangeCb = gcnew onMeetingStatusChanged(MeetingStatusCB);
-			CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->Add_CB_onMeetingStatusChanged(meetingChangeCb);
-			
-			onUserJoin^ userJoinCb = gcnew onUserJoin(UserJoinCB);
-			CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->Add_CB_onUserJoin(userJoinCb);
+			//create callbacks for when meeting status code and participants change
+			if (!meetingEventsAdded) {
+				IMeetingServiceDotNetWrap^ meetingService = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap();
+				meetingService->Add_CB_onMeetingStatusChanged(gcnew onMeetingStatusChanged(MeetingStatusCB));
+				meetingService->Add_CB_onMeetingStatisticsWarningNotification(gcnew onMeetingStatisticsWarningNotification(StatisticsWarningCB));
+
+				IMeetingParticipantsControllerDotNetWrap^ participants = meetingService->GetMeetingParticipantsController();
+				participants->Add_CB_onUserJoin(gcnew onUserJoin(UserJoinCB));
+				participants->Add_CB_onUserLeft(gcnew onUserLeft(UserLeftCB));
+				participants->Add_CB_onHostChangeNotification(gcnew onHostChangeNotification(HostChangeCB));
+				participants->Add_CB_onLowOrRaiseHandStatusChanged(gcnew onLowOrRaiseHandStatusChanged(HandStatusCB));
+				participants->Add_CB_onUserNameChanged(gcnew onUserNameChanged(UserNameChangedCB));
+				meetingEventsAdded = true;
+			}
+
+			//the roster and the strings start over with the participants of this meeting
+			ZOOMSDK::CSDKWrap::GetInst().GetParticipantsRoster().Reset();
+			ZOOMSDK::CSDKWrap::GetInst().GetStringTable().Reset();
 
 			//join meeting
 			SDKError err = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->Join(param);
@@ -235,6 +329,218 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 		}
 
 
+		//raw video level of detail: the host reports how large every participant is drawn, and the
+		//scheduler subscribes each of them at a fitting resolution within a pixel budget
+
+		DllExport int InitVideoLOD(unsigned int budgetPixels, unsigned int maxSubscriptions) {
+			ZOOMSDK::CSDKRendererWrap& renderer = ZOOMSDK::CSDKRendererWrap::GetInst();
+			if (!renderer.GetRendererManager().IsInited()) {
+				ZOOMSDK::SDKError err = renderer.GetRendererManager().Init();
+				if (err != ZOOMSDK::SDKERR_SUCCESS) {
+					return (int)err;
+				}
+			}
+			renderer.GetLODScheduler().SetBudget(budgetPixels, maxSubscriptions);
+			return 0;
+		}
+
+		DllExport void SetVideoLODHysteresis(float margin, unsigned int holdMs) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().SetHysteresis(margin, holdMs);
+		}
+
+		// pixels is the on-screen height of the user's video, 0 when it is not visible
+		DllExport void SetUserScreenSize(unsigned int userID, float pixels) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().SetUserScreenSize(userID, pixels);
+		}
+
+		// the on-screen height of a user one unit away from the camera, for SetUserDistance. Set it again when the
+		// camera's field of view or the screen size changes
+		DllExport void SetVideoLODDistanceReference(float pixelsAtUnitDistance) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().SetDistanceReference(pixelsAtUnitDistance);
+		}
+
+		// distance from the camera, 0 when the user is not visible
+		DllExport void SetUserDistance(unsigned int userID, float distance) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().SetUserDistance(userID, distance);
+		}
+
+		DllExport void RemoveLODUser(unsigned int userID) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().RemoveUser(userID);
+		}
+
+		// call once per frame, returns how many subscriptions changed
+		DllExport int UpdateVideoLOD() {
+			ZOOMSDK::CSDKRendererWrap& renderer = ZOOMSDK::CSDKRendererWrap::GetInst();
+			if (!renderer.GetRendererManager().IsInited()) {
+				return -1;
+			}
+			return (int)renderer.GetLODScheduler().Update(renderer.GetRendererManager());
+		}
+
+		// returns the ZoomSDKResolution the user is subscribed at, -1 when not subscribed
+		DllExport int GetUserVideoResolution(unsigned int userID) {
+			ZOOMSDK::ZoomSDKResolution res = ZOOMSDK::CSDKRendererWrap::GetInst().GetLODScheduler().GetUserResolution(userID);
+			return res == ZOOMSDK::ZoomSDKResolution_NoUse ? -1 : (int)res;
+		}
+
+		DllExport void UninitVideoLOD() {
+			ZOOMSDK::CSDKRendererWrap& renderer = ZOOMSDK::CSDKRendererWrap::GetInst();
+			renderer.GetLODScheduler().RemoveAllUsers();
+			if (renderer.GetRendererManager().IsInited()) {
+				renderer.GetLODScheduler().Update(renderer.GetRendererManager());
+				renderer.GetRendererManager().Uninit();
+			}
+		}
+
+
+		//raw video frames without copies: AcquireFrame lends the newest frame of a subscribed user, the planes
+		//stay valid until ReleaseFrame, the next AcquireFrame for that user or the user being unsubscribed.
+		//C# can wrap them as NativeArray<byte> and upload them straight into textures.
+
+		// returns 1 when a frame was leased, 0 when there is no new frame, -1 when the user is not subscribed
+		DllExport int AcquireFrame(unsigned int userID, ZOOMSDK::RawDataFrameLease* desc) {
+			if (desc == NULL) {
+				return -1;
+			}
+			ZOOMSDK::CRawDataRendererManager& manager = ZOOMSDK::CSDKRendererWrap::GetInst().GetRendererManager();
+			if (!manager.IsSubscribed(userID)) {
+				memset(desc, 0, sizeof(ZOOMSDK::RawDataFrameLease));
+				return -1;
+			}
+			return manager.AcquireLease(userID, *desc) ? 1 : 0;
+		}
+
+		DllExport void ReleaseFrame(unsigned long long handle) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetRendererManager().ReleaseLease(handle);
+		}
+
+
+		//received screen share as dirty tiles: only the parts of the share that changed since the last poll are
+		//converted and handed out, so several in-world surfaces can show it by updating one texture.
+
+		// resolution is a ZoomSDKResolution, format 0 for RGBA32 and 1 for BGRA32. flipVertical stores the rects
+		// bottom-up, as Texture2D expects. Replaces the previous sharer. Returns an SDKError code
+		DllExport int StartShareTiles(unsigned int sharerUserID, int resolution, int format, bool flipVertical) {
+			if (format != ZOOMSDK::RawDataPixelFormat_RGBA32 && format != ZOOMSDK::RawDataPixelFormat_BGRA32) {
+				return (int)ZOOMSDK::SDKERR_INVALID_PARAMETER;
+			}
+			ZOOMSDK::CRawDataShareTileStream& stream = ZOOMSDK::CSDKRendererWrap::GetInst().GetShareTileStream();
+			stream.GetTracker().SetOutputFormat((ZOOMSDK::RawDataPixelFormat)format, flipVertical);
+			return (int)stream.Subscribe(sharerUserID, (ZOOMSDK::ZoomSDKResolution)resolution);
+		}
+
+		// diffs the newest share frame, once per frame. Returns how many dirty rects GetDirtyTiles hands out, 0 when
+		// nothing changed. width and height are the size of the share, the texture the rects go into
+		DllExport unsigned int PollShareTiles(unsigned int* width, unsigned int* height) {
+			ZOOMSDK::CRawDataShareTileStream& stream = ZOOMSDK::CSDKRendererWrap::GetInst().GetShareTileStream();
+			unsigned int count = stream.Poll();
+			if (width) {
+				*width = stream.GetTracker().GetFrameWidth();
+			}
+			if (height) {
+				*height = stream.GetTracker().GetFrameHeight();
+			}
+			return count;
+		}
+
+		// copies up to maxCount rects of the last poll and returns how many were written. The pixels of every
+		// rect are in pixels at its offset, width * 4 bytes per row, valid until the next PollShareTiles
+		DllExport unsigned int GetDirtyTiles(ZOOMSDK::RawDataDirtyRect* rects, unsigned int maxCount, const unsigned char** pixels) {
+			ZOOMSDK::CRawDataShareTileTracker& tracker = ZOOMSDK::CSDKRendererWrap::GetInst().GetShareTileStream().GetTracker();
+			if (pixels) {
+				*pixels = tracker.GetBuffer();
+			}
+			unsigned int count = tracker.GetRectCount() < maxCount ? tracker.GetRectCount() : maxCount;
+			if (rects && count > 0) {
+				memcpy(rects, tracker.GetRects(), count * sizeof(ZOOMSDK::RawDataDirtyRect));
+			}
+			return rects ? count : 0;
+		}
+
+		DllExport void StopShareTiles() {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetShareTileStream().Unsubscribe();
+		}
+
+
+		//video atlas: the newest frame of every user subscribed through InitVideoLOD packed into one RGBA/BGRA
+		//buffer, so the host uploads one texture per frame and draws each user from its uv rect. The atlas takes
+		//the frames of its users, don't call AcquireFrame for them as well.
+
+		// the atlas is width pixels wide and grows up to maxHeight. format 0 for RGBA32, 1 for BGRA32, flipVertical
+		// stores the rows bottom-up as Texture2D expects. Returns an SDKError code
+		DllExport int InitVideoAtlas(unsigned int width, unsigned int maxHeight, int format, bool flipVertical) {
+			if (format != ZOOMSDK::RawDataPixelFormat_RGBA32 && format != ZOOMSDK::RawDataPixelFormat_BGRA32) {
+				return (int)ZOOMSDK::SDKERR_INVALID_PARAMETER;
+			}
+			ZOOMSDK::CSDKRendererWrap& renderer = ZOOMSDK::CSDKRendererWrap::GetInst();
+			if (!renderer.GetRendererManager().IsInited()) {
+				ZOOMSDK::SDKError err = renderer.GetRendererManager().Init();
+				if (err != ZOOMSDK::SDKERR_SUCCESS) {
+					return (int)err;
+				}
+			}
+			if (!renderer.GetAtlasCompositor().Init(width, maxHeight, (ZOOMSDK::RawDataPixelFormat)format, flipVertical)) {
+				return (int)ZOOMSDK::SDKERR_INVALID_PARAMETER;
+			}
+			return 0;
+		}
+
+		// tolerance and changedPermille as in CRawDataChangeDetector::SetThreshold, on by default
+		DllExport void SetVideoAtlasChangeDetection(bool enable, unsigned int tolerance, unsigned int changedPermille) {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor().EnableChangeDetection(enable, tolerance, changedPermille);
+		}
+
+		// once per frame after UpdateVideoLOD, returns how many users were redrawn, 0 when the texture needs no
+		// upload and -1 when the atlas is not initialized
+		DllExport int ComposeVideoAtlas() {
+			ZOOMSDK::CSDKRendererWrap& renderer = ZOOMSDK::CSDKRendererWrap::GetInst();
+			if (!renderer.GetAtlasCompositor().IsInited() || !renderer.GetRendererManager().IsInited()) {
+				return -1;
+			}
+			return (int)renderer.GetAtlasCompositor().Compose(renderer.GetRendererManager());
+		}
+
+		// the pixels, stride bytes per row, valid until the next ComposeVideoAtlas. NULL while nothing is drawn
+		DllExport const unsigned char* GetVideoAtlasBuffer(unsigned int* width, unsigned int* height, unsigned int* stride) {
+			ZOOMSDK::CRawDataAtlasCompositor& atlas = ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor();
+			if (width) {
+				*width = atlas.GetWidth();
+			}
+			if (height) {
+				*height = atlas.GetHeight();
+			}
+			if (stride) {
+				*stride = atlas.GetStride();
+			}
+			return atlas.GetBuffer();
+		}
+
+		// changes whenever users move in the atlas or it changes size, fetch the rects again then
+		DllExport unsigned int GetVideoAtlasLayoutVersion() {
+			return ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor().GetLayoutVersion();
+		}
+
+		// fills up to maxCount rects and returns how many were written, users that did not fit have none
+		DllExport unsigned int GetVideoAtlasRects(ZOOMSDK::RawDataAtlasRect* rects, unsigned int maxCount) {
+			if (rects == NULL) {
+				return 0;
+			}
+			return ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor().GetRects(rects, maxCount);
+		}
+
+		// returns 1 when the user has a rect in the atlas
+		DllExport int GetVideoAtlasRect(unsigned int userID, ZOOMSDK::RawDataAtlasRect* rect) {
+			if (rect == NULL) {
+				return 0;
+			}
+			return ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor().GetRect(userID, *rect) ? 1 : 0;
+		}
+
+		DllExport void UninitVideoAtlas() {
+			ZOOMSDK::CSDKRendererWrap::GetInst().GetAtlasCompositor().Uninit();
+		}
+
+
 
 		// functions for self
 
@@ -250,13 +556,8 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 		}
 
 		DllExport bool isAudioOn() {
-			IUserInfoDotNetWrap^ self = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->GetUserByUserID(0);
-			if (!self->IsAudioMuted()) {
-				return true;
-			}
-			else {
-				return false;
-			}
+			ZOOMSDK::IUserInfo* self = ZOOMSDK::CMeetingParticipantsSnapshot::GetMySelf(ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController());
+			return self && !self->IsAudioMuted();
 		}
 
 		DllExport void ToggleVideo(bool resp) {
@@ -270,42 +571,310 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 		}
 
 		DllExport bool isVideoOn() {
-			IUserInfoDotNetWrap^ self = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->GetUserByUserID(0);
-			if (self->IsVideoOn()) {
-				return true;
-			}
-			else {
-				return false;
-			}
+			ZOOMSDK::IUserInfo* self = ZOOMSDK::CMeetingParticipantsSnapshot::GetMySelf(ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController());
+			return self && self->IsVideoOn();
 		}
 
 		DllExport bool isSelfHost() {
-			IUserInfoDotNetWrap^ self = CZoomSDKeDotNetWrap::Instance->GetMeetingServiceWrap()->GetMeetingParticipantsController()->GetUserByUserID(0);
-			if (self->IsHost()) {
-				return true;
-			}
-			else {
-				return false;
-			}
+			ZOOMSDK::IUserInfo* self = ZOOMSDK::CMeetingParticipantsSnapshot::GetMySelf(ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingParticipantsController());
+			return self && self->IsHost();
 		}
 		
 		//functions relating to changing cameras
 
 		DllExport int GetCamerasCount() {
-			array<ICameraInfoDotNetWrap^ >^ cameras = CZoomSDKeDotNetWrap::Instance->GetSettingServiceWrap()->GetVideoSettings()->GetCameraList();
-			int length = cameras->Length;
-			return length;
+			ZOOMSDK::IList<ZOOMSDK::ICameraInfo* >* cameras = ZOOMSDK::CSDKWrap::GetInst().GetSettingServiceWrap().GetVideoSettings().GetCameraList();
+			return cameras ? cameras->GetCount() : 0;
+		}
+
+		// handle of the camera's name in the string table, 0 when there is no such camera
+		DllExport unsigned int GetCameraNameHandle(int pos) {
+			ZOOMSDK::IList<ZOOMSDK::ICameraInfo* >* cameras = ZOOMSDK::CSDKWrap::GetInst().GetSettingServiceWrap().GetVideoSettings().GetCameraList();
+			if (NULL == cameras || pos < 0 || pos >= cameras->GetCount() || NULL == cameras->GetItem(pos)) {
+				return 0;
+			}
+			return ZOOMSDK::CSDKWrap::GetInst().GetStringTable().Intern(cameras->GetItem(pos)->GetDeviceName());
 		}
 
+		// UTF-8, owned by the string table and valid until the next Join
 		DllExport const char* GetCameraName(int pos) {
-			String^ name = CZoomSDKeDotNetWrap::Instance->GetSettingServiceWrap()->GetVideoSettings()->GetCameraList()[pos]->GetDeviceName();
-			const char* str = (char*)(void*)System::Runtime::InteropServices::Marshal::StringToHGlobalAnsi(name);
-			return str;
+			return ZOOMSDK::CSDKWrap::GetInst().GetStringTable().GetString(GetCameraNameHandle(pos));
 		}
 
 		DllExport void SelectNewCam(int pos) {
 			CZoomSDKeDotNetWrap::Instance->GetSettingServiceWrap()->GetVideoSettings()->SelectCamera(CZoomSDKeDotNetWrap::Instance->GetSettingServiceWrap()->GetVideoSettings()->GetCameraList()[pos]->GetDeviceId());
 		}
+
+
+		//avatar camera: replaces this user's camera with frames rendered by Unity, so attendees in regular
+		//Zoom clients see the 3D view. Frames are copied and sent from a worker thread. Read the render texture
+		//back with AsyncGPUReadback and pass the NativeArray's pointer, its rows come bottom-up so set flipVertical.
+
+		DllExport int StartAvatarCamera(unsigned int width, unsigned int height, unsigned int fps) {
+			ZOOMSDK::CRawDataVirtualCamera& camera = ZOOMSDK::CSDKWrap::GetInst().GetVirtualCamera();
+			camera.SetTargetSize(width, height, fps);
+			if (!camera.Start()) {
+				return (int)ZOOMSDK::SDKERR_INTERNAL_ERROR;
+			}
+			ZOOMSDK::IZoomSDKVideoSourceHelperWrap& helper = ZOOMSDK::CSDKWrap::GetInst().GetRawdataVideoSourceHelperWrap();
+			helper.Init_Wrap();
+			ZOOMSDK::SDKError err = helper.setExternalVideoSource(&camera);
+			if (err != ZOOMSDK::SDKERR_SUCCESS) {
+				camera.Stop();
+				return (int)err;
+			}
+			ZOOMSDK::CRawDataVideoSendController& controller = ZOOMSDK::CSDKWrap::GetInst().GetVideoSendController();
+			controller.Reset();
+			controller.SetCamera(&camera);
+			return (int)err;
+		}
+
+		// returns 1 when the frame was queued, 0 when nothing is being sent and the readback can be skipped
+		DllExport int PushAvatarFrame(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int stride, bool bgra, bool flipVertical) {
+			ZOOMSDK::RawDataPixelFormat format = bgra ? ZOOMSDK::RawDataPixelFormat_BGRA32 : ZOOMSDK::RawDataPixelFormat_RGBA32;
+			return ZOOMSDK::CSDKWrap::GetInst().GetVirtualCamera().PushFrame(pixels, width, height, stride, format, flipVertical) ? 1 : 0;
+		}
+
+		// the size frames are sent at, rendering at it saves the downscale. 0x0 before the sdk asked for frames
+		DllExport void GetAvatarCameraSize(unsigned int* width, unsigned int* height) {
+			ZOOMSDK::VideoSourceCapability cap = ZOOMSDK::CSDKWrap::GetInst().GetVirtualCamera().GetCapability();
+			if (width) {
+				*width = cap.width;
+			}
+			if (height) {
+				*height = cap.height;
+			}
+		}
+
+		// steps the avatar video down while the network is congested and back up once it recovered, so our own
+		// audio keeps its bandwidth. Cheap enough to call every frame, the sdk is queried about once a second.
+		// returns the level in use, 0 is full quality and higher levels send smaller and at fewer frames per second
+		DllExport int UpdateAvatarCameraQuality() {
+			ZOOMSDK::CRawDataVideoSendController& controller = ZOOMSDK::CSDKWrap::GetInst().GetVideoSendController();
+			long long nowMs = ZOOMSDK::MediaGetTimeUs() / 1000;
+			if (!ZOOMSDK::CSDKWrap::GetInst().GetVirtualCamera().IsSending() || !controller.IsDue(nowMs)) {
+				return (int)controller.GetLevel();
+			}
+			ZOOMSDK::RawDataVideoSendStats stats;
+			stats.quality = (int)ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetVideoConnQuality(true);
+			ZOOMSDK::IStatisticSettingContext* statistic = ZOOMSDK::CSDKWrap::GetInst().GetSettingServiceWrap().GetStatisticSettings();
+			ZOOMSDK::ASVSessionStatisticInfo info;
+			if (statistic && statistic->QueryVideoStatisticInfo(info) == ZOOMSDK::SDKERR_SUCCESS) {
+				stats.packetLossAvg = info.packetloss_send_avg_;
+				stats.packetLossMax = info.packetloss_send_max_;
+				stats.jitterMs = info.jitter_send_;
+				stats.latencyMs = info.latency_send_;
+			}
+			controller.Update(stats, nowMs);
+			return (int)controller.GetLevel();
+		}
+
+		DllExport void StopAvatarCamera() {
+			ZOOMSDK::CSDKWrap::GetInst().GetVideoSendController().SetCamera(NULL);
+			ZOOMSDK::CSDKWrap::GetInst().GetRawdataVideoSourceHelperWrap().setExternalVideoSource(NULL);
+			ZOOMSDK::CSDKWrap::GetInst().GetVirtualCamera().Stop();
+		}
+
+
+		//venue share: shares a view rendered by Unity, e.g. a camera overlooking the venue, as this user's screen
+		//share. Frames that look like the last one sent are skipped, so a quiet venue costs little.
+
+		DllExport int StartVenueShare(unsigned int width, unsigned int height, unsigned int fps) {
+			ZOOMSDK::CRawDataShareSource& share = ZOOMSDK::CSDKWrap::GetInst().GetShareSource();
+			share.SetTargetSize(width, height, fps);
+			if (!share.Start()) {
+				return (int)ZOOMSDK::SDKERR_INTERNAL_ERROR;
+			}
+			ZOOMSDK::IZoomSDKShareSourceHelperWrap& helper = ZOOMSDK::CSDKWrap::GetInst().GetRawdataShareSourceHelperWrap();
+			helper.Init_Wrap();
+			ZOOMSDK::SDKError err = helper.setExternalShareSource(&share);
+			if (err != ZOOMSDK::SDKERR_SUCCESS) {
+				share.Stop();
+			}
+			return (int)err;
+		}
+
+		// returns 1 when the frame was queued, 0 when nothing is being shared and the readback can be skipped
+		DllExport int PushVenueFrame(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int stride, bool bgra, bool flipVertical) {
+			ZOOMSDK::RawDataPixelFormat format = bgra ? ZOOMSDK::RawDataPixelFormat_BGRA32 : ZOOMSDK::RawDataPixelFormat_RGBA32;
+			return ZOOMSDK::CSDKWrap::GetInst().GetShareSource().PushFrame(pixels, width, height, stride, format, flipVertical) ? 1 : 0;
+		}
+
+		DllExport void StopVenueShare() {
+			ZOOMSDK::CSDKWrap::GetInst().GetMeetingServiceWrap().GetMeetingShareController().StopShare();
+			ZOOMSDK::CSDKWrap::GetInst().GetShareSource().Stop();
+		}
+
+
+		//camera filters: the frames of this user's camera are filtered in place before they are sent, on the
+		//sdk thread and a few workers. Every filter starts disabled, the setters enable it.
+
+		DllExport int StartVideoFilters(unsigned int workers) {
+			ZOOMSDK::CRawDataPreprocessPipeline& pipeline = ZOOMSDK::CSDKWrap::GetInst().GetPreprocessPipeline();
+			if (!pipeline.Start(workers)) {
+				return (int)ZOOMSDK::SDKERR_INTERNAL_ERROR;
+			}
+			pipeline.AddFilter(&brightnessFilter);
+			pipeline.AddFilter(&backgroundDimFilter);
+			pipeline.AddFilter(&vignetteFilter);
+			ZOOMSDK::IZoomSDKVideoSourceHelperWrap& helper = ZOOMSDK::CSDKWrap::GetInst().GetRawdataVideoSourceHelperWrap();
+			helper.Init_Wrap();
+			ZOOMSDK::SDKError err = helper.setPreProcessor(&pipeline);
+			if (err != ZOOMSDK::SDKERR_SUCCESS) {
+				pipeline.Stop();
+			}
+			return (int)err;
+		}
+
+		// brightness -255 to 255, contrast 1 keeps the image
+		DllExport void SetVideoBrightnessContrast(bool enable, int brightness, float contrast) {
+			brightnessFilter.SetParams(brightness, contrast);
+			brightnessFilter.Enable(enable);
+		}
+
+		// pixels darker than threshold (luma 0-255) are dimmed by amount (0-1)
+		DllExport void SetVideoBackgroundDim(bool enable, int threshold, int softness, float amount) {
+			backgroundDimFilter.SetParams(threshold, softness, amount);
+			backgroundDimFilter.Enable(enable);
+		}
+
+		// strength and radius are 0 to 1
+		DllExport void SetVideoVignette(bool enable, float strength, float radius) {
+			vignetteFilter.SetParams(strength, radius);
+			vignetteFilter.Enable(enable);
+		}
+
+		// microseconds the filters took on the last frame
+		DllExport long long GetVideoFilterTime() {
+			return ZOOMSDK::CSDKWrap::GetInst().GetPreprocessPipeline().GetLastFrameUs();
+		}
+
+		DllExport void StopVideoFilters() {
+			ZOOMSDK::CRawDataPreprocessPipeline& pipeline = ZOOMSDK::CSDKWrap::GetInst().GetPreprocessPipeline();
+			ZOOMSDK::CSDKWrap::GetInst().GetRawdataVideoSourceHelperWrap().setPreProcessor(NULL);
+			pipeline.RemoveAllFilters();
+			pipeline.Stop();
+		}
+
+
+		//speaker audio: every remote speaker arrives as separate 16 bit PCM, so each avatar can play its own voice
+		//from its position in the venue. Reading neither locks nor allocates and may run on Unity's audio thread.
+
+		// speakers get behind by at most maxLatencyMs, older audio is skipped
+		DllExport int StartSpeakerAudio(unsigned int maxLatencyMs) {
+			ZOOMSDK::CRawDataAudioRingManager& rings = ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager();
+			rings.SetMaxLatency(maxLatencyMs);
+			ZOOMSDK::IZoomSDKAudioRawDataHelperWrap& helper = ZOOMSDK::CSDKWrap::GetInst().GetAudioRawdataHelperWrap();
+			helper.Init_Wrap();
+			return (int)helper.subscribe(&rings);
+		}
+
+		// fills frames interleaved with channels per frame, resampled to sampleRate (0 keeps the speaker's), so
+		// OnAudioFilterRead can pass its buffer straight in. Silence where the speaker has nothing buffered.
+		// returns how many frames were audio. Call from one thread only.
+		DllExport unsigned int ReadSpeakerAudio(unsigned int nodeId, float* samples, unsigned int frames, unsigned int channels, unsigned int sampleRate) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().Read(nodeId, samples, frames, channels, sampleRate);
+		}
+
+		// the rate the speaker sends at, 0 before its first audio
+		DllExport unsigned int GetSpeakerSampleRate(unsigned int nodeId) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().GetSampleRate(nodeId);
+		}
+
+		// node ids heard within the last second, returns how many were written
+		DllExport unsigned int GetActiveSpeakers(unsigned int* nodeIds, unsigned int maxCount) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().GetSpeakers(nodeIds, maxCount);
+		}
+
+		// rms, peak and voice activity of the speakers heard within the last second, one call per frame for all
+		// of them. Returns how many were written
+		DllExport unsigned int GetSpeakerLevels(ZOOMSDK::RawDataAudioLevel* levels, unsigned int maxCount) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().GetLevels(levels, maxCount);
+		}
+
+		// lip sync of the same speakers for blending their avatars' mouth shapes, RawDataViseme_Count weights per
+		// speaker in the order of RawDataViseme, adding up to 1. weights holds maxCount of them. Returns how many
+		// speakers were written
+		DllExport unsigned int GetSpeakerVisemes(unsigned int* nodeIds, float* weights, unsigned int maxCount) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().GetVisemes(nodeIds, weights, maxCount);
+		}
+
+		DllExport void StopSpeakerAudio() {
+			ZOOMSDK::CSDKWrap::GetInst().GetAudioRawdataHelperWrap().unSubscribe();
+			ZOOMSDK::CSDKWrap::GetInst().GetAudioRecorder().Stop();
+			ZOOMSDK::CSDKWrap::GetInst().GetAudioRingManager().Reset();
+		}
+
+
+		//audio recording: the meeting mix and, optionally, every speaker to separate WAV files for processing after
+		//the event. Needs StartSpeakerAudio. The sdk thread only copies the audio, a background thread writes it.
+
+		// writes mixed.wav and, with oneWay set, speaker_<node id>.wav per speaker into directory, which has to exist.
+		// Every file starts with the recording, pauses are filled with silence. Returns 0 when already recording
+		DllExport int StartAudioRecording(const char* directory, bool oneWay) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetAudioRecorder().Start(directory, oneWay) ? 1 : 0;
+		}
+
+		// writes what is still queued and closes the files
+		DllExport void StopAudioRecording() {
+			ZOOMSDK::CSDKWrap::GetInst().GetAudioRecorder().Stop();
+		}
+
+		// chunks lost because the disk could not keep up or a file could not be written
+		DllExport unsigned long long GetAudioRecordingLost() {
+			ZOOMSDK::CRawDataAudioRecorder& recorder = ZOOMSDK::CSDKWrap::GetInst().GetAudioRecorder();
+			return recorder.GetDroppedCount() + recorder.GetFailedCount();
+		}
+
+
+		//fixture recording: the video, share and audio the subscribed renderers and StartSpeakerAudio receive,
+		//written to one file that wrap/fixture_replay plays back without a meeting.
+
+		// the file is overwritten, returns 0 when it can't be created
+		DllExport int StartFixtureRecording(const char* path) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetFixtureWriter().Open(path) ? 1 : 0;
+		}
+
+		DllExport void StopFixtureRecording() {
+			ZOOMSDK::CSDKWrap::GetInst().GetFixtureWriter().Close();
+		}
+
+		// records written so far. Stops counting if a write failed, the file keeps what was whole
+		DllExport unsigned long long GetFixtureRecordCount() {
+			return ZOOMSDK::CSDKWrap::GetInst().GetFixtureWriter().GetRecordCount();
+		}
+
+
+		//spatial voice: the speakers placed at their avatars and mixed to stereo natively, for a single
+		//OnAudioFilterRead on the listener. Needs StartSpeakerAudio, and replaces ReadSpeakerAudio for the
+		//speakers placed here. Positions and directions are in Unity's world space.
+
+		DllExport void SetSpatialListener(float x, float y, float z, float forwardX, float forwardY, float forwardZ, float upX, float upY, float upZ) {
+			ZOOMSDK::SpatialVector position = { x, y, z };
+			ZOOMSDK::SpatialVector forward = { forwardX, forwardY, forwardZ };
+			ZOOMSDK::SpatialVector up = { upX, upY, upZ };
+			ZOOMSDK::CSDKWrap::GetInst().GetSpatialMixer().SetListener(position, forward, up);
+		}
+
+		// places or moves a speaker, gain 1 keeps its level. Returns 0 when every source is taken
+		DllExport int SetSpatialSource(unsigned int nodeId, float x, float y, float z, float gain) {
+			ZOOMSDK::SpatialVector position = { x, y, z };
+			return ZOOMSDK::CSDKWrap::GetInst().GetSpatialMixer().SetSource(nodeId, position, gain) ? 1 : 0;
+		}
+
+		DllExport void RemoveSpatialSource(unsigned int nodeId) {
+			ZOOMSDK::CSDKWrap::GetInst().GetSpatialMixer().RemoveSource(nodeId);
+		}
+
+		// full level up to minDistance, then falling off with rolloff until maxDistance
+		DllExport void SetSpatialDistance(float minDistance, float maxDistance, float rolloff) {
+			ZOOMSDK::CSDKWrap::GetInst().GetSpatialMixer().SetDistanceModel(minDistance, maxDistance, rolloff);
+		}
+
+		// overwrites data with the mix, returns how many speakers had audio
+		DllExport unsigned int MixSpatialAudio(float* data, unsigned int frames, unsigned int channels, unsigned int sampleRate) {
+			return ZOOMSDK::CSDKWrap::GetInst().GetSpatialMixer().Mix(data, frames, channels, sampleRate);
+		}
 	}
 
 
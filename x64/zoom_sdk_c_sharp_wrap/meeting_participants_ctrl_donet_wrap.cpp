@@ -16,6 +16,8 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 
 		void onUserJoin(ZOOM_SDK_NAMESPACE::IList<unsigned int >* lstUserID, const wchar_t* strUserList)
 		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnUserJoin(ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetMeetingServiceWrap().
+				GetMeetingParticipantsController(), lstUserID);
 			if (CMeetingParticipantsControllerDotNetWrap::Instance)
 			{
 				CMeetingParticipantsControllerDotNetWrap::Instance->procUserJoin(Convert(lstUserID));
@@ -24,6 +26,8 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 
 		void onUserLeft(ZOOM_SDK_NAMESPACE::IList<unsigned int >* lstUserID, const wchar_t* strUserList)
 		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnUserLeft(lstUserID);
+			ZOOM_SDK_NAMESPACE::CSDKRendererWrap::GetInst().GetLODScheduler().OnUserLeft(lstUserID);
 			if (CMeetingParticipantsControllerDotNetWrap::Instance)
 			{
 				CMeetingParticipantsControllerDotNetWrap::Instance->procUserLeft(Convert(lstUserID));
@@ -32,12 +36,14 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 
 		void onHostChangeNotification(unsigned int userId)
 		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnHostChange(userId);
 			if (CMeetingParticipantsControllerDotNetWrap::Instance)
 				CMeetingParticipantsControllerDotNetWrap::Instance->procHostChangeNotification(userId);
 		}
 
 		void onLowOrRaiseHandStatusChanged(bool bLow, unsigned int userId)
 		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnHandStatusChange(userId, bLow);
 			if (CMeetingParticipantsControllerDotNetWrap::Instance)
 				CMeetingParticipantsControllerDotNetWrap::Instance->procLowOrRaiseHandStatusChanged(bLow, userId);
 		}
@@ -47,6 +53,17 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 			if (CMeetingParticipantsControllerDotNetWrap::Instance)
 				CMeetingParticipantsControllerDotNetWrap::Instance->procUserNameChanged(userId, WChar2PlatformString(userName));
 		}
+
+		//only kept in the roster
+		void onCoHostChangeNotification(unsigned int userId, bool isCoHost)
+		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnCoHostChange(userId, isCoHost);
+		}
+
+		void onUserNamesChanged(ZOOM_SDK_NAMESPACE::IList<unsigned int >* lstUserID)
+		{
+			ZOOM_SDK_NAMESPACE::CSDKWrap::GetInst().GetParticipantsRoster().OnUserNamesChanged(lstUserID);
+		}
 	private:
 		ParticipantsEventHandler() {}
 	};
@@ -75,6 +92,14 @@ namespace ZOOM_SDK_DOTNET_WRAP {
 		meetingParticipants.m_cbonUserNameChanged =
 			std::bind(&ParticipantsEventHandler::onUserNameChanged,
 				&ParticipantsEventHandler::GetInst(), std::placeholders::_1, std::placeholders::_2);
+
+		meetingParticipants.m_cbonCoHostChangeNotification =
+			std::bind(&ParticipantsEventHandler::onCoHostChangeNotification,
+				&ParticipantsEventHandler::GetInst(), std::placeholders::_1, std::placeholders::_2);
+
+		meetingParticipants.m_cbonUserNamesChanged =
+			std::bind(&ParticipantsEventHandler::onUserNamesChanged,
+				&ParticipantsEventHandler::GetInst(), std::placeholders::_1);
 	}
 	void CMeetingParticipantsControllerDotNetWrap::procUserJoin(array<unsigned int >^ lstUserID)
 	{
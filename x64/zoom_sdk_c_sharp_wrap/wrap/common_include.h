@@ -44,6 +44,7 @@
 
 #include "rawdata/zoom_rawdata_api.h"
 #include "rawdata/rawdata_video_source_helper_interface.h"
+#include "rawdata/rawdata_share_source_helper_interface.h"
 #include "rawdata/rawdata_renderer_interface.h"
 #include "rawdata/rawdata_audio_helper_interface.h"
 #include "zoom_sdk_raw_data_def.h"
@@ -89,6 +90,7 @@
 
 #include "rawdata/zoom_rawdata_api.h"
 #include "rawdata/rawdata_video_source_helper_interface.h"
+#include "rawdata/rawdata_share_source_helper_interface.h"
 #include "rawdata/rawdata_renderer_interface.h"
 #include "rawdata/rawdata_audio_helper_interface.h"
 #include "zoom_sdk_raw_data_def.h"
@@ -0,0 +1,195 @@
+//Replays a raw media fixture recorded with StartFixtureRecording() into the wrapper's media code, without the sdk
+//and without a meeting. Video and share frames go through a CRawDataFrameRing per stream, audio through
+//CRawDataAudioRingManager, and both are consumed as they arrive the way the host would. Prints what was delivered
+//and how fast, so media changes can be benchmarked against the same input.
+//
+//usage: fixture_replay <fixture> [-realtime] [-loops <n>] [-queue] [-copy]
+//  -realtime  deliver at the recorded times instead of as fast as possible
+//  -loops     play the fixture n times back to back
+//  -queue     FrameRingMode_Queue instead of FrameRingMode_LatestWins
+//  -copy      frames report CanAddRef() false, so the rings copy them
+//
+//Built by fixture_replay.vcxproj on Windows. On Linux, from wrap/, as one command line:
+//  g++ -O2 -I. -Iposix -I../h fixture_replay/fixture_replay.cpp rawdata_fixture.cpp rawdata_frame_ring.cpp
+//      rawdata_audio_ring.cpp rawdata_audio_resampler.cpp rawdata_audio_meter.cpp rawdata_audio_viseme.cpp
+//      rawdata_audio_recorder.cpp -lpthread -o fixture_replay
+#include "rawdata_fixture.h"
+#include "rawdata_frame_ring.h"
+#include "rawdata_audio_ring.h"
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+USING_ZOOM_SDK_NAMESPACE
+
+//One video or share stream: the ring the renderer slot would push into, drained after every frame.
+class CReplayVideoSink : public IZoomSDKRendererDelegate
+{
+public:
+	CReplayVideoSink(uint32_t userId, bool bShare) : m_nUserId(userId), m_bShare(bShare), m_nConsumed(0)
+	{
+	}
+	bool Init(FrameRingMode mode)
+	{
+		if (!m_ring.Init(mode))
+			return false;
+		m_ring.SetUserId(m_nUserId);
+		return true;
+	}
+
+	virtual void onRendererBeDestroyed() {}
+	virtual void onRawDataFrameReceived(YUVRawDataI420* data)
+	{
+		m_ring.PushFrame(data);
+		const CRawDataFrame* pFrame = m_ring.AcquireFrame();
+		if (pFrame)
+		{
+			++m_nConsumed;
+			m_ring.ReleaseFrame(pFrame);
+		}
+	}
+	virtual void onRawDataStatusChanged(RawDataStatus /*status*/) {}
+
+	uint32_t GetUserId() const { return m_nUserId; }
+	bool IsShare() const { return m_bShare; }
+	CRawDataFrameRing& GetRing() { return m_ring; }
+	unsigned long long GetConsumedCount() const { return m_nConsumed; }
+
+private:
+	CRawDataFrameRing m_ring;
+	uint32_t m_nUserId;
+	bool m_bShare;
+	unsigned long long m_nConsumed;
+};
+
+//Hands the audio to the ring manager and reads back as much as each speaker just sent.
+class CReplayAudioSink : public IZoomSDKAudioRawDataDelegate
+{
+public:
+	CReplayAudioSink() : m_nChunks(0), m_nFramesRead(0)
+	{
+	}
+
+	virtual void onMixedAudioRawDataReceived(AudioRawData* data_)
+	{
+		CRawDataAudioRingManager::GetInst().onMixedAudioRawDataReceived(data_);
+		++m_nChunks;
+	}
+	virtual void onOneWayAudioRawDataReceived(AudioRawData* data_, uint32_t node_id)
+	{
+		CRawDataAudioRingManager::GetInst().onOneWayAudioRawDataReceived(data_, node_id);
+		++m_nChunks;
+		unsigned int channels = data_->GetChannelNum();
+		if (0 == channels)
+			return;
+		unsigned int frames = data_->GetBufferLen() / (sizeof(short) * channels);
+		if (m_samples.size() < (size_t)frames * channels)
+			m_samples.resize((size_t)frames * channels);
+		m_nFramesRead += CRawDataAudioRingManager::GetInst().Read(node_id, &m_samples[0], frames, channels, 0);
+	}
+
+	unsigned long long GetChunkCount() const { return m_nChunks; }
+	unsigned long long GetFramesRead() const { return m_nFramesRead; }
+
+private:
+	std::vector<float> m_samples;
+	unsigned long long m_nChunks;
+	unsigned long long m_nFramesRead;
+};
+
+static void PrintUsage()
+{
+	printf("usage: fixture_replay <fixture> [-realtime] [-loops <n>] [-queue] [-copy]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	const char* path = NULL;
+	RawDataFixturePlayMode mode = RawDataFixturePlay_AsFastAsPossible;
+	FrameRingMode ringMode = FrameRingMode_LatestWins;
+	unsigned int loops = 1;
+	bool bAddRef = true;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (0 == strcmp(argv[i], "-realtime"))
+			mode = RawDataFixturePlay_RealTime;
+		else if (0 == strcmp(argv[i], "-loops") && i + 1 < argc)
+			loops = (unsigned int)strtoul(argv[++i], NULL, 10);
+		else if (0 == strcmp(argv[i], "-queue"))
+			ringMode = FrameRingMode_Queue;
+		else if (0 == strcmp(argv[i], "-copy"))
+			bAddRef = false;
+		else if (NULL == path && '-' != argv[i][0])
+			path = argv[i];
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (NULL == path || 0 == loops)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	CRawDataFixtureReader reader;
+	if (!reader.Open(path))
+	{
+		printf("%s is not a fixture or can't be read\n", path);
+		return 1;
+	}
+	printf("%s: %u records, %.2f s\n", path, reader.GetRecordCount(), reader.GetDuration() / 1000000.0);
+
+	//a sink per stream in the fixture, the player finds them by user id
+	CRawDataFixturePlayer player(reader);
+	CReplayAudioSink audio;
+	player.SetAudioDelegate(&audio);
+	player.EnableAddRef(bAddRef);
+	std::vector<CReplayVideoSink*> video;
+	std::map<unsigned long long, CReplayVideoSink*> streams;
+	int ret = 0;
+	for (unsigned int i = 0; i < reader.GetRecordCount() && 0 == ret; ++i)
+	{
+		const RawDataFixtureRecord* pRecord = reader.GetRecord(i);
+		if (RawDataFixtureRecord_Video != pRecord->type && RawDataFixtureRecord_Share != pRecord->type)
+			continue;
+		unsigned long long key = ((unsigned long long)pRecord->type << 32) | pRecord->streamId;
+		if (streams.find(key) != streams.end())
+			continue;
+		bool bShare = RawDataFixtureRecord_Share == pRecord->type;
+		CReplayVideoSink* pSink = new (std::nothrow) CReplayVideoSink(pRecord->streamId, bShare);
+		if (NULL == pSink || !pSink->Init(ringMode))
+		{
+			delete pSink;
+			printf("out of memory\n");
+			ret = 1;
+			break;
+		}
+		video.push_back(pSink);
+		streams[key] = pSink;
+		player.SetVideoDelegate(pRecord->streamId, pSink, bShare);
+	}
+
+	if (0 == ret)
+	{
+		long long startUs = MediaGetTimeUs();
+		unsigned long long delivered = player.Play(mode, loops);
+		long long elapsedUs = MediaGetTimeUs() - startUs;
+		printf("delivered %llu records in %.1f ms, %.0f records/s\n", delivered, elapsedUs / 1000.0,
+			elapsedUs > 0 ? delivered * 1000000.0 / elapsedUs : 0.0);
+		for (size_t i = 0; i < video.size(); ++i)
+		{
+			CReplayVideoSink* pSink = video[i];
+			printf("%s %u: %llu frames, %llu consumed, %llu dropped\n", pSink->IsShare() ? "share" : "video", pSink->GetUserId(),
+				pSink->GetRing().GetPushedCount(), pSink->GetConsumedCount(), pSink->GetRing().GetDroppedCount());
+		}
+		printf("audio: %llu chunks, %llu speaker frames read\n", audio.GetChunkCount(), audio.GetFramesRead());
+	}
+
+	//the rings hold frames that point into the mapping, they go before the reader is closed
+	for (size_t i = 0; i < video.size(); ++i)
+		delete video[i];
+	CRawDataAudioRingManager::GetInst().Reset();
+	reader.Close();
+	return ret;
+}
@@ -0,0 +1,228 @@
+#include "meeting_participants_roster.h"
+#include "meeting_service_components_wrap/meeting_participants_ctrl_wrap.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//bits of CMeetingParticipantsSnapshot::GetFlags() that the callbacks keep up to date
+#define ROSTER_TRACKED_FLAGS (ParticipantFlag_Host | ParticipantFlag_CoHost | ParticipantFlag_RaisedHand | ParticipantFlag_MySelf)
+
+CMeetingParticipantsRoster& CMeetingParticipantsRoster::GetInst()
+{
+	static CMeetingParticipantsRoster inst;
+	return inst;
+}
+
+CMeetingParticipantsRoster::CMeetingParticipantsRoster()
+{
+	memset(m_log, 0, sizeof(m_log));
+	m_nVersion = 0;
+	m_nResetVersion = 0;
+	m_nReportCall = 0;
+	m_nHostId = 0;
+	m_bHasHost = false;
+}
+
+void CMeetingParticipantsRoster::Reset()
+{
+	CMediaAutoLock lock(m_lock);
+	m_entries.clear();
+	m_bHasHost = false;
+	//no version from before is valid to ask from anymore
+	++m_nVersion;
+	m_nResetVersion = m_nVersion;
+}
+
+CMeetingParticipantsRoster::RosterEntry& CMeetingParticipantsRoster::Touch(uint32_t userId)
+{
+	++m_nVersion;
+	uint32_t& slot = m_log[m_nVersion % ROSTER_LOG_SIZE];
+	//the change this one overwrites can't be asked for anymore, so a user it left behind can go
+	if (m_nVersion > ROSTER_LOG_SIZE && slot != userId)
+	{
+		RosterEntryMap::iterator it = m_entries.find(slot);
+		if (it != m_entries.end() && it->second.bLeft && it->second.version + ROSTER_LOG_SIZE <= m_nVersion)
+			m_entries.erase(it);
+	}
+	slot = userId;
+
+	RosterEntry& entry = m_entries[userId];
+	entry.version = m_nVersion;
+	return entry;
+}
+
+void CMeetingParticipantsRoster::SetFlag(uint32_t userId, uint32_t flag, bool bSet)
+{
+	RosterEntryMap::iterator it = m_entries.find(userId);
+	if (it == m_entries.end() || it->second.bLeft)
+		return;
+	uint32_t flags = bSet ? (it->second.flags | flag) : (it->second.flags & ~flag);
+	if (flags == it->second.flags)
+		return;
+	it->second.flags = flags;
+	Touch(userId);
+}
+
+void CMeetingParticipantsRoster::OnUserJoin(IMeetingParticipantsControllerWrap& controller, IList<unsigned int >* lstUserID)
+{
+	if (NULL == lstUserID)
+		return;
+	CMediaAutoLock lock(m_lock);
+	int count = lstUserID->GetCount();
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t userId = lstUserID->GetItem(i);
+		uint32_t flags = CMeetingParticipantsSnapshot::GetFlags(controller.GetUserByUserID(userId)) & ROSTER_TRACKED_FLAGS;
+		if (flags & ParticipantFlag_Host)
+		{
+			if (m_bHasHost && m_nHostId != userId)
+				SetFlag(m_nHostId, ParticipantFlag_Host, false);
+			m_nHostId = userId;
+			m_bHasHost = true;
+		}
+
+		RosterEntryMap::iterator it = m_entries.find(userId);
+		if (it == m_entries.end())
+		{
+			RosterEntry entry;
+			memset(&entry, 0, sizeof(entry));
+			it = m_entries.insert(RosterEntryMap::value_type(userId, entry)).first;
+		}
+		else if (!it->second.bLeft && it->second.flags == flags)
+		{
+			continue;
+		}
+		it->second.flags = flags;
+		it->second.bLeft = false;
+		Touch(userId);
+	}
+}
+
+void CMeetingParticipantsRoster::OnUserLeft(IList<unsigned int >* lstUserID)
+{
+	if (NULL == lstUserID)
+		return;
+	CMediaAutoLock lock(m_lock);
+	int count = lstUserID->GetCount();
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t userId = lstUserID->GetItem(i);
+		RosterEntryMap::iterator it = m_entries.find(userId);
+		if (it == m_entries.end() || it->second.bLeft)
+			continue;
+		it->second.flags = 0;
+		it->second.bLeft = true;
+		if (m_bHasHost && m_nHostId == userId)
+			m_bHasHost = false;
+		Touch(userId);
+	}
+}
+
+void CMeetingParticipantsRoster::OnHostChange(unsigned int userId)
+{
+	CMediaAutoLock lock(m_lock);
+	if (m_bHasHost && m_nHostId != userId)
+		SetFlag(m_nHostId, ParticipantFlag_Host, false);
+	m_nHostId = userId;
+	m_bHasHost = true;
+	SetFlag(userId, ParticipantFlag_Host, true);
+}
+
+void CMeetingParticipantsRoster::OnCoHostChange(unsigned int userId, bool bCoHost)
+{
+	CMediaAutoLock lock(m_lock);
+	SetFlag(userId, ParticipantFlag_CoHost, bCoHost);
+}
+
+void CMeetingParticipantsRoster::OnHandStatusChange(unsigned int userId, bool bLow)
+{
+	CMediaAutoLock lock(m_lock);
+	SetFlag(userId, ParticipantFlag_RaisedHand, !bLow);
+}
+
+void CMeetingParticipantsRoster::OnUserNamesChanged(IList<unsigned int >* lstUserID)
+{
+	if (NULL == lstUserID)
+		return;
+	CMediaAutoLock lock(m_lock);
+	int count = lstUserID->GetCount();
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t userId = lstUserID->GetItem(i);
+		RosterEntryMap::iterator it = m_entries.find(userId);
+		if (it == m_entries.end() || it->second.bLeft)
+			continue;
+		RosterEntry& entry = Touch(userId);
+		entry.nameVersion = entry.version;
+	}
+}
+
+unsigned int CMeetingParticipantsRoster::GetRoster(uint32_t* pUserIds, uint32_t* pFlags, unsigned int capacity, unsigned long long* pVersion)
+{
+	CMediaAutoLock lock(m_lock, true);
+	if (NULL == pUserIds)
+		capacity = 0;
+	unsigned int count = 0;
+	for (RosterEntryMap::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if (it->second.bLeft)
+			continue;
+		if (count < capacity)
+		{
+			pUserIds[count] = it->first;
+			if (pFlags)
+				pFlags[count] = it->second.flags;
+		}
+		++count;
+	}
+	if (pVersion)
+		*pVersion = m_nVersion;
+	return count;
+}
+
+int CMeetingParticipantsRoster::GetChanges(unsigned long long sinceVersion, uint32_t* pUserIds, uint32_t* pFlags, unsigned int capacity, unsigned long long* pVersion)
+{
+	CMediaAutoLock lock(m_lock);
+	unsigned long long oldest = m_nVersion > ROSTER_LOG_SIZE ? m_nVersion - ROSTER_LOG_SIZE : 0;
+	if (oldest < m_nResetVersion)
+		oldest = m_nResetVersion;
+	if (sinceVersion < oldest || sinceVersion > m_nVersion)
+		return -1;
+	if (NULL == pUserIds)
+		capacity = 0;
+
+	//a user changed several times is written once, at its first change, with what it is now
+	++m_nReportCall;
+	unsigned int count = 0;
+	unsigned long long version = sinceVersion;
+	while (version < m_nVersion)
+	{
+		uint32_t userId = m_log[(version + 1) % ROSTER_LOG_SIZE];
+		RosterEntryMap::iterator it = m_entries.find(userId);
+		if (it != m_entries.end() && it->second.reported != m_nReportCall)
+		{
+			RosterEntry& entry = it->second;
+			if (count == capacity)
+				break;
+			pUserIds[count] = userId;
+			if (pFlags)
+			{
+				pFlags[count] = entry.flags;
+				if (entry.bLeft)
+					pFlags[count] |= ParticipantFlag_Left;
+				if (entry.nameVersion > sinceVersion)
+					pFlags[count] |= ParticipantFlag_NameChanged;
+			}
+			entry.reported = m_nReportCall;
+			++count;
+		}
+		++version;
+	}
+	if (pVersion)
+		*pVersion = version;
+	return (int)count;
+}
+
+unsigned long long CMeetingParticipantsRoster::GetVersion()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return m_nVersion;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,69 @@
+#pragma once
+#include "meeting_participants_snapshot.h"
+#include <map>
+BEGIN_ZOOM_SDK_NAMESPACE
+//changes remembered for GetChanges(), a caller further behind has to read the whole roster again
+#define ROSTER_LOG_SIZE 8192
+
+//Roster of the meeting kept up to date from the participant callbacks, so the host applies only what changed
+//instead of reading every participant again after each event. Every change bumps the version and is logged with
+//the user it concerns. GetChanges() reports the users changed after the version the host last saw, with their
+//current flags, in O(changes). Users who left stay as entries flagged ParticipantFlag_Left until their change
+//drops out of the log.
+//Only what the callbacks report is kept up to date: host, co-host, raised hand and names, and who the local user
+//is. The audio, video and talking state changes far more often, GetParticipantsSnapshot() reads it.
+//Callbacks come from the sdk thread, the getters may be called from any thread.
+class CMeetingParticipantsRoster
+{
+public:
+	static CMeetingParticipantsRoster& GetInst();
+
+	//forgets every participant, e.g. before joining another meeting. Versions the host saw before have to be read again.
+	void Reset();
+
+	//sdk thread
+	void OnUserJoin(IMeetingParticipantsControllerWrap& controller, IList<unsigned int >* lstUserID);
+	void OnUserLeft(IList<unsigned int >* lstUserID);
+	void OnHostChange(unsigned int userId);
+	void OnCoHostChange(unsigned int userId, bool bCoHost);
+	void OnHandStatusChange(unsigned int userId, bool bLow);
+	//the deprecated onUserNameChanged reports the same renames again, only this one is taken
+	void OnUserNamesChanged(IList<unsigned int >* lstUserID);
+
+	//fills up to capacity users present in the meeting, returns how many there are. pVersion gets the version they
+	//are current to, to ask for the changes after it.
+	unsigned int GetRoster(uint32_t* pUserIds, uint32_t* pFlags, unsigned int capacity, unsigned long long* pVersion);
+	//fills up to capacity users changed after sinceVersion, each once with its current flags, and pVersion with the
+	//version to ask from next time. Returns how many were written, less than capacity once the changes are all
+	//reported, or -1 when sinceVersion is not known anymore and GetRoster() has to be read again.
+	int GetChanges(unsigned long long sinceVersion, uint32_t* pUserIds, uint32_t* pFlags, unsigned int capacity, unsigned long long* pVersion);
+	unsigned long long GetVersion();
+
+private:
+	typedef struct tagRosterEntry
+	{
+		uint32_t flags;///<ParticipantFlag bits the callbacks keep up to date.
+		bool bLeft;
+		unsigned long long version;///<Latest change of the user.
+		unsigned long long nameVersion;///<Latest name change, 0 for none.
+		unsigned long long reported;///<GetChanges() call the user was last written in.
+	}RosterEntry;
+	typedef std::map<uint32_t, RosterEntry> RosterEntryMap;
+
+	CMeetingParticipantsRoster();
+	CMeetingParticipantsRoster(const CMeetingParticipantsRoster&);
+	CMeetingParticipantsRoster& operator=(const CMeetingParticipantsRoster&);
+	//logs a change of userId, which has to be in m_entries, and returns its entry
+	RosterEntry& Touch(uint32_t userId);
+	void SetFlag(uint32_t userId, uint32_t flag, bool bSet);
+
+	CMediaLock m_lock;
+	RosterEntryMap m_entries;
+	uint32_t m_log[ROSTER_LOG_SIZE];///<User of each change, at version % ROSTER_LOG_SIZE.
+	unsigned long long m_nVersion;
+	unsigned long long m_nResetVersion;
+	unsigned long long m_nReportCall;
+	uint32_t m_nHostId;
+	bool m_bHasHost;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,76 @@
+#include "meeting_participants_snapshot.h"
+#include "meeting_service_components_wrap/meeting_participants_ctrl_wrap.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+unsigned int CMeetingParticipantsSnapshot::Take(IMeetingParticipantsControllerWrap& controller, uint32_t* pUserIds, uint32_t* pFlags,
+	int32_t* pVoiceLevels, int32_t* pRoles, unsigned int capacity)
+{
+	IList<unsigned int >* lstParticipants = controller.GetParticipantsList();
+	if (NULL == lstParticipants)
+		return 0;
+	if (NULL == pUserIds)
+		capacity = 0;
+
+	unsigned int count = 0;
+	int total = lstParticipants->GetCount();
+	for (int i = 0; i < total; ++i)
+	{
+		unsigned int userId = lstParticipants->GetItem(i);
+		IUserInfo* pUser = controller.GetUserByUserID(userId);
+		//left since the list was taken
+		if (NULL == pUser)
+			continue;
+
+		if (count < capacity)
+		{
+			pUserIds[count] = userId;
+			if (pFlags)
+				pFlags[count] = GetFlags(pUser);
+			if (pVoiceLevels)
+				pVoiceLevels[count] = pUser->GetAudioVoiceLevel();
+			if (pRoles)
+				pRoles[count] = (int32_t)pUser->GetUserRole();
+		}
+		++count;
+	}
+	return count;
+}
+
+uint32_t CMeetingParticipantsSnapshot::GetFlags(IUserInfo* pUser)
+{
+	if (NULL == pUser)
+		return 0;
+	uint32_t flags = 0;
+	if (pUser->IsHost())
+		flags |= ParticipantFlag_Host;
+	if (USERROLE_COHOST == pUser->GetUserRole())
+		flags |= ParticipantFlag_CoHost;
+	if (pUser->IsAudioMuted())
+		flags |= ParticipantFlag_AudioMuted;
+	if (pUser->IsVideoOn())
+		flags |= ParticipantFlag_VideoOn;
+	if (pUser->IsTalking())
+		flags |= ParticipantFlag_Talking;
+	if (pUser->IsRaiseHand())
+		flags |= ParticipantFlag_RaisedHand;
+	if (pUser->IsMySelf())
+		flags |= ParticipantFlag_MySelf;
+	if (pUser->IsInWaitingRoom())
+		flags |= ParticipantFlag_InWaitingRoom;
+	return flags;
+}
+
+IUserInfo* CMeetingParticipantsSnapshot::GetMySelf(IMeetingParticipantsControllerWrap& controller)
+{
+	IList<unsigned int >* lstParticipants = controller.GetParticipantsList();
+	if (NULL == lstParticipants)
+		return NULL;
+	int total = lstParticipants->GetCount();
+	for (int i = 0; i < total; ++i)
+	{
+		IUserInfo* pUser = controller.GetUserByUserID(lstParticipants->GetItem(i));
+		if (pUser && pUser->IsMySelf())
+			return pUser;
+	}
+	return NULL;
+}
+END_ZOOM_SDK_NAMESPACE
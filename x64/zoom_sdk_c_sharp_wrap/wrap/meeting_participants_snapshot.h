@@ -0,0 +1,41 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "zoom_sdk_def.h"
+#include "meeting_service_components/meeting_audio_interface.h"
+#include "meeting_service_components/meeting_participants_ctrl_interface.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+class IMeetingParticipantsControllerWrap;
+
+//Bits of the flags a participant snapshot gives per user.
+typedef enum
+{
+	ParticipantFlag_Host = 1 << 0,
+	ParticipantFlag_CoHost = 1 << 1,
+	ParticipantFlag_AudioMuted = 1 << 2,
+	ParticipantFlag_VideoOn = 1 << 3,
+	ParticipantFlag_Talking = 1 << 4,
+	ParticipantFlag_RaisedHand = 1 << 5,
+	ParticipantFlag_MySelf = 1 << 6,
+	ParticipantFlag_InWaitingRoom = 1 << 7,
+	ParticipantFlag_Left = 1 << 8,///<Only in roster changes, the user has left.
+	ParticipantFlag_NameChanged = 1 << 9,///<Only in roster changes, the name changed since the version asked about.
+}ParticipantFlag;
+
+//Reads the state of every participant straight from the sdk's IUserInfo into arrays the host provides, one array
+//per field, so a roster of any size costs one call across the boundary and no managed wrapper per user.
+class CMeetingParticipantsSnapshot
+{
+public:
+	//fills up to capacity entries in the order of GetParticipantsList(). pFlags, pVoiceLevels and pRoles may be NULL.
+	//Returns how many participants there are, when that is more than capacity only the first capacity were written.
+	static unsigned int Take(IMeetingParticipantsControllerWrap& controller, uint32_t* pUserIds, uint32_t* pFlags,
+		int32_t* pVoiceLevels, int32_t* pRoles, unsigned int capacity);
+	//ParticipantFlag bits of one user, 0 for NULL
+	static uint32_t GetFlags(IUserInfo* pUser);
+	//the local user, NULL outside a meeting
+	static IUserInfo* GetMySelf(IMeetingParticipantsControllerWrap& controller);
+
+private:
+	CMeetingParticipantsSnapshot();
+};
+END_ZOOM_SDK_NAMESPACE
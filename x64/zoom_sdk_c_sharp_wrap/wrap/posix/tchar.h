@@ -0,0 +1,3 @@
+#pragma once
+//The sdk headers include <tchar.h>, which only Windows has. POSIX builds of the raw data media code, e.g.
+//fixture replay on Linux, put this directory on the include path. Nothing from it is used.
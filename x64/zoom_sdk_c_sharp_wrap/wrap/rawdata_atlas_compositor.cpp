@@ -0,0 +1,485 @@
+#include "rawdata_atlas_compositor.h"
+#include <algorithm>
+#include <new>
+BEGIN_ZOOM_SDK_NAMESPACE
+//slot sizes are rounded up to this, so a frame that changes by a few pixels keeps its slot
+#define ATLAS_SLOT_ALIGNMENT 16
+//the atlas grows in steps of this many rows, every step means a new texture on the Unity side
+#define ATLAS_HEIGHT_STEP 256
+
+static unsigned int AlignUp(unsigned int value, unsigned int alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static void GetNominalSize(ZoomSDKResolution resolution, unsigned int& width, unsigned int& height)
+{
+	switch (resolution)
+	{
+	case ZoomSDKResolution_90P:
+		width = 160;
+		height = 90;
+		break;
+	case ZoomSDKResolution_180P:
+		width = 320;
+		height = 180;
+		break;
+	case ZoomSDKResolution_720P:
+		width = 1280;
+		height = 720;
+		break;
+	case ZoomSDKResolution_1080P:
+		width = 1920;
+		height = 1080;
+		break;
+	default:
+		width = 640;
+		height = 360;
+		break;
+	}
+}
+
+struct AtlasPackItem
+{
+	uint32_t userId;
+	unsigned int slotWidth;
+	unsigned int slotHeight;
+};
+
+static bool ComparePackItem(const AtlasPackItem& a, const AtlasPackItem& b)
+{
+	if (a.slotHeight != b.slotHeight)
+		return a.slotHeight > b.slotHeight;
+	if (a.slotWidth != b.slotWidth)
+		return a.slotWidth > b.slotWidth;
+	return a.userId < b.userId;
+}
+
+CRawDataAtlasCompositor::CRawDataAtlasCompositor()
+{
+	m_iCurrent = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nMaxHeight = 0;
+	m_nLayoutVersion = 0;
+	m_nSkipped = 0;
+	m_nTolerance = 2;
+	m_nChangedPermille = 1;
+	m_bDetectChanges = true;
+	m_format = RawDataPixelFormat_RGBA32;
+	m_bFlipVertical = true;
+	m_bInited = false;
+}
+
+CRawDataAtlasCompositor::~CRawDataAtlasCompositor()
+{
+	Uninit();
+}
+
+bool CRawDataAtlasCompositor::Init(unsigned int atlasWidth, unsigned int maxHeight, RawDataPixelFormat format, bool bFlipVertical)
+{
+	Uninit();
+	if (0 == atlasWidth || 0 == maxHeight)
+		return false;
+	m_nWidth = atlasWidth;
+	m_nMaxHeight = maxHeight;
+	m_format = format;
+	m_bFlipVertical = bFlipVertical;
+	m_bInited = true;
+	return true;
+}
+
+void CRawDataAtlasCompositor::Uninit()
+{
+	m_buffers[0].Free();
+	m_buffers[1].Free();
+	m_iCurrent = 0;
+	m_entries.clear();
+	ClearDetectors();
+	m_shelves.clear();
+	m_nHeight = 0;
+	++m_nLayoutVersion;
+	m_bInited = false;
+}
+
+const unsigned char* CRawDataAtlasCompositor::GetBuffer() const
+{
+	return m_nHeight > 0 ? m_buffers[m_iCurrent].GetData() : NULL;
+}
+
+unsigned int CRawDataAtlasCompositor::Compose(CRawDataRendererManager& manager)
+{
+	if (!m_bInited)
+		return 0;
+
+	unsigned int count = manager.GetSubscribedUsers(NULL, 0);
+	m_users.resize(count);
+	if (count > 0)
+		count = (std::min)(count, manager.GetSubscribedUsers(&m_users[0], count));
+	m_users.resize(count);
+	std::sort(m_users.begin(), m_users.end());
+
+	//users that left only leave a hole, it is reclaimed by the next repack
+	bool bHoles = false;
+	EntryMap::iterator iter = m_entries.begin();
+	while (iter != m_entries.end())
+	{
+		if (!std::binary_search(m_users.begin(), m_users.end(), iter->first))
+		{
+			DetectorMap::iterator detector = m_detectors.find(iter->first);
+			if (detector != m_detectors.end())
+			{
+				delete detector->second;
+				m_detectors.erase(detector);
+			}
+			iter = m_entries.erase(iter);
+			bHoles = true;
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	bool bRepack = false;
+	std::vector<uint32_t> newcomers;
+	std::vector<uint32_t> resized;
+	std::vector<CRawDataRendererSlot*> slots(count, (CRawDataRendererSlot*)NULL);
+	m_frames.assign(count, (const CRawDataFrame*)NULL);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		uint32_t userId = m_users[i];
+		slots[i] = manager.GetSlot(userId);
+		if (NULL == slots[i])
+			continue;
+		m_frames[i] = slots[i]->GetFrameRing().AcquireFrame();
+
+		iter = m_entries.find(userId);
+		unsigned int width = 0, height = 0;
+		if (m_frames[i])
+			CRawDataYUVConverter::GetOutputSize(MakeI420PlaneView(m_frames[i]), width, height);
+		else if (iter == m_entries.end())
+			GetNominalSize(slots[i]->GetResolution(), width, height);
+		else
+			continue;
+
+		unsigned int slotWidth = AlignUp(width, ATLAS_SLOT_ALIGNMENT);
+		unsigned int slotHeight = AlignUp(height, ATLAS_SLOT_ALIGNMENT);
+		if (iter == m_entries.end())
+		{
+			AtlasEntry entry;
+			memset(&entry, 0, sizeof(entry));
+			entry.slotWidth = slotWidth;
+			entry.slotHeight = slotHeight;
+			entry.width = width;
+			entry.height = height;
+			m_entries[userId] = entry;
+			newcomers.push_back(userId);
+			continue;
+		}
+		if (slotWidth != iter->second.slotWidth || slotHeight != iter->second.slotHeight)
+		{
+			iter->second.slotWidth = slotWidth;
+			iter->second.slotHeight = slotHeight;
+			resized.push_back(userId);
+			bRepack = true;
+		}
+		iter->second.width = width;
+		iter->second.height = height;
+	}
+
+	for (std::vector<uint32_t>::iterator userIter = newcomers.begin(); !bRepack && userIter != newcomers.end(); ++userIter)
+	{
+		if (!Append(m_entries[*userIter]))
+			bRepack = true;
+	}
+	if (!bRepack && bHoles)
+	{
+		//a hole may now fit someone who was left out before
+		for (iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+		{
+			if (!iter->second.bPlaced)
+			{
+				bRepack = true;
+				break;
+			}
+		}
+	}
+	if (bRepack && !Repack(m_entries))
+	{
+		//the old layout stays, resized users no longer fit their slot and are left out until a repack succeeds
+		for (std::vector<uint32_t>::iterator userIter = resized.begin(); userIter != resized.end(); ++userIter)
+		{
+			AtlasEntry& entry = m_entries[*userIter];
+			entry.bPlaced = false;
+			entry.sequence = 0;
+			entry.drawnWidth = 0;
+			entry.drawnHeight = 0;
+		}
+	}
+
+	unsigned int drawn = 0;
+	unsigned char* pBuffer = m_buffers[m_iCurrent].GetData();
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (NULL == m_frames[i])
+			continue;
+		iter = m_entries.find(m_users[i]);
+		if (pBuffer && iter != m_entries.end() && iter->second.bPlaced)
+		{
+			AtlasEntry& entry = iter->second;
+			//the slot still shows the last drawn frame, a static one adds nothing
+			bool bChanged = IsFrameChanged(m_users[i], m_frames[i]);
+			if (entry.sequence > 0 && !bChanged)
+			{
+				++m_nSkipped;
+				slots[i]->GetFrameRing().ReleaseFrame(m_frames[i]);
+				m_frames[i] = NULL;
+				continue;
+			}
+			unsigned char* pDst = pBuffer + (size_t)entry.y * GetStride() + (size_t)entry.x * 4;
+			if (m_converter.Convert(m_frames[i], pDst, GetStride(), m_format, m_bFlipVertical))
+			{
+				entry.sequence = m_frames[i]->GetSequence();
+				entry.drawnWidth = entry.width;
+				entry.drawnHeight = entry.height;
+				++drawn;
+			}
+		}
+		slots[i]->GetFrameRing().ReleaseFrame(m_frames[i]);
+		m_frames[i] = NULL;
+	}
+	return drawn;
+}
+
+void CRawDataAtlasCompositor::EnableChangeDetection(bool bEnable, unsigned int tolerance, unsigned int changedPermille)
+{
+	m_bDetectChanges = bEnable;
+	m_nTolerance = tolerance;
+	m_nChangedPermille = changedPermille;
+	for (DetectorMap::iterator iter = m_detectors.begin(); iter != m_detectors.end(); ++iter)
+	{
+		iter->second->SetThreshold(tolerance, changedPermille);
+		iter->second->Reset();
+	}
+}
+
+bool CRawDataAtlasCompositor::IsFrameChanged(uint32_t userId, const CRawDataFrame* pFrame)
+{
+	if (!m_bDetectChanges)
+		return true;
+
+	CRawDataChangeDetector* pDetector(NULL);
+	DetectorMap::iterator iter = m_detectors.find(userId);
+	if (iter != m_detectors.end())
+	{
+		pDetector = iter->second;
+	}
+	else
+	{
+		pDetector = new (std::nothrow) CRawDataChangeDetector;
+		if (NULL == pDetector)
+			return true;
+		pDetector->SetThreshold(m_nTolerance, m_nChangedPermille);
+		m_detectors[userId] = pDetector;
+	}
+	return pDetector->IsChanged(pFrame);
+}
+
+void CRawDataAtlasCompositor::ClearDetectors()
+{
+	for (DetectorMap::iterator iter = m_detectors.begin(); iter != m_detectors.end(); ++iter)
+		delete iter->second;
+	m_detectors.clear();
+}
+
+bool CRawDataAtlasCompositor::Append(AtlasEntry& entry)
+{
+	entry.bPlaced = false;
+	if (entry.slotWidth > m_nWidth)
+		return false;
+
+	//best fitting shelf that does not waste more than a quarter of its height
+	AtlasShelf* pBest(NULL);
+	for (std::vector<AtlasShelf>::iterator iter = m_shelves.begin(); iter != m_shelves.end(); ++iter)
+	{
+		if (iter->height < entry.slotHeight || m_nWidth - iter->used < entry.slotWidth)
+			continue;
+		if ((iter->height - entry.slotHeight) * 4 > iter->height)
+			continue;
+		if (NULL == pBest || iter->height < pBest->height)
+			pBest = &(*iter);
+	}
+
+	if (NULL == pBest)
+	{
+		unsigned int top = m_shelves.empty() ? 0 : m_shelves.back().y + m_shelves.back().height;
+		if (top + entry.slotHeight > m_nHeight)
+		{
+			unsigned int height = AlignUp(top + entry.slotHeight, ATLAS_HEIGHT_STEP);
+			if (height > m_nMaxHeight || !ResizeBuffer(height))
+				return false;
+		}
+		AtlasShelf shelf;
+		shelf.y = top;
+		shelf.height = entry.slotHeight;
+		shelf.used = 0;
+		m_shelves.push_back(shelf);
+		pBest = &m_shelves.back();
+	}
+
+	entry.x = pBest->used;
+	entry.y = pBest->y;
+	entry.bPlaced = true;
+	pBest->used += entry.slotWidth;
+	return true;
+}
+
+bool CRawDataAtlasCompositor::Repack(EntryMap& entries)
+{
+	std::vector<AtlasPackItem> items;
+	items.reserve(entries.size());
+	for (EntryMap::iterator iter = entries.begin(); iter != entries.end(); ++iter)
+	{
+		AtlasPackItem item;
+		item.userId = iter->first;
+		item.slotWidth = iter->second.slotWidth;
+		item.slotHeight = iter->second.slotHeight;
+		items.push_back(item);
+	}
+	std::sort(items.begin(), items.end(), ComparePackItem);
+
+	//shelf pack tallest first, then size the atlas to what was used
+	std::vector<AtlasShelf> shelves;
+	std::vector<AtlasEntry> placed(items.size());
+	unsigned int top = 0;
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		AtlasEntry& target = placed[i];
+		memset(&target, 0, sizeof(target));
+		if (items[i].slotWidth > m_nWidth)
+			continue;
+		if (shelves.empty() || m_nWidth - shelves.back().used < items[i].slotWidth)
+		{
+			if (top + items[i].slotHeight > m_nMaxHeight)
+				continue;
+			AtlasShelf shelf;
+			shelf.y = top;
+			shelf.height = items[i].slotHeight;
+			shelf.used = 0;
+			shelves.push_back(shelf);
+			top += items[i].slotHeight;
+		}
+		target.x = shelves.back().used;
+		target.y = shelves.back().y;
+		target.bPlaced = true;
+		shelves.back().used += items[i].slotWidth;
+	}
+
+	unsigned int height = (std::max)(m_nHeight, (std::min)(AlignUp(top, ATLAS_HEIGHT_STEP), m_nMaxHeight));
+	CMediaBuffer& next = m_buffers[1 - m_iCurrent];
+	if (0 == height || !next.Resize((size_t)height * GetStride()))
+		return false;
+	memset(next.GetData(), 0, next.GetSize());
+
+	//carry over slots that already hold a frame, they may not get a new one for a while
+	const unsigned char* pOld = m_nHeight > 0 ? m_buffers[m_iCurrent].GetData() : NULL;
+	for (size_t i = 0; i < items.size(); ++i)
+	{
+		AtlasEntry& entry = entries[items[i].userId];
+		AtlasEntry& target = placed[i];
+		if (pOld && entry.bPlaced && target.bPlaced && entry.sequence > 0)
+		{
+			//the slot size may already be the new frame's, the old slot only holds what was drawn into it
+			unsigned int rows = (std::min)(entry.drawnHeight, entry.slotHeight);
+			size_t bytes = (size_t)(std::min)(entry.drawnWidth, entry.slotWidth) * 4;
+			for (unsigned int row = 0; row < rows; ++row)
+			{
+				memcpy(next.GetData() + (size_t)(target.y + row) * GetStride() + (size_t)target.x * 4,
+					pOld + (size_t)(entry.y + row) * GetStride() + (size_t)entry.x * 4, bytes);
+			}
+		}
+		entry.x = target.x;
+		entry.y = target.y;
+		entry.bPlaced = target.bPlaced;
+		if (entry.bPlaced)
+		{
+			entry.drawnWidth = (std::min)(entry.drawnWidth, entry.slotWidth);
+			entry.drawnHeight = (std::min)(entry.drawnHeight, entry.slotHeight);
+		}
+		else
+		{
+			entry.sequence = 0;
+			entry.drawnWidth = 0;
+			entry.drawnHeight = 0;
+		}
+	}
+
+	m_iCurrent = 1 - m_iCurrent;
+	m_nHeight = height;
+	m_shelves.swap(shelves);
+	++m_nLayoutVersion;
+	return true;
+}
+
+bool CRawDataAtlasCompositor::ResizeBuffer(unsigned int height)
+{
+	//rows keep their buffer offsets, so growing only appends rows. The uvs still change with the height.
+	CMediaBuffer& next = m_buffers[1 - m_iCurrent];
+	size_t oldSize = (size_t)m_nHeight * GetStride();
+	if (!next.Resize((size_t)height * GetStride()))
+		return false;
+	if (oldSize > 0)
+		memcpy(next.GetData(), m_buffers[m_iCurrent].GetData(), oldSize);
+	memset(next.GetData() + oldSize, 0, next.GetSize() - oldSize);
+	m_iCurrent = 1 - m_iCurrent;
+	m_nHeight = height;
+	++m_nLayoutVersion;
+	return true;
+}
+
+void CRawDataAtlasCompositor::FillRect(const AtlasEntry& entry, uint32_t userId, RawDataAtlasRect& rect) const
+{
+	rect.userId = userId;
+	rect.x = entry.x;
+	rect.y = entry.y;
+	rect.width = entry.width;
+	rect.height = entry.height;
+	rect.u0 = (float)entry.x / m_nWidth;
+	rect.v0 = (float)entry.y / m_nHeight;
+	rect.u1 = (float)(entry.x + entry.width) / m_nWidth;
+	rect.v1 = (float)(entry.y + entry.height) / m_nHeight;
+	rect.sequence = entry.sequence;
+}
+
+unsigned int CRawDataAtlasCompositor::GetRectCount() const
+{
+	unsigned int count = 0;
+	for (EntryMap::const_iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+	{
+		if (iter->second.bPlaced)
+			++count;
+	}
+	return count;
+}
+
+unsigned int CRawDataAtlasCompositor::GetRects(RawDataAtlasRect* pRects, unsigned int count) const
+{
+	unsigned int index = 0;
+	for (EntryMap::const_iterator iter = m_entries.begin(); iter != m_entries.end() && index < count && pRects; ++iter)
+	{
+		if (iter->second.bPlaced)
+			FillRect(iter->second, iter->first, pRects[index++]);
+	}
+	return index;
+}
+
+bool CRawDataAtlasCompositor::GetRect(uint32_t userId, RawDataAtlasRect& rect) const
+{
+	EntryMap::const_iterator iter = m_entries.find(userId);
+	if (iter == m_entries.end() || !iter->second.bPlaced || 0 == m_nHeight)
+		return false;
+	FillRect(iter->second, userId, rect);
+	return true;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,117 @@
+#pragma once
+#include "rawdata_renderer_manager.h"
+#include "rawdata_yuv_converter.h"
+#include "rawdata_change_detector.h"
+#include <map>
+#include <vector>
+BEGIN_ZOOM_SDK_NAMESPACE
+//Where one participant lives in the atlas.
+typedef struct tagRawDataAtlasRect
+{
+	uint32_t userId;
+	unsigned int x;///<Left edge in pixels.
+	unsigned int y;///<First buffer row in pixels. With a flipped atlas this is the bottom edge, as Unity expects.
+	unsigned int width;///<Width of the current frame, the slot may be a little larger.
+	unsigned int height;///<Height of the current frame.
+	float u0;
+	float v0;
+	float u1;
+	float v1;
+	unsigned long long sequence;///<Ring sequence of the frame drawn last, 0 while nothing has been drawn.
+}RawDataAtlasRect;
+
+//Packs the latest frame of every user subscribed through a CRawDataRendererManager into one RGBA/BGRA
+//buffer, so Unity uploads a single texture per frame instead of one per participant.
+//Slots are sized from the stream size of the frames, or from the renderer resolution until the first frame
+//arrives, rounded up so small size changes reuse the slot. The layout is only repacked when a slot size
+//changes or a new participant does not fit. Pixels of unchanged slots are carried over on a repack.
+//Frames that a per user CRawDataChangeDetector finds static are not converted at all, and a Compose()
+//that redraws nothing means the texture does not need a new upload.
+//Compose() runs on the manager's consumer thread. Read the buffer from the same thread, or hand it over
+//after Compose() returns.
+class CRawDataAtlasCompositor
+{
+public:
+	CRawDataAtlasCompositor();
+	~CRawDataAtlasCompositor();
+
+	//the atlas is atlasWidth wide and grows in height up to maxHeight. bFlipVertical stores rows bottom-up.
+	bool Init(unsigned int atlasWidth = 4096, unsigned int maxHeight = 4096, RawDataPixelFormat format = RawDataPixelFormat_RGBA32, bool bFlipVertical = true);
+	void Uninit();
+	bool IsInited() const { return m_bInited; }
+
+	//draws the newest frame of every subscribed user and returns how many slots were redrawn
+	unsigned int Compose(CRawDataRendererManager& manager);
+
+	//on by default. See CRawDataChangeDetector::SetThreshold() for the parameters.
+	void EnableChangeDetection(bool bEnable, unsigned int tolerance = 2, unsigned int changedPermille = 1);
+	//frames skipped because they did not change
+	unsigned long long GetSkippedCount() const { return m_nSkipped; }
+
+	const unsigned char* GetBuffer() const;
+	unsigned int GetWidth() const { return m_nWidth; }
+	unsigned int GetHeight() const { return m_nHeight; }
+	unsigned int GetStride() const { return m_nWidth * 4; }
+	//changes whenever slots move or the atlas size changes, the uv table has to be fetched again then
+	unsigned int GetLayoutVersion() const { return m_nLayoutVersion; }
+
+	//users that did not fit into maxHeight have no rect
+	unsigned int GetRectCount() const;
+	//fills pRects with up to count rects and returns how many were written
+	unsigned int GetRects(RawDataAtlasRect* pRects, unsigned int count) const;
+	bool GetRect(uint32_t userId, RawDataAtlasRect& rect) const;
+
+private:
+	CRawDataAtlasCompositor(const CRawDataAtlasCompositor&);
+	CRawDataAtlasCompositor& operator=(const CRawDataAtlasCompositor&);
+
+	struct AtlasEntry
+	{
+		unsigned int x;
+		unsigned int y;
+		unsigned int slotWidth;
+		unsigned int slotHeight;
+		unsigned int width;
+		unsigned int height;
+		unsigned int drawnWidth;///<Size of the frame the slot holds, what a repack carries over.
+		unsigned int drawnHeight;
+		bool bPlaced;
+		unsigned long long sequence;
+	};
+	struct AtlasShelf
+	{
+		unsigned int y;
+		unsigned int height;
+		unsigned int used;
+	};
+	typedef std::map<uint32_t, AtlasEntry> EntryMap;
+	typedef std::map<uint32_t, CRawDataChangeDetector*> DetectorMap;
+
+	bool Append(AtlasEntry& entry);
+	bool Repack(EntryMap& entries);
+	bool ResizeBuffer(unsigned int height);
+	void FillRect(const AtlasEntry& entry, uint32_t userId, RawDataAtlasRect& rect) const;
+	bool IsFrameChanged(uint32_t userId, const CRawDataFrame* pFrame);
+	void ClearDetectors();
+
+	CRawDataYUVConverter m_converter;
+	CMediaBuffer m_buffers[2];
+	int m_iCurrent;
+	EntryMap m_entries;
+	DetectorMap m_detectors;
+	std::vector<AtlasShelf> m_shelves;
+	std::vector<uint32_t> m_users;
+	std::vector<const CRawDataFrame*> m_frames;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+	unsigned int m_nMaxHeight;
+	unsigned int m_nLayoutVersion;
+	unsigned long long m_nSkipped;
+	unsigned int m_nTolerance;
+	unsigned int m_nChangedPermille;
+	bool m_bDetectChanges;
+	RawDataPixelFormat m_format;
+	bool m_bFlipVertical;
+	bool m_bInited;
+};
+END_ZOOM_SDK_NAMESPACE
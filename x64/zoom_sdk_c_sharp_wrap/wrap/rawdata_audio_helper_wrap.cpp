@@ -4,11 +4,9 @@ BEGIN_ZOOM_SDK_NAMESPACE
 IZoomSDKAudioRawDataHelper* InitIZoomSDKAudioRawDataHelperFunc(IZoomSDKAudioRawDataDelegate* pEvent)
 {
 	IZoomSDKAudioRawDataHelper* pObj(NULL);
+	//pEvent is the wrap itself, the delegate is set by subscribe(). An unqualified SetEvent() here would be the
+	//Win32 one, taking the pointer for an event handle.
 	pObj = CSDKImpl::GetInst().GetAudioRawdataHelper();
-	if (pObj)
-	{
-		SetEvent(pEvent);
-	}
 	return pObj;
 }
 
@@ -0,0 +1,142 @@
+#include "rawdata_audio_meter.h"
+#include <emmintrin.h>
+#include <math.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//time constant of the rms
+#define METER_RMS_MS 50.0f
+#define METER_PEAK_FALL_DB_PER_S 20.0f
+//a speaker with no audio for this long reads as silent
+#define METER_STALE_US 200000
+//speech is this far above the noise floor
+#define VAD_MARGIN_DB 9.0f
+//and louder than this
+#define VAD_MIN_DB -55.0f
+#define VAD_NOISE_MIN_DB -70.0f
+#define VAD_NOISE_MAX_DB -25.0f
+//the floor drops to quiet audio at once and creeps up this fast, so speech does not drag it along
+#define VAD_NOISE_RISE_DB_PER_S 3.0f
+#define VAD_ONSET_MS 30.0f
+#define VAD_HANG_MS 300.0f
+
+//sum of squares and largest magnitude of 16 bit samples
+static void MeasureSamples(const short* pSamples, unsigned int count, unsigned long long& sumSquares, int& peak)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	__m128i maxv = zero;
+	__m128i minv = zero;
+	unsigned int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i*)(pSamples + i));
+		//a pair of squares fits 32 bits unsigned, widened before it is added up
+		__m128i squares = _mm_madd_epi16(x, x);
+		acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(squares, zero));
+		acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(squares, zero));
+		maxv = _mm_max_epi16(maxv, x);
+		minv = _mm_min_epi16(minv, x);
+	}
+
+	unsigned long long sums[2];
+	short maxs[8];
+	short mins[8];
+	_mm_storeu_si128((__m128i*)sums, acc);
+	_mm_storeu_si128((__m128i*)maxs, maxv);
+	_mm_storeu_si128((__m128i*)mins, minv);
+	sumSquares = sums[0] + sums[1];
+	int hi = 0;
+	int lo = 0;
+	for (int j = 0; j < 8; ++j)
+	{
+		hi = maxs[j] > hi ? maxs[j] : hi;
+		lo = mins[j] < lo ? mins[j] : lo;
+	}
+	for (; i < count; ++i)
+	{
+		int v = pSamples[i];
+		sumSquares += (unsigned long long)(v * v);
+		hi = v > hi ? v : hi;
+		lo = v < lo ? v : lo;
+	}
+	peak = hi > -lo ? hi : -lo;
+}
+
+CRawDataAudioMeter::CRawDataAudioMeter()
+{
+	Reset();
+}
+
+void CRawDataAudioMeter::Reset()
+{
+	m_fMeanSquare = 0.0f;
+	m_fPeak = 0.0f;
+	m_fNoiseDb = VAD_NOISE_MIN_DB;
+	m_fSpeechMs = 0.0f;
+	m_fHangMs = 0.0f;
+	m_bSpeaking = false;
+	MediaAtomicStoreFloat(&m_nRms, 0.0f);
+	MediaAtomicStoreFloat(&m_nPeak, 0.0f);
+	MediaAtomicStore(&m_bSpeakingOut, 0);
+	MediaAtomicStore64(&m_nUpdateUs, 0);
+}
+
+void CRawDataAudioMeter::Process(const short* pSamples, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long nowUs)
+{
+	if (NULL == pSamples || 0 == frames || 0 == channels || 0 == sampleRate)
+		return;
+
+	unsigned long long sumSquares = 0;
+	int samplePeak = 0;
+	MeasureSamples(pSamples, frames * channels, sumSquares, samplePeak);
+	float meanSquare = (float)((double)sumSquares / ((double)frames * channels * 32768.0 * 32768.0));
+	float chunkMs = frames * 1000.0f / sampleRate;
+
+	m_fMeanSquare += (meanSquare - m_fMeanSquare) * (1.0f - expf(-chunkMs / METER_RMS_MS));
+	float peak = samplePeak / 32768.0f;
+	float fallen = m_fPeak * powf(10.0f, -METER_PEAK_FALL_DB_PER_S * chunkMs / 20000.0f);
+	m_fPeak = peak > fallen ? peak : fallen;
+
+	float db = 10.0f * log10f(meanSquare + 1e-10f);
+	if (db < m_fNoiseDb)
+		m_fNoiseDb = db;
+	else
+		m_fNoiseDb += db - m_fNoiseDb < VAD_NOISE_RISE_DB_PER_S * chunkMs / 1000.0f ? db - m_fNoiseDb : VAD_NOISE_RISE_DB_PER_S * chunkMs / 1000.0f;
+	m_fNoiseDb = m_fNoiseDb < VAD_NOISE_MIN_DB ? VAD_NOISE_MIN_DB : (m_fNoiseDb > VAD_NOISE_MAX_DB ? VAD_NOISE_MAX_DB : m_fNoiseDb);
+
+	if (db > VAD_MIN_DB && db > m_fNoiseDb + VAD_MARGIN_DB)
+	{
+		m_fSpeechMs += chunkMs;
+		if (m_fSpeechMs >= VAD_ONSET_MS)
+		{
+			m_bSpeaking = true;
+			m_fHangMs = VAD_HANG_MS;
+		}
+	}
+	else
+	{
+		m_fSpeechMs = 0.0f;
+		m_fHangMs -= chunkMs;
+		if (m_fHangMs <= 0.0f)
+			m_bSpeaking = false;
+	}
+
+	MediaAtomicStoreFloat(&m_nRms, sqrtf(m_fMeanSquare));
+	MediaAtomicStoreFloat(&m_nPeak, m_fPeak);
+	MediaAtomicStore(&m_bSpeakingOut, m_bSpeaking ? 1 : 0);
+	MediaAtomicStore64(&m_nUpdateUs, nowUs);
+}
+
+void CRawDataAudioMeter::GetLevel(RawDataAudioLevel& level, long long nowUs) const
+{
+	if (nowUs - MediaAtomicLoad64(&m_nUpdateUs) > METER_STALE_US)
+	{
+		level.rms = 0.0f;
+		level.peak = 0.0f;
+		level.speaking = 0;
+		return;
+	}
+	level.rms = MediaAtomicLoadFloat(&m_nRms);
+	level.peak = MediaAtomicLoadFloat(&m_nPeak);
+	level.speaking = MediaAtomicLoad(&m_bSpeakingOut);
+}
+END_ZOOM_SDK_NAMESPACE
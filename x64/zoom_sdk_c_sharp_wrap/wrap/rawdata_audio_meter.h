@@ -0,0 +1,43 @@
+#pragma once
+#include "rawdata_media_common.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//Level of one speaker as published to the host. Layout is shared with the C# side.
+typedef struct tagRawDataAudioLevel
+{
+	uint32_t nodeId;
+	float rms;///<0 to 1, over about the last 50 ms.
+	float peak;///<0 to 1, held and falling back by about 20 dB per second.
+	int speaking;///<1 while voice activity is detected.
+}RawDataAudioLevel;
+
+//Level meter and voice activity detection for one speaker, updated on every chunk the sdk delivers.
+//Speech is energy well above a noise floor that follows the quietest recent audio, so a noisy room does not count
+//as talking. It has to last a moment to start and is held a moment after it ends, so words are not chopped.
+//Process() runs on one thread, the sdk audio thread. GetLevel() may be called from any thread.
+class CRawDataAudioMeter
+{
+public:
+	CRawDataAudioMeter();
+
+	void Process(const short* pSamples, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long nowUs);
+	//only while Process() cannot run
+	void Reset();
+	//levels fall to 0 when no audio came for a while
+	void GetLevel(RawDataAudioLevel& level, long long nowUs) const;
+
+private:
+	//owned by Process()
+	float m_fMeanSquare;
+	float m_fPeak;
+	float m_fNoiseDb;
+	float m_fSpeechMs;///<Speech heard without a gap, towards the onset.
+	float m_fHangMs;///<Time left before speaking ends.
+	bool m_bSpeaking;
+
+	//published
+	volatile LONG m_nRms;
+	volatile LONG m_nPeak;
+	volatile LONG m_bSpeakingOut;
+	volatile LONGLONG m_nUpdateUs;
+};
+END_ZOOM_SDK_NAMESPACE
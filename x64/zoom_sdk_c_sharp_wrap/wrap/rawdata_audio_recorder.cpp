@@ -0,0 +1,393 @@
+#include "rawdata_audio_recorder.h"
+#ifdef _WIN32
+#include <io.h>
+#endif
+BEGIN_ZOOM_SDK_NAMESPACE
+//how often the writer drains the queue, the queue holds a few seconds of a full meeting
+#define AUDIO_RECORDER_FLUSH_MS 100
+//stdio buffer per file, so a drain turns into a few large writes
+#define AUDIO_RECORDER_FILE_BUFFER (256 * 1024)
+//files grow by this much at a time
+#define AUDIO_RECORDER_GROW_BYTES (8 * 1024 * 1024)
+//a longer pause between chunks is filled with silence up to the time the next one was heard
+#define AUDIO_RECORDER_GAP_US 200000
+//samples in one part, within the 32 bit sizes of the header
+#define AUDIO_RECORDER_MAX_DATA_BYTES 0xFFF00000ULL
+
+typedef struct tagWavHeader
+{
+	char riff[4];
+	uint32_t riffSize;
+	char wave[4];
+	char fmt[4];
+	uint32_t fmtSize;
+	uint16_t format;
+	uint16_t channels;
+	uint32_t sampleRate;
+	uint32_t byteRate;
+	uint16_t blockAlign;
+	uint16_t bitsPerSample;
+	char data[4];
+	uint32_t dataSize;
+}WavHeader;
+
+static bool SeekFile(FILE* pFile, unsigned long long offset)
+{
+#ifdef _WIN32
+	return 0 == _fseeki64(pFile, (long long)offset, SEEK_SET);
+#else
+	return 0 == fseeko(pFile, (off_t)offset, SEEK_SET);
+#endif
+}
+
+//sets the end of the file without moving the position, growing it or cutting it back
+static bool ResizeFile(FILE* pFile, unsigned long long size)
+{
+	if (0 != fflush(pFile))
+		return false;
+#ifdef _WIN32
+	HANDLE hFile = (HANDLE)_get_osfhandle(_fileno(pFile));
+	LARGE_INTEGER zero, current, end;
+	zero.QuadPart = 0;
+	end.QuadPart = (LONGLONG)size;
+	if (!SetFilePointerEx(hFile, zero, &current, FILE_CURRENT) || !SetFilePointerEx(hFile, end, NULL, FILE_BEGIN))
+		return false;
+	bool bResized = FALSE != SetEndOfFile(hFile);
+	SetFilePointerEx(hFile, current, NULL, FILE_BEGIN);
+	return bResized;
+#else
+	return 0 == ftruncate(fileno(pFile), (off_t)size);
+#endif
+}
+
+//writes the header for the samples so far and goes back to the end of them
+static bool WriteWavHeader(FILE* pFile, unsigned int sampleRate, unsigned int channels, unsigned long long dataBytes)
+{
+	WavHeader header;
+	memcpy(header.riff, "RIFF", 4);
+	header.riffSize = (uint32_t)(sizeof(WavHeader) - 8 + dataBytes);
+	memcpy(header.wave, "WAVE", 4);
+	memcpy(header.fmt, "fmt ", 4);
+	header.fmtSize = 16;
+	header.format = 1;
+	header.channels = (uint16_t)channels;
+	header.sampleRate = sampleRate;
+	header.byteRate = sampleRate * channels * sizeof(short);
+	header.blockAlign = (uint16_t)(channels * sizeof(short));
+	header.bitsPerSample = 16;
+	memcpy(header.data, "data", 4);
+	header.dataSize = (uint32_t)dataBytes;
+	if (!SeekFile(pFile, 0) || 1 != fwrite(&header, sizeof(header), 1, pFile))
+		return false;
+	return SeekFile(pFile, sizeof(WavHeader) + dataBytes);
+}
+
+CRawDataAudioRecorder& CRawDataAudioRecorder::GetInst()
+{
+	static CRawDataAudioRecorder inst;
+	return inst;
+}
+
+CRawDataAudioRecorder::CRawDataAudioRecorder()
+{
+	m_nState = AUDIO_RECORDER_CLOSED;
+	m_bOneWay = 0;
+	m_nEnqueue = 0;
+	m_nStartUs = 0;
+	m_bQuit = 0;
+	m_nDequeue = 0;
+	memset(&m_mixed, 0, sizeof(m_mixed));
+	m_nDropped = 0;
+	m_nFailed = 0;
+	m_nWrittenBytes = 0;
+}
+
+bool CRawDataAudioRecorder::Start(const char* directory, bool bOneWay)
+{
+	if (NULL == directory || m_thread.IsStarted())
+		return false;
+	if (!m_cells.Resize(AUDIO_RECORDER_CELLS * sizeof(AudioRecorderCell)))
+		return false;
+	AudioRecorderCell* pCells = (AudioRecorderCell*)m_cells.GetData();
+	for (LONG i = 0; i < AUDIO_RECORDER_CELLS; ++i)
+		pCells[i].sequence = i;
+	m_nEnqueue = 0;
+	m_nDequeue = 0;
+	m_directory = directory;
+	memset(&m_mixed, 0, sizeof(m_mixed));
+	m_tracks.clear();
+	MediaAtomicStore64(&m_nDropped, 0);
+	MediaAtomicStore64(&m_nFailed, 0);
+	MediaAtomicStore64(&m_nWrittenBytes, 0);
+	MediaAtomicStore(&m_bQuit, 0);
+	m_nStartUs = MediaGetTimeUs();
+	if (!m_thread.Start(WriterProc, this))
+	{
+		m_cells.Free();
+		return false;
+	}
+	MediaAtomicStore(&m_bOneWay, bOneWay ? 1 : 0);
+	MediaAtomicStore(&m_nState, 0);
+	return true;
+}
+
+void CRawDataAudioRecorder::Stop()
+{
+	if (!m_thread.IsStarted())
+		return;
+	LONG state = MediaAtomicLoad(&m_nState);
+	for (;;)
+	{
+		LONG previous = MediaAtomicCompareExchange(&m_nState, state | AUDIO_RECORDER_CLOSED, state);
+		if (previous == state)
+			break;
+		state = previous;
+	}
+	//a callback that got in before the bit was set is still copying
+	while (AUDIO_RECORDER_CLOSED != MediaAtomicLoad(&m_nState))
+		MediaSleepMs(1);
+
+	//the writer drains the queue and closes the files before it returns
+	MediaAtomicStore(&m_bQuit, 1);
+	m_event.Set();
+	m_thread.Join();
+	m_tracks.clear();
+	m_cells.Free();
+}
+
+void CRawDataAudioRecorder::WriteMixed(AudioRawData* data)
+{
+	Write(data, 0, true);
+}
+
+void CRawDataAudioRecorder::WriteOneWay(uint32_t nodeId, AudioRawData* data)
+{
+	Write(data, nodeId, false);
+}
+
+void CRawDataAudioRecorder::Write(AudioRawData* data, uint32_t nodeId, bool bMixed)
+{
+	if (NULL == data || !IsRecording())
+		return;
+	if (MediaAtomicIncrement(&m_nState) & AUDIO_RECORDER_CLOSED)
+	{
+		MediaAtomicDecrement(&m_nState);
+		return;
+	}
+
+	const char* pData = data->GetBuffer();
+	unsigned int channels = data->GetChannelNum();
+	unsigned int sampleRate = data->GetSampleRate();
+	unsigned int frameBytes = channels * sizeof(short);
+	if ((bMixed || 0 != MediaAtomicLoad(&m_bOneWay)) && NULL != pData && channels > 0 && sampleRate > 0 && frameBytes <= AUDIO_RECORDER_CELL_BYTES)
+	{
+		unsigned int frames = data->GetBufferLen() / frameBytes;
+		long long arrivalUs = MediaGetTimeUs() - m_nStartUs;
+		long long startUs = arrivalUs - (long long)frames * 1000000 / sampleRate;
+		//larger chunks are split on whole frames
+		unsigned int cellFrames = AUDIO_RECORDER_CELL_BYTES / frameBytes;
+		for (unsigned int done = 0; done < frames; done += cellFrames)
+		{
+			unsigned int count = frames - done < cellFrames ? frames - done : cellFrames;
+			long long cellStartUs = startUs + (long long)done * 1000000 / sampleRate;
+			if (!Queue(pData + (size_t)done * frameBytes, count * frameBytes, nodeId, bMixed, sampleRate, channels, cellStartUs, arrivalUs))
+			{
+				MediaAtomicIncrement64(&m_nDropped);
+				break;
+			}
+		}
+	}
+	MediaAtomicDecrement(&m_nState);
+}
+
+bool CRawDataAudioRecorder::Queue(const char* pData, unsigned int bytes, uint32_t nodeId, bool bMixed, unsigned int sampleRate, unsigned int channels, long long startUs, long long arrivalUs)
+{
+	//bounded multi-producer queue: a producer claims the cell at m_nEnqueue once the writer has emptied it, and
+	//hands it over by moving its sequence on
+	AudioRecorderCell* pCells = (AudioRecorderCell*)m_cells.GetData();
+	LONG pos = MediaAtomicLoad(&m_nEnqueue);
+	for (;;)
+	{
+		AudioRecorderCell& cell = pCells[(ULONG)pos & (AUDIO_RECORDER_CELLS - 1)];
+		LONG diff = (LONG)((ULONG)MediaAtomicLoad(&cell.sequence) - (ULONG)pos);
+		if (diff < 0)
+			return false;
+		if (diff > 0)
+		{
+			pos = MediaAtomicLoad(&m_nEnqueue);
+			continue;
+		}
+		LONG previous = MediaAtomicCompareExchange(&m_nEnqueue, (LONG)((ULONG)pos + 1), pos);
+		if (previous != pos)
+		{
+			pos = previous;
+			continue;
+		}
+
+		cell.nodeId = nodeId;
+		cell.bMixed = bMixed ? 1 : 0;
+		cell.sampleRate = sampleRate;
+		cell.channels = channels;
+		cell.bytes = bytes;
+		cell.startUs = startUs;
+		cell.arrivalUs = arrivalUs;
+		memcpy(cell.data, pData, bytes);
+		MediaAtomicStore(&cell.sequence, (LONG)((ULONG)pos + 1));
+		return true;
+	}
+}
+
+void CRawDataAudioRecorder::WriterProc(void* pParam)
+{
+	((CRawDataAudioRecorder*)pParam)->WriterLoop();
+}
+
+void CRawDataAudioRecorder::WriterLoop()
+{
+	while (0 == MediaAtomicLoad(&m_bQuit))
+	{
+		m_event.Wait(AUDIO_RECORDER_FLUSH_MS);
+		Drain();
+	}
+	//no callback is left to queue more
+	Drain();
+	CloseTrack(m_mixed);
+	for (AudioRecorderTrackMap::iterator it = m_tracks.begin(); it != m_tracks.end(); ++it)
+		CloseTrack(it->second);
+}
+
+unsigned int CRawDataAudioRecorder::Drain()
+{
+	AudioRecorderCell* pCells = (AudioRecorderCell*)m_cells.GetData();
+	unsigned int count = 0;
+	for (;; ++count)
+	{
+		AudioRecorderCell& cell = pCells[(ULONG)m_nDequeue & (AUDIO_RECORDER_CELLS - 1)];
+		if ((ULONG)MediaAtomicLoad(&cell.sequence) != (ULONG)m_nDequeue + 1)
+			break;
+		if (cell.bMixed)
+		{
+			WriteCell(m_mixed, cell);
+		}
+		else
+		{
+			AudioRecorderTrackMap::iterator it = m_tracks.find(cell.nodeId);
+			if (m_tracks.end() == it)
+			{
+				AudioRecorderTrack track;
+				memset(&track, 0, sizeof(track));
+				it = m_tracks.insert(std::make_pair(cell.nodeId, track)).first;
+			}
+			WriteCell(it->second, cell);
+		}
+		MediaAtomicStore(&cell.sequence, (LONG)((ULONG)m_nDequeue + AUDIO_RECORDER_CELLS));
+		m_nDequeue = (LONG)((ULONG)m_nDequeue + 1);
+	}
+	return count;
+}
+
+void CRawDataAudioRecorder::WriteCell(AudioRecorderTrack& track, const AudioRecorderCell& cell)
+{
+	unsigned int frameBytes = cell.channels * sizeof(short);
+	//silence over a pause, or from the start of the recording to the first chunk
+	unsigned long long silenceBytes = 0;
+	if (0 == track.lastArrivalUs || cell.arrivalUs - track.lastArrivalUs > AUDIO_RECORDER_GAP_US)
+	{
+		double gapUs = cell.startUs - track.writtenUs;
+		if (gapUs > 0.0)
+			silenceBytes = (unsigned long long)(gapUs * cell.sampleRate / 1000000.0) * frameBytes;
+	}
+	track.lastArrivalUs = cell.arrivalUs;
+
+	if (track.pFile && (cell.sampleRate != track.sampleRate || cell.channels != track.channels || track.dataBytes + silenceBytes + cell.bytes > AUDIO_RECORDER_MAX_DATA_BYTES))
+	{
+		CloseTrack(track);
+		++track.part;
+	}
+	if (NULL == track.pFile && !OpenTrack(track, cell))
+	{
+		MediaAtomicIncrement64(&m_nFailed);
+		return;
+	}
+
+	static const char s_silence[4096] = { 0 };
+	while (silenceBytes > 0)
+	{
+		unsigned long long bytes = silenceBytes < sizeof(s_silence) ? silenceBytes : sizeof(s_silence) / frameBytes * frameBytes;
+		if (!WriteSamples(track, s_silence, bytes))
+			return;
+		silenceBytes -= bytes;
+	}
+	WriteSamples(track, cell.data, cell.bytes);
+}
+
+bool CRawDataAudioRecorder::OpenTrack(AudioRecorderTrack& track, const AudioRecorderCell& cell)
+{
+	char name[64];
+	if (cell.bMixed && track.part > 1)
+		snprintf(name, sizeof(name), "mixed_%u.wav", track.part);
+	else if (cell.bMixed)
+		snprintf(name, sizeof(name), "mixed.wav");
+	else if (track.part > 1)
+		snprintf(name, sizeof(name), "speaker_%u_%u.wav", cell.nodeId, track.part);
+	else
+		snprintf(name, sizeof(name), "speaker_%u.wav", cell.nodeId);
+	std::string path = m_directory;
+	if (!path.empty() && '/' != path[path.size() - 1] && '\\' != path[path.size() - 1])
+		path += '/';
+	path += name;
+
+	track.pFile = MediaOpenFile(path.c_str(), "wb");
+	if (NULL == track.pFile)
+		return false;
+	setvbuf(track.pFile, NULL, _IOFBF, AUDIO_RECORDER_FILE_BUFFER);
+	if (0 == track.part)
+		track.part = 1;
+	track.sampleRate = cell.sampleRate;
+	track.channels = cell.channels;
+	track.dataBytes = 0;
+	track.allocatedBytes = 0;
+	if (!WriteWavHeader(track.pFile, track.sampleRate, track.channels, 0))
+	{
+		fclose(track.pFile);
+		track.pFile = NULL;
+		return false;
+	}
+	return true;
+}
+
+void CRawDataAudioRecorder::CloseTrack(AudioRecorderTrack& track)
+{
+	if (NULL == track.pFile)
+		return;
+	WriteWavHeader(track.pFile, track.sampleRate, track.channels, track.dataBytes);
+	//give back what was grown but not written
+	ResizeFile(track.pFile, sizeof(WavHeader) + track.dataBytes);
+	fclose(track.pFile);
+	track.pFile = NULL;
+}
+
+bool CRawDataAudioRecorder::WriteSamples(AudioRecorderTrack& track, const char* pData, unsigned long long bytes)
+{
+	if (track.dataBytes + bytes > track.allocatedBytes)
+	{
+		//growing in large steps keeps the file in few pieces on disk, the header is brought up to date on the
+		//way so a recording cut short by a crash still plays up to here
+		unsigned long long allocated = track.allocatedBytes + AUDIO_RECORDER_GROW_BYTES;
+		if (allocated > AUDIO_RECORDER_MAX_DATA_BYTES)
+			allocated = AUDIO_RECORDER_MAX_DATA_BYTES;
+		if (ResizeFile(track.pFile, sizeof(WavHeader) + allocated))
+			track.allocatedBytes = allocated;
+		WriteWavHeader(track.pFile, track.sampleRate, track.channels, track.dataBytes);
+	}
+	if (1 != fwrite(pData, (size_t)bytes, 1, track.pFile))
+	{
+		MediaAtomicIncrement64(&m_nFailed);
+		return false;
+	}
+	track.dataBytes += bytes;
+	track.writtenUs += (double)bytes / (track.channels * sizeof(short)) * 1000000.0 / track.sampleRate;
+	MediaAtomicStore64(&m_nWrittenBytes, MediaAtomicLoad64(&m_nWrittenBytes) + (LONGLONG)bytes);
+	return true;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,107 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "zoom_sdk_def.h"
+#include "zoom_sdk_raw_data_def.h"
+#include "rawdata/rawdata_audio_helper_interface.h"
+#include <stdio.h>
+#include <map>
+#include <string>
+BEGIN_ZOOM_SDK_NAMESPACE
+//queued audio, a cell holds a whole 10 ms chunk of 48 kHz stereo, larger chunks take several
+#define AUDIO_RECORDER_CELLS 4096
+#define AUDIO_RECORDER_CELL_BYTES 2048
+
+typedef struct tagAudioRecorderCell
+{
+	volatile LONG sequence;///<Which lap of the queue the cell is free or filled for.
+	uint32_t nodeId;
+	uint32_t bMixed;
+	uint32_t sampleRate;
+	uint32_t channels;
+	uint32_t bytes;
+	long long startUs;///<When the first sample was heard, from the start of the recording.
+	long long arrivalUs;
+	char data[AUDIO_RECORDER_CELL_BYTES];
+}AudioRecorderCell;
+
+//Records the meeting mix, and optionally every speaker, to separate 16 bit PCM WAV files for processing after the
+//event. The sdk callbacks only copy the audio into a preallocated lock-free queue and return, a full queue drops
+//the chunk instead of waiting. A writer thread drains the queue every 100 ms into large buffered
+//writes, grows the files in big steps so they stay contiguous and writes the final sizes into the headers on Stop().
+//Tracks are padded with silence over the pauses in their stream, so every file starts with the recording and
+//they can be laid over each other as they are. A change of format, or a file reaching the 4 GB limit of WAV,
+//continues in a numbered next part.
+class CRawDataAudioRecorder
+{
+public:
+	static CRawDataAudioRecorder& GetInst();
+
+	//writes mixed.wav, and speaker_<node id>.wav per speaker when bOneWay, into directory, which has to exist
+	bool Start(const char* directory, bool bOneWay);
+	//waits for the callbacks still copying and the queued audio to be written, then closes the files
+	void Stop();
+	bool IsRecording() const { return 0 == (MediaAtomicLoad(&m_nState) & AUDIO_RECORDER_CLOSED); }
+
+	//sdk audio thread, any number of them. Copies the chunk when recording and returns.
+	void WriteMixed(AudioRawData* data);
+	void WriteOneWay(uint32_t nodeId, AudioRawData* data);
+
+	//chunks lost because the writer fell behind
+	unsigned long long GetDroppedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nDropped); }
+	//chunks lost because a file could not be opened or written
+	unsigned long long GetFailedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nFailed); }
+	//sample bytes written to the files, silence included
+	unsigned long long GetWrittenBytes() const { return (unsigned long long)MediaAtomicLoad64(&m_nWrittenBytes); }
+
+private:
+	//m_nState is the number of callbacks inside Write(), with this bit set while not recording
+	enum { AUDIO_RECORDER_CLOSED = 0x40000000 };
+
+	typedef struct tagAudioRecorderTrack
+	{
+		FILE* pFile;
+		unsigned int sampleRate;
+		unsigned int channels;
+		unsigned int part;///<Numbered from 1, the first part has no number in its name.
+		unsigned long long dataBytes;///<Samples in the open part.
+		unsigned long long allocatedBytes;///<Room for samples the file was grown to.
+		double writtenUs;///<Duration of every part written so far, silence included.
+		long long lastArrivalUs;
+	}AudioRecorderTrack;
+	typedef std::map<uint32_t, AudioRecorderTrack> AudioRecorderTrackMap;
+
+	CRawDataAudioRecorder();
+	CRawDataAudioRecorder(const CRawDataAudioRecorder&);
+	CRawDataAudioRecorder& operator=(const CRawDataAudioRecorder&);
+	void Write(AudioRawData* data, uint32_t nodeId, bool bMixed);
+	bool Queue(const char* pData, unsigned int bytes, uint32_t nodeId, bool bMixed, unsigned int sampleRate, unsigned int channels, long long startUs, long long arrivalUs);
+	static void WriterProc(void* pParam);
+	void WriterLoop();
+	//writes every filled cell, returns how many there were
+	unsigned int Drain();
+	void WriteCell(AudioRecorderTrack& track, const AudioRecorderCell& cell);
+	bool OpenTrack(AudioRecorderTrack& track, const AudioRecorderCell& cell);
+	void CloseTrack(AudioRecorderTrack& track);
+	bool WriteSamples(AudioRecorderTrack& track, const char* pData, unsigned long long bytes);
+
+	//producers
+	volatile LONG m_nState;
+	volatile LONG m_bOneWay;
+	volatile LONG m_nEnqueue;
+	long long m_nStartUs;
+	CMediaBuffer m_cells;
+
+	//writer thread
+	CMediaThread m_thread;
+	CMediaEvent m_event;
+	volatile LONG m_bQuit;
+	LONG m_nDequeue;
+	std::string m_directory;
+	AudioRecorderTrack m_mixed;
+	AudioRecorderTrackMap m_tracks;
+
+	volatile LONGLONG m_nDropped;
+	volatile LONGLONG m_nFailed;
+	volatile LONGLONG m_nWrittenBytes;
+};
+END_ZOOM_SDK_NAMESPACE
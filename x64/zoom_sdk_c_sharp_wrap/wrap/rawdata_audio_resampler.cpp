@@ -0,0 +1,141 @@
+#include "rawdata_audio_resampler.h"
+#include <xmmintrin.h>
+#include <math.h>
+#include <string.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//passband as a share of the lower Nyquist frequency, the rest is the transition band
+#define RESAMPLER_CUTOFF 0.9
+//input samples before the output position that the filter reads, the rest come after it
+#define RESAMPLER_HISTORY (RESAMPLER_TAPS / 2 - 1)
+
+CRawDataAudioResampler::CRawDataAudioResampler()
+{
+	m_nInRate = 0;
+	m_nOutRate = 0;
+	m_nChannels = 1;
+	m_baseStep = 1.0;
+	m_step = 1.0;
+	memset(m_bank, 0, sizeof(m_bank));
+	Reset();
+}
+
+bool CRawDataAudioResampler::Configure(unsigned int inRate, unsigned int outRate, unsigned int channels)
+{
+	if (0 == inRate || 0 == outRate || 0 == channels || channels > RESAMPLER_MAX_CHANNELS)
+		return false;
+	if (inRate > outRate * RESAMPLER_MAX_STEP)
+		return false;
+	if (inRate == m_nInRate && outRate == m_nOutRate && channels == m_nChannels)
+		return true;
+
+	m_nInRate = inRate;
+	m_nOutRate = outRate;
+	m_nChannels = channels;
+	m_baseStep = (double)inRate / outRate;
+	m_step = m_baseStep;
+	//Blackman windowed sinc, tap j of phase p sits j - RESAMPLER_HISTORY - p / RESAMPLER_PHASES input
+	//samples from the output. Phase RESAMPLER_PHASES is the next sample's phase 0, for the interpolation.
+	const double pi = 3.14159265358979323846;
+	double fc = 0.5 * RESAMPLER_CUTOFF * (outRate < inRate ? (double)outRate / inRate : 1.0);
+	double half = RESAMPLER_TAPS / 2.0;
+	for (int p = 0; p <= RESAMPLER_PHASES; ++p)
+	{
+		float* pTaps = m_bank + p * RESAMPLER_TAPS;
+		double sum = 0.0;
+		for (int j = 0; j < RESAMPLER_TAPS; ++j)
+		{
+			double x = j - RESAMPLER_HISTORY - (double)p / RESAMPLER_PHASES;
+			double h = 0.0;
+			if (fabs(x) < half)
+			{
+				double window = 0.42 + 0.5 * cos(pi * x / half) + 0.08 * cos(2.0 * pi * x / half);
+				double sinc = 0.0 == x ? 1.0 : sin(2.0 * pi * fc * x) / (2.0 * pi * fc * x);
+				h = window * sinc;
+			}
+			pTaps[j] = (float)h;
+			sum += h;
+		}
+		//unity gain at DC for every phase
+		for (int j = 0; j < RESAMPLER_TAPS; ++j)
+			pTaps[j] = (float)(pTaps[j] / sum);
+	}
+	Reset();
+	return true;
+}
+
+void CRawDataAudioResampler::Reset()
+{
+	m_nBuffered = RESAMPLER_HISTORY;
+	m_pos = m_nBuffered;
+	for (int c = 0; c < RESAMPLER_MAX_CHANNELS; ++c)
+		memset(m_buffer[c], 0, m_nBuffered * sizeof(float));
+}
+
+void CRawDataAudioResampler::SetRateAdjust(double adjust)
+{
+	m_step = m_baseStep * (1.0 + adjust);
+	if (m_step > RESAMPLER_MAX_STEP)
+		m_step = RESAMPLER_MAX_STEP;
+}
+
+unsigned int CRawDataAudioResampler::GetInputFrames(unsigned int outFrames) const
+{
+	if (0 == outFrames)
+		return 0;
+	unsigned int last = (unsigned int)(m_pos + (outFrames - 1) * m_step);
+	unsigned int total = last + RESAMPLER_TAPS / 2 + 1;
+	return total > m_nBuffered ? total - m_nBuffered : 0;
+}
+
+void CRawDataAudioResampler::Process(unsigned int inFrames, float* pOut, unsigned int outFrames, unsigned int stride)
+{
+	m_nBuffered += inFrames;
+	//outputs that land on input samples are the samples themselves
+	bool bPassThrough = 1.0 == m_step && m_pos == floor(m_pos);
+	for (unsigned int i = 0; bPassThrough && i < outFrames; ++i)
+	{
+		for (unsigned int c = 0; c < m_nChannels; ++c)
+			pOut[(size_t)i * stride + c] = m_buffer[c][(unsigned int)m_pos + i];
+	}
+	for (unsigned int i = 0; !bPassThrough && i < outFrames; ++i)
+	{
+		double t = m_pos + i * m_step;
+		unsigned int index = (unsigned int)t;
+		double phase = (t - index) * RESAMPLER_PHASES;
+		unsigned int p = (unsigned int)phase;
+		__m128 a = _mm_set1_ps((float)(phase - p));
+
+		//taps for this offset, interpolated between the two nearest phases
+		const float* pTaps0 = m_bank + p * RESAMPLER_TAPS;
+		const float* pTaps1 = pTaps0 + RESAMPLER_TAPS;
+		__m128 taps[RESAMPLER_TAPS / 4];
+		for (int j = 0; j < RESAMPLER_TAPS / 4; ++j)
+		{
+			__m128 h0 = _mm_loadu_ps(pTaps0 + j * 4);
+			__m128 h1 = _mm_loadu_ps(pTaps1 + j * 4);
+			taps[j] = _mm_add_ps(h0, _mm_mul_ps(a, _mm_sub_ps(h1, h0)));
+		}
+
+		for (unsigned int c = 0; c < m_nChannels; ++c)
+		{
+			const float* pIn = m_buffer[c] + index - RESAMPLER_HISTORY;
+			__m128 acc = _mm_mul_ps(taps[0], _mm_loadu_ps(pIn));
+			for (int j = 1; j < RESAMPLER_TAPS / 4; ++j)
+				acc = _mm_add_ps(acc, _mm_mul_ps(taps[j], _mm_loadu_ps(pIn + j * 4)));
+			acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+			acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+			pOut[(size_t)i * stride + c] = _mm_cvtss_f32(acc);
+		}
+	}
+
+	//keep what the next output still reads
+	m_pos += outFrames * m_step;
+	unsigned int drop = (unsigned int)m_pos - RESAMPLER_HISTORY;
+	if (drop > m_nBuffered)
+		drop = m_nBuffered;
+	for (unsigned int c = 0; c < m_nChannels; ++c)
+		memmove(m_buffer[c], m_buffer[c] + drop, (m_nBuffered - drop) * sizeof(float));
+	m_nBuffered -= drop;
+	m_pos -= drop;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,58 @@
+#pragma once
+#include "rawdata_media_common.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define RESAMPLER_TAPS 32
+#define RESAMPLER_PHASES 64
+#define RESAMPLER_MAX_CHANNELS 2
+//output frames per Process() call
+#define RESAMPLER_BLOCK 256
+//highest input rate over output rate
+#define RESAMPLER_MAX_STEP 8
+
+//Streaming polyphase resampler for one stream of up to RESAMPLER_MAX_CHANNELS planar float channels. A windowed
+//sinc is kept for RESAMPLER_PHASES offsets between two input samples, and the offsets in between are interpolated,
+//so any pair of rates works without a bank per ratio. When downsampling the cutoff follows the output rate, so
+//nothing above its Nyquist frequency aliases back. Equal rates pass the input through untouched, until
+//SetRateAdjust() moves the ratio off 1.
+//The caller pulls: GetInputFrames() says how much input the next outFrames need, the caller writes that much to
+//GetInput() for every channel and Process() turns it into output. Nothing allocates, the bank is rebuilt by
+//Configure() only when the rates change.
+class CRawDataAudioResampler
+{
+public:
+	CRawDataAudioResampler();
+
+	//returns false for rates it cannot convert, keeping the previous configuration. Changing anything resets the stream.
+	bool Configure(unsigned int inRate, unsigned int outRate, unsigned int channels);
+	//forgets the history, as if the stream started over
+	void Reset();
+	//consumes 1 + adjust times the configured input per output, e.g. 0.001 plays 0.1% faster to catch up with a
+	//sender whose clock runs ahead. Takes effect smoothly on the next Process().
+	void SetRateAdjust(double adjust);
+	unsigned int GetInputRate() const { return m_nInRate; }
+	unsigned int GetOutputRate() const { return m_nOutRate; }
+	unsigned int GetChannels() const { return m_nChannels; }
+
+	//input frames Process() needs for outFrames more output, outFrames at most RESAMPLER_BLOCK
+	unsigned int GetInputFrames(unsigned int outFrames) const;
+	//where the input of a channel goes, room for GetInputFrames() frames
+	float* GetInput(unsigned int channel) { return m_buffer[channel] + m_nBuffered; }
+	//takes inFrames from GetInput() and writes outFrames interleaved with stride floats per frame. Only the first
+	//GetChannels() floats of a frame are written.
+	void Process(unsigned int inFrames, float* pOut, unsigned int outFrames, unsigned int stride);
+
+private:
+	CRawDataAudioResampler(const CRawDataAudioResampler&);
+	CRawDataAudioResampler& operator=(const CRawDataAudioResampler&);
+
+	unsigned int m_nInRate;
+	unsigned int m_nOutRate;
+	unsigned int m_nChannels;
+	double m_baseStep;///<Input frames per output frame as configured.
+	double m_step;///<The same with the rate adjustment.
+	double m_pos;///<Where the next output falls in m_buffer, in input frames.
+	unsigned int m_nBuffered;
+	float m_bank[(RESAMPLER_PHASES + 1) * RESAMPLER_TAPS];
+	float m_buffer[RESAMPLER_MAX_CHANNELS][RESAMPLER_TAPS + RESAMPLER_BLOCK * RESAMPLER_MAX_STEP + 4];
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,517 @@
+#include "rawdata_audio_ring.h"
+#include "rawdata_fixture.h"
+#include <string.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+#define AUDIO_SLOT_READING 1
+#define AUDIO_SLOT_MOVING 2
+//a speaker silent for this long gives the slot up to a new one
+#define AUDIO_RING_IDLE_US 3000000
+//GetSpeakers() lists the speakers heard within this time
+#define AUDIO_RING_ACTIVE_US 1000000
+//a longer gap between chunks is a pause in the speech, not jitter
+#define JITTER_GAP_US 500000
+//the jitter buffer holds at least this much, plus a few times the jitter
+#define JITTER_MIN_TARGET_US 30000
+#define JITTER_TARGET_FACTOR 3
+#define JITTER_MAX_TARGET_US 200000
+//playback speed change per share of the target the level is off by, and the most it changes, 0.5% is about 9 cents
+#define DRIFT_GAIN 0.02f
+#define DRIFT_MAX_ADJUST 0.005f
+//time constant of the level that is steered, long enough to smooth out the chunk arrivals
+#define DRIFT_LEVEL_TAU_US 1000000.0f
+
+CRawDataAudioRing::CRawDataAudioRing()
+{
+	for (int i = 0; i < AUDIO_RING_CHUNKS; ++i)
+	{
+		m_chunks[i].pRef = NULL;
+		m_chunks[i].pSamples = NULL;
+		m_chunks[i].frames = 0;
+		m_chunks[i].channels = 0;
+		m_chunks[i].sampleRate = 0;
+	}
+	m_nHead = 0;
+	m_nTail = 0;
+	m_nOffset = 0;
+	m_nPushedFrames = 0;
+	m_nReadFrames = 0;
+	m_nSampleRate = 0;
+	m_nDropped = 0;
+	m_nUnderruns = 0;
+	m_nSkippedFrames = 0;
+	m_nLastArrivalUs = 0;
+	m_fLastChunkUs = 0.0f;
+	m_fJitterUs = 0.0f;
+	m_bPrimed = false;
+	m_fLevelUs = 0.0f;
+	m_nJitterUs = 0;
+	m_nTargetUs = 0;
+	m_nRateAdjust = 0;
+}
+
+CRawDataAudioRing::~CRawDataAudioRing()
+{
+	Clear();
+}
+
+void CRawDataAudioRing::ReleaseChunk(RawDataAudioChunk& chunk)
+{
+	if (chunk.pRef)
+	{
+		chunk.pRef->Release();
+		chunk.pRef = NULL;
+	}
+	chunk.pSamples = NULL;
+}
+
+void CRawDataAudioRing::Clear()
+{
+	for (ULONG tail = (ULONG)m_nTail; tail != (ULONG)m_nHead; ++tail)
+		ReleaseChunk(m_chunks[tail & (AUDIO_RING_CHUNKS - 1)]);
+	m_nHead = 0;
+	m_nTail = 0;
+	m_nOffset = 0;
+	m_nPushedFrames = 0;
+	m_nReadFrames = 0;
+	m_nSampleRate = 0;
+	m_nDropped = 0;
+	m_nUnderruns = 0;
+	m_nSkippedFrames = 0;
+	m_nLastArrivalUs = 0;
+	m_fLastChunkUs = 0.0f;
+	m_fJitterUs = 0.0f;
+	m_bPrimed = false;
+	m_fLevelUs = 0.0f;
+	m_nJitterUs = 0;
+	m_nTargetUs = 0;
+	MediaAtomicStoreFloat(&m_nRateAdjust, 0.0f);
+	m_resampler.SetRateAdjust(0.0);
+	m_resampler.Reset();
+}
+
+unsigned long long CRawDataAudioRing::GetBufferedFrames() const
+{
+	LONGLONG read = MediaAtomicLoad64(&m_nReadFrames);
+	LONGLONG pushed = MediaAtomicLoad64(&m_nPushedFrames);
+	return pushed > read ? (unsigned long long)(pushed - read) : 0;
+}
+
+bool CRawDataAudioRing::Push(AudioRawData* data, long long nowUs)
+{
+	if (NULL == data)
+		return false;
+	unsigned int channels = data->GetChannelNum();
+	unsigned int bytes = data->GetBufferLen();
+	unsigned int sampleRate = data->GetSampleRate();
+	if (NULL == data->GetBuffer() || 0 == channels || 0 == sampleRate || bytes < channels * sizeof(short))
+		return false;
+
+	//interarrival jitter as in RFC 3550: how far each gap between chunks is from the last chunk's duration
+	if (0 != m_nLastArrivalUs && nowUs - m_nLastArrivalUs < JITTER_GAP_US)
+	{
+		float deviation = (float)(nowUs - m_nLastArrivalUs) - m_fLastChunkUs;
+		m_fJitterUs += ((deviation < 0.0f ? -deviation : deviation) - m_fJitterUs) / 16.0f;
+		MediaAtomicStore(&m_nJitterUs, (LONG)m_fJitterUs);
+	}
+	m_nLastArrivalUs = nowUs;
+	m_fLastChunkUs = bytes / (channels * sizeof(short)) * 1000000.0f / sampleRate;
+
+	ULONG head = (ULONG)m_nHead;
+	ULONG tail = (ULONG)MediaAtomicLoad(&m_nTail);
+	if (head - tail >= AUDIO_RING_CHUNKS)
+	{
+		MediaAtomicIncrement64(&m_nDropped);
+		return false;
+	}
+
+	//the consumer released the slot's reference before it moved the tail past it
+	RawDataAudioChunk& chunk = m_chunks[head & (AUDIO_RING_CHUNKS - 1)];
+	if (data->CanAddRef() && data->AddRef())
+	{
+		chunk.pRef = data;
+		chunk.pSamples = (const short*)data->GetBuffer();
+	}
+	else
+	{
+		if (!chunk.copy.Resize(bytes))
+		{
+			MediaAtomicIncrement64(&m_nDropped);
+			return false;
+		}
+		memcpy(chunk.copy.GetData(), data->GetBuffer(), bytes);
+		chunk.pSamples = (const short*)chunk.copy.GetData();
+	}
+	chunk.channels = channels;
+	chunk.frames = bytes / (channels * sizeof(short));
+	chunk.sampleRate = sampleRate;
+
+	MediaAtomicStore(&m_nSampleRate, (LONG)chunk.sampleRate);
+	MediaAtomicStore64(&m_nPushedFrames, m_nPushedFrames + chunk.frames);
+	MediaAtomicStore(&m_nHead, (LONG)(head + 1));
+	return true;
+}
+
+void CRawDataAudioRing::PopChunk()
+{
+	ULONG tail = (ULONG)m_nTail;
+	ReleaseChunk(m_chunks[tail & (AUDIO_RING_CHUNKS - 1)]);
+	m_nOffset = 0;
+	MediaAtomicStore(&m_nTail, (LONG)(tail + 1));
+}
+
+void CRawDataAudioRing::SkipFrames(ULONG head, long long maxLatencyUs)
+{
+	unsigned int sampleRate = GetSampleRate();
+	LONGLONG readFrames = m_nReadFrames;
+	LONGLONG maxFrames = maxLatencyUs * sampleRate / 1000000;
+	LONGLONG buffered = MediaAtomicLoad64(&m_nPushedFrames) - readFrames;
+	if (0 == sampleRate || buffered <= maxFrames)
+		return;
+
+	//back to half the limit, so the trim does not repeat on every call
+	LONGLONG skip = buffered - maxFrames / 2;
+	while (skip > 0 && (ULONG)m_nTail != head)
+	{
+		RawDataAudioChunk& chunk = m_chunks[(ULONG)m_nTail & (AUDIO_RING_CHUNKS - 1)];
+		unsigned int remaining = chunk.frames - m_nOffset;
+		if ((LONGLONG)remaining > skip)
+		{
+			m_nOffset += (unsigned int)skip;
+			readFrames += skip;
+			MediaAtomicStore64(&m_nSkippedFrames, m_nSkippedFrames + skip);
+			break;
+		}
+		readFrames += remaining;
+		skip -= remaining;
+		MediaAtomicStore64(&m_nSkippedFrames, m_nSkippedFrames + remaining);
+		PopChunk();
+	}
+	MediaAtomicStore64(&m_nReadFrames, readFrames);
+}
+
+unsigned int CRawDataAudioRing::PullInput(ULONG head, unsigned int frames)
+{
+	const float scale = 1.0f / 32768.0f;
+	float* pLeft = m_resampler.GetInput(0);
+	float* pRight = m_resampler.GetChannels() > 1 ? m_resampler.GetInput(1) : NULL;
+	unsigned int done = 0;
+	while (done < frames && (ULONG)m_nTail != head)
+	{
+		RawDataAudioChunk& chunk = m_chunks[(ULONG)m_nTail & (AUDIO_RING_CHUNKS - 1)];
+		unsigned int n = chunk.frames - m_nOffset;
+		if (n > frames - done)
+			n = frames - done;
+		unsigned int channels = chunk.channels;
+		const short* pSrc = chunk.pSamples + (size_t)m_nOffset * channels;
+		if (pRight)
+		{
+			unsigned int second = channels > 1 ? 1 : 0;
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				pLeft[done + i] = pSrc[(size_t)i * channels] * scale;
+				pRight[done + i] = pSrc[(size_t)i * channels + second] * scale;
+			}
+		}
+		else if (1 == channels)
+		{
+			for (unsigned int i = 0; i < n; ++i)
+				pLeft[done + i] = pSrc[i] * scale;
+		}
+		else
+		{
+			float channelScale = scale / channels;
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				int sum = 0;
+				for (unsigned int c = 0; c < channels; ++c)
+					sum += pSrc[(size_t)i * channels + c];
+				pLeft[done + i] = sum * channelScale;
+			}
+		}
+		done += n;
+		m_nOffset += n;
+		if (m_nOffset >= chunk.frames)
+			PopChunk();
+	}
+
+	if (done < frames)
+	{
+		memset(pLeft + done, 0, (frames - done) * sizeof(float));
+		if (pRight)
+			memset(pRight + done, 0, (frames - done) * sizeof(float));
+	}
+	return done;
+}
+
+unsigned int CRawDataAudioRing::Read(float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long maxLatencyUs)
+{
+	if (NULL == pOut || 0 == frames || 0 == channels)
+		return 0;
+
+	ULONG head = (ULONG)MediaAtomicLoad(&m_nHead);
+	if (maxLatencyUs > 0)
+		SkipFrames(head, maxLatencyUs);
+
+	//follows the rate of the chunk about to be read, the resampler starts over when it changes
+	unsigned int inRate = (ULONG)m_nTail != head ? m_chunks[(ULONG)m_nTail & (AUDIO_RING_CHUNKS - 1)].sampleRate : m_resampler.GetInputRate();
+	if (0 == inRate)
+	{
+		memset(pOut, 0, (size_t)frames * channels * sizeof(float));
+		return 0;
+	}
+	unsigned int outChannels = channels > 1 ? 2 : 1;
+	if (!m_resampler.Configure(inRate, 0 == sampleRate ? inRate : sampleRate, outChannels))
+		m_resampler.Configure(inRate, inRate, outChannels);
+
+	//jitter buffer: wait for the target level, then steer towards it
+	long long targetUs = JITTER_MIN_TARGET_US + JITTER_TARGET_FACTOR * (long long)MediaAtomicLoad(&m_nJitterUs);
+	if (maxLatencyUs > 0 && targetUs > maxLatencyUs / 2)
+		targetUs = maxLatencyUs / 2;
+	if (targetUs > JITTER_MAX_TARGET_US)
+		targetUs = JITTER_MAX_TARGET_US;
+	MediaAtomicStore(&m_nTargetUs, (LONG)targetUs);
+	float levelUs = (float)((MediaAtomicLoad64(&m_nPushedFrames) - m_nReadFrames) * 1000000.0 / inRate);
+	if (!m_bPrimed)
+	{
+		if (levelUs < targetUs)
+		{
+			memset(pOut, 0, (size_t)frames * channels * sizeof(float));
+			return 0;
+		}
+		m_bPrimed = true;
+		m_fLevelUs = levelUs;
+	}
+	float readUs = frames * 1000000.0f / (0 == sampleRate ? inRate : sampleRate);
+	m_fLevelUs += (levelUs - m_fLevelUs) * (readUs < DRIFT_LEVEL_TAU_US ? readUs / DRIFT_LEVEL_TAU_US : 1.0f);
+	float adjust = (m_fLevelUs - targetUs) / targetUs * DRIFT_GAIN;
+	adjust = adjust < -DRIFT_MAX_ADJUST ? -DRIFT_MAX_ADJUST : (adjust > DRIFT_MAX_ADJUST ? DRIFT_MAX_ADJUST : adjust);
+	m_resampler.SetRateAdjust(adjust);
+	MediaAtomicStoreFloat(&m_nRateAdjust, adjust);
+
+	unsigned int audio = 0;
+	LONGLONG pulled = 0;
+	for (unsigned int done = 0; done < frames;)
+	{
+		unsigned int count = frames - done < RESAMPLER_BLOCK ? frames - done : RESAMPLER_BLOCK;
+		unsigned int need = m_resampler.GetInputFrames(count);
+		unsigned int real = PullInput(head, need);
+		m_resampler.Process(need, pOut + (size_t)done * channels, count, channels);
+		pulled += real;
+		audio += real >= need ? count : (unsigned int)((unsigned long long)real * count / need);
+		done += count;
+	}
+	if (channels > 2)
+	{
+		for (unsigned int i = 0; i < frames; ++i)
+			memset(pOut + (size_t)i * channels + 2, 0, (channels - 2) * sizeof(float));
+	}
+	MediaAtomicStore64(&m_nReadFrames, m_nReadFrames + pulled);
+
+	//ran dry, wait for the target level again rather than stutter
+	if (audio < frames)
+	{
+		MediaAtomicIncrement64(&m_nUnderruns);
+		m_bPrimed = false;
+	}
+	return audio;
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataAudioRingManager& CRawDataAudioRingManager::GetInst()
+{
+	static CRawDataAudioRingManager inst;
+	return inst;
+}
+
+CRawDataAudioRingManager::CRawDataAudioRingManager()
+{
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS; ++i)
+	{
+		m_slots[i].bUsed = 0;
+		m_slots[i].nodeId = 0;
+		m_slots[i].state = 0;
+		m_slots[i].lastPushUs = 0;
+	}
+	m_nMaxLatencyMs = 200;
+}
+
+void CRawDataAudioRingManager::Reset()
+{
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS; ++i)
+	{
+		m_slots[i].ring.Clear();
+		m_slots[i].meter.Reset();
+		m_slots[i].viseme.Reset();
+		MediaAtomicStore(&m_slots[i].bUsed, 0);
+		MediaAtomicStore(&m_slots[i].state, 0);
+	}
+}
+
+CRawDataAudioRingManager::AudioRingSlot* CRawDataAudioRingManager::FindSlot(uint32_t nodeId)
+{
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS; ++i)
+	{
+		AudioRingSlot& slot = m_slots[i];
+		if (0 != MediaAtomicLoad(&slot.bUsed) && nodeId == (uint32_t)MediaAtomicLoad(&slot.nodeId))
+			return &slot;
+	}
+	return NULL;
+}
+
+CRawDataAudioRingManager::AudioRingSlot* CRawDataAudioRingManager::ClaimSlot(uint32_t nodeId)
+{
+	long long nowUs = MediaGetTimeUs();
+	AudioRingSlot* pOldest = NULL;
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS; ++i)
+	{
+		AudioRingSlot& slot = m_slots[i];
+		if (0 == MediaAtomicLoad(&slot.bUsed))
+		{
+			MediaAtomicStore(&slot.nodeId, (LONG)nodeId);
+			MediaAtomicStore64(&slot.lastPushUs, nowUs);
+			MediaAtomicStore(&slot.bUsed, 1);
+			return &slot;
+		}
+		if (NULL == pOldest || slot.lastPushUs < pOldest->lastPushUs)
+			pOldest = &slot;
+	}
+
+	if (NULL == pOldest || nowUs - pOldest->lastPushUs < AUDIO_RING_IDLE_US)
+		return NULL;
+	//a Read() inside keeps the slot, the next chunk of this speaker tries again
+	if (0 != MediaAtomicCompareExchange(&pOldest->state, AUDIO_SLOT_MOVING, 0))
+		return NULL;
+	pOldest->ring.Clear();
+	pOldest->meter.Reset();
+	pOldest->viseme.Reset();
+	MediaAtomicStore(&pOldest->nodeId, (LONG)nodeId);
+	MediaAtomicStore64(&pOldest->lastPushUs, nowUs);
+	MediaAtomicStore(&pOldest->state, 0);
+	return pOldest;
+}
+
+bool CRawDataAudioRingManager::EnterSlot(AudioRingSlot& slot, uint32_t nodeId)
+{
+	if (0 != MediaAtomicCompareExchange(&slot.state, AUDIO_SLOT_READING, 0))
+		return false;
+	//the slot may have changed hands between the lookup and the exchange
+	if (0 == MediaAtomicLoad(&slot.bUsed) || nodeId != (uint32_t)MediaAtomicLoad(&slot.nodeId))
+	{
+		MediaAtomicStore(&slot.state, 0);
+		return false;
+	}
+	return true;
+}
+
+void CRawDataAudioRingManager::LeaveSlot(AudioRingSlot& slot)
+{
+	MediaAtomicStore(&slot.state, 0);
+}
+
+unsigned int CRawDataAudioRingManager::Read(uint32_t nodeId, float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate)
+{
+	AudioRingSlot* pSlot = FindSlot(nodeId);
+	if (NULL == pSlot || !EnterSlot(*pSlot, nodeId))
+	{
+		if (pOut)
+			memset(pOut, 0, (size_t)frames * channels * sizeof(float));
+		return 0;
+	}
+	unsigned int read = pSlot->ring.Read(pOut, frames, channels, sampleRate, (long long)MediaAtomicLoad(&m_nMaxLatencyMs) * 1000);
+	LeaveSlot(*pSlot);
+	return read;
+}
+
+unsigned int CRawDataAudioRingManager::GetSampleRate(uint32_t nodeId)
+{
+	AudioRingSlot* pSlot = FindSlot(nodeId);
+	return pSlot ? pSlot->ring.GetSampleRate() : 0;
+}
+
+const CRawDataAudioRing* CRawDataAudioRingManager::GetRing(uint32_t nodeId)
+{
+	AudioRingSlot* pSlot = FindSlot(nodeId);
+	return pSlot ? &pSlot->ring : NULL;
+}
+
+unsigned int CRawDataAudioRingManager::GetSpeakers(uint32_t* pNodeIds, unsigned int maxCount)
+{
+	if (NULL == pNodeIds)
+		return 0;
+	long long nowUs = MediaGetTimeUs();
+	unsigned int count = 0;
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS && count < maxCount; ++i)
+	{
+		AudioRingSlot& slot = m_slots[i];
+		if (0 != MediaAtomicLoad(&slot.bUsed) && nowUs - MediaAtomicLoad64(&slot.lastPushUs) < AUDIO_RING_ACTIVE_US)
+			pNodeIds[count++] = (uint32_t)MediaAtomicLoad(&slot.nodeId);
+	}
+	return count;
+}
+
+unsigned int CRawDataAudioRingManager::GetLevels(RawDataAudioLevel* pLevels, unsigned int maxCount)
+{
+	if (NULL == pLevels)
+		return 0;
+	long long nowUs = MediaGetTimeUs();
+	unsigned int count = 0;
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS && count < maxCount; ++i)
+	{
+		AudioRingSlot& slot = m_slots[i];
+		if (0 == MediaAtomicLoad(&slot.bUsed) || nowUs - MediaAtomicLoad64(&slot.lastPushUs) >= AUDIO_RING_ACTIVE_US)
+			continue;
+		RawDataAudioLevel& level = pLevels[count++];
+		level.nodeId = (uint32_t)MediaAtomicLoad(&slot.nodeId);
+		slot.meter.GetLevel(level, nowUs);
+	}
+	return count;
+}
+
+unsigned int CRawDataAudioRingManager::GetVisemes(uint32_t* pNodeIds, float* pWeights, unsigned int maxCount)
+{
+	if (NULL == pNodeIds || NULL == pWeights)
+		return 0;
+	long long nowUs = MediaGetTimeUs();
+	unsigned int count = 0;
+	for (int i = 0; i < AUDIO_RING_MAX_SPEAKERS && count < maxCount; ++i)
+	{
+		AudioRingSlot& slot = m_slots[i];
+		if (0 == MediaAtomicLoad(&slot.bUsed) || nowUs - MediaAtomicLoad64(&slot.lastPushUs) >= AUDIO_RING_ACTIVE_US)
+			continue;
+		pNodeIds[count] = (uint32_t)MediaAtomicLoad(&slot.nodeId);
+		slot.viseme.GetWeights(pWeights + (size_t)count * RawDataViseme_Count, nowUs);
+		++count;
+	}
+	return count;
+}
+
+void CRawDataAudioRingManager::onMixedAudioRawDataReceived(AudioRawData* data_)
+{
+	//the mix has every speaker in one place, the rings are for placing them apart
+	CRawDataAudioRecorder::GetInst().WriteMixed(data_);
+	CRawDataFixtureWriter::GetInst().WriteMixedAudio(data_);
+}
+
+void CRawDataAudioRingManager::onOneWayAudioRawDataReceived(AudioRawData* data_, uint32_t node_id)
+{
+	if (NULL == data_)
+		return;
+	CRawDataAudioRecorder::GetInst().WriteOneWay(node_id, data_);
+	CRawDataFixtureWriter::GetInst().WriteOneWayAudio(node_id, data_);
+	AudioRingSlot* pSlot = FindSlot(node_id);
+	if (NULL == pSlot)
+		pSlot = ClaimSlot(node_id);
+	if (NULL == pSlot)
+		return;
+	long long nowUs = MediaGetTimeUs();
+	MediaAtomicStore64(&pSlot->lastPushUs, nowUs);
+	unsigned int channels = data_->GetChannelNum();
+	if (data_->GetBuffer() && channels > 0)
+	{
+		const short* pSamples = (const short*)data_->GetBuffer();
+		unsigned int frames = data_->GetBufferLen() / (channels * sizeof(short));
+		pSlot->meter.Process(pSamples, frames, channels, data_->GetSampleRate(), nowUs);
+		pSlot->viseme.Process(pSamples, frames, channels, data_->GetSampleRate(), nowUs);
+	}
+	pSlot->ring.Push(data_, nowUs);
+}
+END_ZOOM_SDK_NAMESPACE
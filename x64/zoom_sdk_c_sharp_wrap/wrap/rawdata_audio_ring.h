@@ -0,0 +1,163 @@
+#pragma once
+#include "rawdata_audio_resampler.h"
+#include "rawdata_audio_meter.h"
+#include "rawdata_audio_viseme.h"
+#include "rawdata_audio_recorder.h"
+#include "zoom_sdk_def.h"
+#include "zoom_sdk_raw_data_def.h"
+#include "rawdata/rawdata_audio_helper_interface.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+#define AUDIO_RING_CHUNKS 64
+#define AUDIO_RING_MAX_SPEAKERS 64
+
+//One block of 16 bit PCM as the sdk delivered it, either the sdk's buffer kept alive with AddRef() or a copy.
+typedef struct tagRawDataAudioChunk
+{
+	AudioRawData* pRef;
+	CMediaBuffer copy;
+	const short* pSamples;
+	unsigned int frames;///<Samples per channel.
+	unsigned int channels;
+	unsigned int sampleRate;
+}RawDataAudioChunk;
+
+//Single-producer/single-consumer ring of PCM chunks for one speaker. The producer is the sdk audio thread calling
+//Push(), which only hands the chunk over and never waits. The consumer is one other thread, typically Unity's audio
+//thread, reading a fixed number of samples per call with Read(), which neither locks nor allocates.
+//The ring is also the speaker's jitter buffer. Push() measures how irregularly chunks arrive, Read() starts playing
+//once a few times that jitter is buffered and starts over the same way after running dry. In between, the fill
+//level is kept at that target by playing up to 0.5% faster or slower through the resampler, which absorbs the
+//drift between the sdk's clock and the audio device's without audible clicks.
+class CRawDataAudioRing
+{
+public:
+	CRawDataAudioRing();
+	~CRawDataAudioRing();
+
+	//producer side, nowUs is the arrival time. Returns false when the ring is full and the chunk was dropped.
+	bool Push(AudioRawData* data, long long nowUs);
+
+	//consumer side. Fills frames of samples in -1 to 1, interleaved with channels per frame, converted to
+	//sampleRate (0 keeps the speaker's). One channel averages the speaker's, more get its first two, or the mono
+	//speaker on both, and the channels past the second are silent. Returns the frames that came from the ring, the
+	//rest is silence. When more than maxLatencyUs is buffered, the oldest chunks are skipped until half of it is
+	//left, 0 keeps everything.
+	unsigned int Read(float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long maxLatencyUs);
+	//sample rate of the newest chunk, 0 before the first one
+	unsigned int GetSampleRate() const { return (unsigned int)MediaAtomicLoad(&m_nSampleRate); }
+	//samples per channel pushed and not read yet
+	unsigned long long GetBufferedFrames() const;
+
+	//releases every chunk. Neither side may run meanwhile.
+	void Clear();
+
+	unsigned long long GetDroppedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nDropped); }
+	//Read() calls that ran dry while playing
+	unsigned long long GetUnderrunCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nUnderruns); }
+	//samples per channel skipped to keep the latency down
+	unsigned long long GetSkippedFrames() const { return (unsigned long long)MediaAtomicLoad64(&m_nSkippedFrames); }
+	//smoothed deviation of chunk arrivals from their durations, in microseconds
+	long long GetJitterUs() const { return (long long)MediaAtomicLoad(&m_nJitterUs); }
+	//buffer level Read() steers towards, in microseconds
+	long long GetTargetUs() const { return (long long)MediaAtomicLoad(&m_nTargetUs); }
+	//how much faster than the speaker's rate it plays right now, e.g. 0.001 for 0.1%
+	float GetRateAdjust() const { return MediaAtomicLoadFloat(&m_nRateAdjust); }
+
+private:
+	CRawDataAudioRing(const CRawDataAudioRing&);
+	CRawDataAudioRing& operator=(const CRawDataAudioRing&);
+	void ReleaseChunk(RawDataAudioChunk& chunk);
+	void PopChunk();
+	void SkipFrames(ULONG head, long long maxLatencyUs);
+	unsigned int PullInput(ULONG head, unsigned int frames);
+
+	RawDataAudioChunk m_chunks[AUDIO_RING_CHUNKS];
+
+	//producer owned
+	char m_padProducer[64];
+	volatile LONG m_nHead;
+	volatile LONGLONG m_nPushedFrames;
+	long long m_nLastArrivalUs;
+	float m_fLastChunkUs;///<Duration of the last chunk pushed.
+	float m_fJitterUs;
+
+	//consumer owned
+	char m_padConsumer[64];
+	volatile LONG m_nTail;
+	unsigned int m_nOffset;///<Samples per channel already read from the chunk at the tail.
+	volatile LONGLONG m_nReadFrames;
+	CRawDataAudioResampler m_resampler;
+	bool m_bPrimed;///<Playing, as opposed to waiting for the target level.
+	float m_fLevelUs;///<Smoothed buffer level.
+
+	//shared between both sides
+	char m_padShared[64];
+	volatile LONG m_nSampleRate;
+	volatile LONGLONG m_nDropped;
+	volatile LONGLONG m_nUnderruns;
+	volatile LONGLONG m_nSkippedFrames;
+	volatile LONG m_nJitterUs;
+	volatile LONG m_nTargetUs;
+	volatile LONG m_nRateAdjust;
+};
+
+//Splits onOneWayAudioRawDataReceived() into one CRawDataAudioRing per node_id, so the engine can play every
+//speaker from its own position. Subscribe it with IZoomSDKAudioRawDataHelperWrap::subscribe(), the sdk then calls
+//it straight from its audio thread.
+//Speakers get one of AUDIO_RING_MAX_SPEAKERS slots on their first audio. With every slot taken, the one silent for
+//longest is handed over once it has been silent for a while, so the table follows whoever speaks. Readers never
+//see a slot change hands under them: the sdk thread only takes a slot over while no Read() is inside it.
+//Both callbacks also hand their audio to CRawDataAudioRecorder and CRawDataFixtureWriter::GetInst(), which keep
+//it only while recording.
+class CRawDataAudioRingManager : public IZoomSDKAudioRawDataDelegate
+{
+public:
+	static CRawDataAudioRingManager& GetInst();
+
+	//see CRawDataAudioRing::Read(), 0 keeps everything
+	void SetMaxLatency(unsigned int ms) { MediaAtomicStore(&m_nMaxLatencyMs, (LONG)ms); }
+	//forgets every speaker, only while unsubscribed
+	void Reset();
+
+	//one consumer thread for all speakers, see CRawDataAudioRing::Read(). Returns the frames that were audio, 0 for
+	//an unknown speaker.
+	unsigned int Read(uint32_t nodeId, float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate);
+	unsigned int GetSampleRate(uint32_t nodeId);
+	//node ids that sent audio within the last second, any thread. Returns how many were written.
+	unsigned int GetSpeakers(uint32_t* pNodeIds, unsigned int maxCount);
+	//levels of the same speakers, any thread
+	unsigned int GetLevels(RawDataAudioLevel* pLevels, unsigned int maxCount);
+	//lip sync of the same speakers, any thread. pWeights gets RawDataViseme_Count weights per speaker.
+	unsigned int GetVisemes(uint32_t* pNodeIds, float* pWeights, unsigned int maxCount);
+	//the ring of a speaker for statistics, NULL for an unknown one. The slot may change hands later.
+	const CRawDataAudioRing* GetRing(uint32_t nodeId);
+
+	virtual void onMixedAudioRawDataReceived(AudioRawData* data_);
+	virtual void onOneWayAudioRawDataReceived(AudioRawData* data_, uint32_t node_id);
+
+private:
+	CRawDataAudioRingManager();
+	CRawDataAudioRingManager(const CRawDataAudioRingManager&);
+	CRawDataAudioRingManager& operator=(const CRawDataAudioRingManager&);
+
+	typedef struct tagAudioRingSlot
+	{
+		volatile LONG bUsed;
+		volatile LONG nodeId;
+		volatile LONG state;///<AUDIO_SLOT_READING while a Read() is inside, AUDIO_SLOT_MOVING while it changes hands.
+		volatile LONGLONG lastPushUs;
+		CRawDataAudioRing ring;
+		CRawDataAudioMeter meter;
+		CRawDataVisemeAnalyzer viseme;
+	}AudioRingSlot;
+
+	AudioRingSlot* FindSlot(uint32_t nodeId);
+	AudioRingSlot* ClaimSlot(uint32_t nodeId);
+	bool EnterSlot(AudioRingSlot& slot, uint32_t nodeId);
+	void LeaveSlot(AudioRingSlot& slot);
+
+	AudioRingSlot m_slots[AUDIO_RING_MAX_SPEAKERS];
+	volatile LONG m_nMaxLatencyMs;
+};
+END_ZOOM_SDK_NAMESPACE
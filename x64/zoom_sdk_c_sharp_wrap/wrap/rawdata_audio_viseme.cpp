@@ -0,0 +1,312 @@
+#include "rawdata_audio_viseme.h"
+#include <xmmintrin.h>
+#include <math.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+#define VISEME_COMPLEX_SIZE (VISEME_FFT_SIZE / 2)
+//a speaker with no audio for this long reads as silent
+#define VISEME_STALE_US 200000
+//quieter windows are silence, the mouth is fully open this far above it
+#define VISEME_MIN_DB -50.0f
+#define VISEME_OPEN_DB 30.0f
+//hiss above this frequency makes SS
+#define VISEME_SIBILANT_HZ 4000.0f
+//where the first and the second formant are looked for
+#define VISEME_F1_MIN_HZ 200.0f
+#define VISEME_F1_MAX_HZ 1000.0f
+#define VISEME_F2_MIN_HZ 850.0f
+#define VISEME_F2_MAX_HZ 3000.0f
+//how far from a vowel's formants, as a share of the frequency, the vowel has faded to about 60%
+#define VISEME_F1_SPREAD 0.25f
+#define VISEME_F2_SPREAD 0.2f
+#define VISEME_ATTACK_MS 20.0f
+#define VISEME_RELEASE_MS 60.0f
+
+typedef struct tagVisemeVowel
+{
+	RawDataViseme viseme;
+	float f1;
+	float f2;
+}VisemeVowel;
+
+//typical formants of an adult voice
+static const VisemeVowel s_vowels[] =
+{
+	{ RawDataViseme_AA, 750.0f, 1200.0f },
+	{ RawDataViseme_E, 550.0f, 1850.0f },
+	{ RawDataViseme_I, 300.0f, 2300.0f },
+	{ RawDataViseme_O, 500.0f, 900.0f },
+	{ RawDataViseme_U, 320.0f, 850.0f },
+};
+
+//bit reversal, twiddles of every radix-2 stage one after the other, the split's twiddles and the Hann window
+typedef struct tagVisemeFFTTables
+{
+	unsigned char bitReverse[VISEME_COMPLEX_SIZE];
+	float stageRe[VISEME_COMPLEX_SIZE];
+	float stageIm[VISEME_COMPLEX_SIZE];
+	float splitRe[VISEME_COMPLEX_SIZE + 1];
+	float splitIm[VISEME_COMPLEX_SIZE + 1];
+	float window[VISEME_FFT_SIZE];
+}VisemeFFTTables;
+
+static VisemeFFTTables* BuildTables()
+{
+	static VisemeFFTTables tables;
+	const double pi = 3.14159265358979323846;
+	for (unsigned int i = 0; i < VISEME_COMPLEX_SIZE; ++i)
+	{
+		unsigned int reversed = 0;
+		for (unsigned int bit = 1, mirror = VISEME_COMPLEX_SIZE >> 1; bit < VISEME_COMPLEX_SIZE; bit <<= 1, mirror >>= 1)
+		{
+			if (i & bit)
+				reversed |= mirror;
+		}
+		tables.bitReverse[i] = (unsigned char)reversed;
+	}
+	//the stage with half length h starts at h - 1
+	for (unsigned int half = 1; half < VISEME_COMPLEX_SIZE; half <<= 1)
+	{
+		for (unsigned int j = 0; j < half; ++j)
+		{
+			tables.stageRe[half - 1 + j] = (float)cos(-pi * j / half);
+			tables.stageIm[half - 1 + j] = (float)sin(-pi * j / half);
+		}
+	}
+	for (unsigned int k = 0; k <= VISEME_COMPLEX_SIZE; ++k)
+	{
+		tables.splitRe[k] = (float)cos(-2.0 * pi * k / VISEME_FFT_SIZE);
+		tables.splitIm[k] = (float)sin(-2.0 * pi * k / VISEME_FFT_SIZE);
+	}
+	for (unsigned int i = 0; i < VISEME_FFT_SIZE; ++i)
+		tables.window[i] = (float)(0.5 - 0.5 * cos(2.0 * pi * i / VISEME_FFT_SIZE));
+	return &tables;
+}
+
+static const VisemeFFTTables& GetTables()
+{
+	static const VisemeFFTTables* pTables = BuildTables();
+	return *pTables;
+}
+
+//in place radix-2 FFT of VISEME_COMPLEX_SIZE points, the input already in bit reversed order
+static void FFT(float* pRe, float* pIm, const VisemeFFTTables& tables)
+{
+	//the first two stages have fewer than 4 butterflies per group
+	for (unsigned int a = 0; a < VISEME_COMPLEX_SIZE; a += 2)
+	{
+		float tr = pRe[a + 1];
+		float ti = pIm[a + 1];
+		pRe[a + 1] = pRe[a] - tr;
+		pIm[a + 1] = pIm[a] - ti;
+		pRe[a] += tr;
+		pIm[a] += ti;
+	}
+	for (unsigned int a = 0; a < VISEME_COMPLEX_SIZE; a += 4)
+	{
+		float tr = pRe[a + 2];
+		float ti = pIm[a + 2];
+		pRe[a + 2] = pRe[a] - tr;
+		pIm[a + 2] = pIm[a] - ti;
+		pRe[a] += tr;
+		pIm[a] += ti;
+		//twiddle -i
+		tr = pIm[a + 3];
+		ti = -pRe[a + 3];
+		pRe[a + 3] = pRe[a + 1] - tr;
+		pIm[a + 3] = pIm[a + 1] - ti;
+		pRe[a + 1] += tr;
+		pIm[a + 1] += ti;
+	}
+	for (unsigned int half = 4; half < VISEME_COMPLEX_SIZE; half <<= 1)
+	{
+		const float* pWr = tables.stageRe + half - 1;
+		const float* pWi = tables.stageIm + half - 1;
+		for (unsigned int start = 0; start < VISEME_COMPLEX_SIZE; start += half * 2)
+		{
+			for (unsigned int j = 0; j < half; j += 4)
+			{
+				unsigned int a = start + j;
+				unsigned int b = a + half;
+				__m128 wr = _mm_loadu_ps(pWr + j);
+				__m128 wi = _mm_loadu_ps(pWi + j);
+				__m128 xr = _mm_loadu_ps(pRe + b);
+				__m128 xi = _mm_loadu_ps(pIm + b);
+				__m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+				__m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+				__m128 ur = _mm_loadu_ps(pRe + a);
+				__m128 ui = _mm_loadu_ps(pIm + a);
+				_mm_storeu_ps(pRe + a, _mm_add_ps(ur, tr));
+				_mm_storeu_ps(pIm + a, _mm_add_ps(ui, ti));
+				_mm_storeu_ps(pRe + b, _mm_sub_ps(ur, tr));
+				_mm_storeu_ps(pIm + b, _mm_sub_ps(ui, ti));
+			}
+		}
+	}
+}
+
+//power weighted mean frequency of bins [first, last], squared so the formant peak outweighs the slopes around it
+static float FindPeakHz(const float* pPower, unsigned int first, unsigned int last, float binHz)
+{
+	double sum = 0.0;
+	double weighted = 0.0;
+	for (unsigned int k = first; k <= last; ++k)
+	{
+		double p = (double)pPower[k] * pPower[k];
+		sum += p;
+		weighted += p * k;
+	}
+	return sum > 0.0 ? (float)(weighted / sum) * binHz : 0.0f;
+}
+
+CRawDataVisemeAnalyzer::CRawDataVisemeAnalyzer()
+{
+	GetTables();
+	Reset();
+}
+
+void CRawDataVisemeAnalyzer::Reset()
+{
+	memset(m_window, 0, sizeof(m_window));
+	memset(m_weights, 0, sizeof(m_weights));
+	m_weights[RawDataViseme_Silence] = 1.0f;
+	m_nSampleRate = 0;
+	MediaAtomicStore(&m_nVersion, 0);
+	for (int i = 0; i < RawDataViseme_Count; ++i)
+		MediaAtomicStoreFloat(&m_nWeights[i], m_weights[i]);
+	MediaAtomicStore64(&m_nUpdateUs, 0);
+}
+
+void CRawDataVisemeAnalyzer::Process(const short* pSamples, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long nowUs)
+{
+	if (NULL == pSamples || 0 == frames || 0 == channels || 0 == sampleRate)
+		return;
+	if (sampleRate != m_nSampleRate)
+	{
+		memset(m_window, 0, sizeof(m_window));
+		m_nSampleRate = sampleRate;
+	}
+
+	//slide the window on by the chunk, mixed down to mono
+	unsigned int count = frames < VISEME_FFT_SIZE ? frames : VISEME_FFT_SIZE;
+	const short* pSrc = pSamples + (size_t)(frames - count) * channels;
+	memmove(m_window, m_window + count, (VISEME_FFT_SIZE - count) * sizeof(float));
+	float* pDst = m_window + VISEME_FFT_SIZE - count;
+	float scale = 1.0f / (32768.0f * channels);
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		int sum = 0;
+		for (unsigned int c = 0; c < channels; ++c)
+			sum += pSrc[(size_t)i * channels + c];
+		pDst[i] = sum * scale;
+	}
+
+	Analyze(sampleRate, frames * 1000.0f / sampleRate);
+
+	MediaAtomicIncrement(&m_nVersion);
+	for (int i = 0; i < RawDataViseme_Count; ++i)
+		MediaAtomicStoreFloat(&m_nWeights[i], m_weights[i]);
+	MediaAtomicIncrement(&m_nVersion);
+	MediaAtomicStore64(&m_nUpdateUs, nowUs);
+}
+
+void CRawDataVisemeAnalyzer::Analyze(unsigned int sampleRate, float chunkMs)
+{
+	const VisemeFFTTables& tables = GetTables();
+	//the even samples are the real parts and the odd ones the imaginary parts of a half size complex FFT
+	for (unsigned int i = 0; i < VISEME_COMPLEX_SIZE; ++i)
+	{
+		unsigned int r = tables.bitReverse[i];
+		m_re[r] = m_window[i * 2] * tables.window[i * 2];
+		m_im[r] = m_window[i * 2 + 1] * tables.window[i * 2 + 1];
+	}
+	FFT(m_re, m_im, tables);
+
+	//split the two interleaved spectra and combine them into the spectrum of the real window
+	double total = 0.0;
+	for (unsigned int k = 0; k <= VISEME_COMPLEX_SIZE; ++k)
+	{
+		unsigned int a = k & (VISEME_COMPLEX_SIZE - 1);
+		unsigned int b = (VISEME_COMPLEX_SIZE - k) & (VISEME_COMPLEX_SIZE - 1);
+		float evenRe = 0.5f * (m_re[a] + m_re[b]);
+		float evenIm = 0.5f * (m_im[a] - m_im[b]);
+		float oddRe = 0.5f * (m_im[a] + m_im[b]);
+		float oddIm = -0.5f * (m_re[a] - m_re[b]);
+		float re = evenRe + oddRe * tables.splitRe[k] - oddIm * tables.splitIm[k];
+		float im = evenIm + oddRe * tables.splitIm[k] + oddIm * tables.splitRe[k];
+		m_power[k] = re * re + im * im;
+		total += m_power[k];
+	}
+
+	float target[RawDataViseme_Count];
+	memset(target, 0, sizeof(target));
+	//the Hann window keeps 3/8 of the power, Parseval gives the mean square of the window from the spectrum
+	double meanSquare = 2.0 * total / ((double)VISEME_FFT_SIZE * VISEME_FFT_SIZE * 0.375);
+	float db = 10.0f * log10f((float)meanSquare + 1e-10f);
+	float open = (db - VISEME_MIN_DB) / VISEME_OPEN_DB;
+	open = open < 0.0f ? 0.0f : (open > 1.0f ? 1.0f : open);
+	if (open > 0.0f)
+	{
+		float binHz = (float)sampleRate / VISEME_FFT_SIZE;
+		unsigned int sibilant = (unsigned int)(VISEME_SIBILANT_HZ / binHz);
+		double hiss = 0.0;
+		for (unsigned int k = sibilant; k <= VISEME_COMPLEX_SIZE; ++k)
+			hiss += m_power[k];
+		float hissShare = sibilant <= VISEME_COMPLEX_SIZE ? (float)(hiss / total) : 0.0f;
+		target[RawDataViseme_SS] = open * hissShare;
+
+		float f1 = FindPeakHz(m_power, (unsigned int)(VISEME_F1_MIN_HZ / binHz), (unsigned int)(VISEME_F1_MAX_HZ / binHz), binHz);
+		float f2 = FindPeakHz(m_power, (unsigned int)(VISEME_F2_MIN_HZ / binHz), (unsigned int)(VISEME_F2_MAX_HZ / binHz), binHz);
+		float closeness[sizeof(s_vowels) / sizeof(s_vowels[0])];
+		float sum = 0.0f;
+		for (unsigned int v = 0; v < sizeof(s_vowels) / sizeof(s_vowels[0]); ++v)
+		{
+			float d1 = logf(f1 / s_vowels[v].f1 + 1e-6f) / VISEME_F1_SPREAD;
+			float d2 = logf(f2 / s_vowels[v].f2 + 1e-6f) / VISEME_F2_SPREAD;
+			closeness[v] = expf(-0.5f * (d1 * d1 + d2 * d2));
+			sum += closeness[v];
+		}
+		float voiced = open * (1.0f - hissShare);
+		for (unsigned int v = 0; v < sizeof(s_vowels) / sizeof(s_vowels[0]); ++v)
+			target[s_vowels[v].viseme] = sum > 1e-6f ? voiced * closeness[v] / sum : 0.0f;
+	}
+
+	//mouth shapes come in fast and fade out a little slower, Silence takes up what is left
+	float attack = 1.0f - expf(-chunkMs / VISEME_ATTACK_MS);
+	float release = 1.0f - expf(-chunkMs / VISEME_RELEASE_MS);
+	float shapes = 0.0f;
+	for (int i = RawDataViseme_Silence + 1; i < RawDataViseme_Count; ++i)
+	{
+		m_weights[i] += (target[i] - m_weights[i]) * (target[i] > m_weights[i] ? attack : release);
+		shapes += m_weights[i];
+	}
+	if (shapes > 1.0f)
+	{
+		for (int i = RawDataViseme_Silence + 1; i < RawDataViseme_Count; ++i)
+			m_weights[i] /= shapes;
+		shapes = 1.0f;
+	}
+	m_weights[RawDataViseme_Silence] = 1.0f - shapes;
+}
+
+void CRawDataVisemeAnalyzer::GetWeights(float* pWeights, long long nowUs) const
+{
+	if (NULL == pWeights)
+		return;
+	if (nowUs - MediaAtomicLoad64(&m_nUpdateUs) <= VISEME_STALE_US)
+	{
+		//retry when Process() published in between, so the weights always belong together
+		for (int attempt = 0; attempt < 4; ++attempt)
+		{
+			LONG version = MediaAtomicLoad(&m_nVersion);
+			if (version & 1)
+				continue;
+			for (int i = 0; i < RawDataViseme_Count; ++i)
+				pWeights[i] = MediaAtomicLoadFloat(&m_nWeights[i]);
+			if (version == MediaAtomicLoad(&m_nVersion))
+				return;
+		}
+	}
+	memset(pWeights, 0, RawDataViseme_Count * sizeof(float));
+	pWeights[RawDataViseme_Silence] = 1.0f;
+}
+END_ZOOM_SDK_NAMESPACE
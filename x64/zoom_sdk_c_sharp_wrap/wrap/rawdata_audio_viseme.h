@@ -0,0 +1,54 @@
+#pragma once
+#include "rawdata_media_common.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//real samples per analysis window, about 11 ms at 48 kHz and 32 ms at 16 kHz
+#define VISEME_FFT_SIZE 512
+
+//Mouth shapes the weights are given for, in the order of the weights array. The engine blends the matching
+//blend shapes of the avatar by them.
+typedef enum
+{
+	RawDataViseme_Silence,///<Mouth at rest.
+	RawDataViseme_AA,///<Open, as in "father".
+	RawDataViseme_E,///<Half open and wide, as in "bed".
+	RawDataViseme_I,///<Nearly closed and wide, as in "see".
+	RawDataViseme_O,///<Half open and round, as in "go".
+	RawDataViseme_U,///<Nearly closed and round, as in "food".
+	RawDataViseme_SS,///<Teeth together, as in "see" and "she".
+	RawDataViseme_Count,
+}RawDataViseme;
+
+//Lip sync weights for one speaker, updated on every chunk the sdk delivers.
+//Each window is run through a real FFT (a 256 point complex SSE FFT and a split), and the spectrum is reduced to the
+//level, the share of hiss above 4 kHz and the first two formants. The formants pick the vowel by their distance to
+//the typical formants of each vowel, the hiss makes SS and the level opens the mouth, the rest is Silence. The
+//weights add up to 1 and are smoothed, opening fast and closing a little slower like a real mouth.
+//Process() runs on one thread, the sdk audio thread. GetWeights() may be called from any thread.
+class CRawDataVisemeAnalyzer
+{
+public:
+	CRawDataVisemeAnalyzer();
+
+	void Process(const short* pSamples, unsigned int frames, unsigned int channels, unsigned int sampleRate, long long nowUs);
+	//only while Process() cannot run
+	void Reset();
+	//writes RawDataViseme_Count weights, Silence only when no audio came for a while
+	void GetWeights(float* pWeights, long long nowUs) const;
+
+private:
+	void Analyze(unsigned int sampleRate, float chunkMs);
+
+	//owned by Process()
+	float m_window[VISEME_FFT_SIZE];///<Latest samples, mixed down to mono.
+	float m_re[VISEME_FFT_SIZE / 2];
+	float m_im[VISEME_FFT_SIZE / 2];
+	float m_power[VISEME_FFT_SIZE / 2 + 1];
+	float m_weights[RawDataViseme_Count];
+	unsigned int m_nSampleRate;
+
+	//published, m_nVersion is odd while the weights are being written
+	volatile LONG m_nVersion;
+	volatile LONG m_nWeights[RawDataViseme_Count];
+	volatile LONGLONG m_nUpdateUs;
+};
+END_ZOOM_SDK_NAMESPACE
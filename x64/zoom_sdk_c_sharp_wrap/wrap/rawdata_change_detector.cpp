@@ -0,0 +1,136 @@
+#include "rawdata_change_detector.h"
+#include <emmintrin.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//copies the Y plane into pCopy, width bytes per row, and counts the 8x8 blocks whose sum of absolute differences
+//to the same block of pReference is above tolerance per pixel. Blocks cut by the right or bottom edge only compare
+//the pixels they have. Without a reference only the copy is made.
+static unsigned int CopyAndCompareBlocks(const I420PlaneView& frame, const unsigned char* pReference, unsigned char* pCopy, unsigned int tolerance)
+{
+	unsigned int width = frame.width;
+	unsigned int height = frame.height;
+	if (NULL == pReference)
+	{
+		for (unsigned int y = 0; y < height; ++y)
+			memcpy(pCopy + (size_t)y * width, frame.pY + (size_t)y * frame.yStride, width);
+		return 0;
+	}
+
+	unsigned int changed = 0;
+	for (unsigned int top = 0; top < height; top += CHANGE_DETECTOR_BLOCK_SIZE)
+	{
+		unsigned int rows = height - top < CHANGE_DETECTOR_BLOCK_SIZE ? height - top : CHANGE_DETECTOR_BLOCK_SIZE;
+		const unsigned char* pRow = frame.pY + (size_t)top * frame.yStride;
+		size_t offset = (size_t)top * width;
+		unsigned int limit = tolerance * rows * CHANGE_DETECTOR_BLOCK_SIZE;
+		unsigned int x = 0;
+		//psadbw sums each 8 byte half, which is one block row of two neighbouring blocks
+		for (; x + 16 <= width; x += 16)
+		{
+			__m128i acc = _mm_setzero_si128();
+			for (unsigned int row = 0; row < rows; ++row)
+			{
+				size_t at = offset + (size_t)row * width + x;
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(pRow + (size_t)row * frame.yStride + x));
+				_mm_storeu_si128((__m128i*)(pCopy + at), pixels);
+				acc = _mm_add_epi64(acc, _mm_sad_epu8(pixels, _mm_loadu_si128((const __m128i*)(pReference + at))));
+			}
+			if ((unsigned int)_mm_cvtsi128_si32(acc) > limit)
+				++changed;
+			if ((unsigned int)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8)) > limit)
+				++changed;
+		}
+		for (; x < width; x += CHANGE_DETECTOR_BLOCK_SIZE)
+		{
+			unsigned int cols = width - x < CHANGE_DETECTOR_BLOCK_SIZE ? width - x : CHANGE_DETECTOR_BLOCK_SIZE;
+			unsigned int sad = 0;
+			for (unsigned int row = 0; row < rows; ++row)
+			{
+				const unsigned char* p = pRow + (size_t)row * frame.yStride + x;
+				size_t at = offset + (size_t)row * width + x;
+				for (unsigned int col = 0; col < cols; ++col)
+				{
+					pCopy[at + col] = p[col];
+					sad += p[col] > pReference[at + col] ? p[col] - pReference[at + col] : pReference[at + col] - p[col];
+				}
+			}
+			if (sad > tolerance * rows * cols)
+				++changed;
+		}
+	}
+	return changed;
+}
+
+CRawDataChangeDetector::CRawDataChangeDetector()
+{
+	m_iReference = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nTolerance = 2;
+	m_nChangedPermille = 1;
+	m_nLastChangedBlocks = 0;
+	m_nSkipped = 0;
+}
+
+void CRawDataChangeDetector::SetThreshold(unsigned int tolerance, unsigned int changedPermille)
+{
+	m_nTolerance = tolerance;
+	m_nChangedPermille = changedPermille > 1000 ? 1000 : changedPermille;
+}
+
+void CRawDataChangeDetector::Reset()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nLastChangedBlocks = 0;
+}
+
+bool CRawDataChangeDetector::IsChanged(const CRawDataFrame* pFrame)
+{
+	return IsChanged(MakeI420PlaneView(pFrame));
+}
+
+bool CRawDataChangeDetector::IsChanged(YUVRawDataI420* data)
+{
+	return IsChanged(MakeI420PlaneView(data));
+}
+
+bool CRawDataChangeDetector::IsChanged(const I420PlaneView& frame)
+{
+	if (!frame.IsValid())
+		return true;
+
+	unsigned int blocksX = (frame.width + CHANGE_DETECTOR_BLOCK_SIZE - 1) / CHANGE_DETECTOR_BLOCK_SIZE;
+	unsigned int blocksY = (frame.height + CHANGE_DETECTOR_BLOCK_SIZE - 1) / CHANGE_DETECTOR_BLOCK_SIZE;
+	size_t blocks = (size_t)blocksX * blocksY;
+	//the frame is copied while it is compared, so a changed frame becomes the reference by swapping the planes
+	CMediaBuffer& current = m_planes[1 - m_iReference];
+	if (!current.Resize((size_t)frame.width * frame.height))
+		return true;
+
+	bool bSameSize = frame.width == m_nWidth && frame.height == m_nHeight;
+	const unsigned char* pReference = bSameSize ? m_planes[m_iReference].GetData() : NULL;
+	unsigned int changed = CopyAndCompareBlocks(frame, pReference, current.GetData(), m_nTolerance);
+	bool bChanged = true;
+	if (bSameSize)
+	{
+		m_nLastChangedBlocks = changed;
+		bChanged = (unsigned long long)changed * 1000 > (unsigned long long)blocks * m_nChangedPermille;
+	}
+	else
+	{
+		m_nLastChangedBlocks = (unsigned int)blocks;
+	}
+
+	if (bChanged)
+	{
+		m_iReference = 1 - m_iReference;
+		m_nWidth = frame.width;
+		m_nHeight = frame.height;
+	}
+	else
+	{
+		++m_nSkipped;
+	}
+	return bChanged;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,46 @@
+#pragma once
+#include "rawdata_yuv_converter.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+#define CHANGE_DETECTOR_BLOCK_SIZE 8
+
+//Tells whether a frame differs enough from the last one that was shown to be worth converting and uploading.
+//The Y plane is cut into 8x8 blocks and each block is compared pixel by pixel with the same block of a copy of
+//the reference frame's Y plane (sum of absolute differences). A block counts as changed when its pixels moved by
+//more than the tolerance on average, the frame when more than changedPermille of its blocks changed.
+//Content that only moves around inside a block, like scrolled text, changes it as well.
+//Run it on the consumer side. Frames reported as unchanged do not replace the reference, so slow drift
+//still adds up to a change eventually.
+class CRawDataChangeDetector
+{
+public:
+	CRawDataChangeDetector();
+
+	//tolerance is the mean absolute luma difference of a block's pixels, 0 counts any difference.
+	//changedPermille is in 1/1000 of the blocks.
+	void SetThreshold(unsigned int tolerance, unsigned int changedPermille);
+	//forgets the reference, the next frame always counts as changed
+	void Reset();
+
+	//the first frame and any size change always count as changed
+	bool IsChanged(const I420PlaneView& frame);
+	bool IsChanged(const CRawDataFrame* pFrame);
+	bool IsChanged(YUVRawDataI420* data);
+
+	unsigned int GetLastChangedBlocks() const { return m_nLastChangedBlocks; }
+	unsigned long long GetSkippedCount() const { return m_nSkipped; }
+
+private:
+	CRawDataChangeDetector(const CRawDataChangeDetector&);
+	CRawDataChangeDetector& operator=(const CRawDataChangeDetector&);
+
+	CMediaBuffer m_planes[2];///<The reference Y plane and the one being compared, width bytes per row.
+	int m_iReference;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+	unsigned int m_nTolerance;
+	unsigned int m_nChangedPermille;
+	unsigned int m_nLastChangedBlocks;
+	unsigned long long m_nSkipped;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,504 @@
+#include "rawdata_fixture.h"
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+BEGIN_ZOOM_SDK_NAMESPACE
+static size_t AlignFixtureOffset(size_t offset)
+{
+	return (offset + RAWDATA_FIXTURE_ALIGNMENT - 1) & ~(size_t)(RAWDATA_FIXTURE_ALIGNMENT - 1);
+}
+
+//payload bytes of a tightly packed I420 frame
+static unsigned long long GetFixtureVideoSize(uint32_t width, uint32_t height)
+{
+	unsigned long long lumaSize = (unsigned long long)width * height;
+	unsigned long long chromaSize = (unsigned long long)((width + 1ULL) / 2) * ((height + 1ULL) / 2);
+	return lumaSize + chromaSize * 2;
+}
+
+CRawDataFixtureWriter& CRawDataFixtureWriter::GetInst()
+{
+	static CRawDataFixtureWriter inst;
+	return inst;
+}
+
+CRawDataFixtureWriter::CRawDataFixtureWriter()
+{
+	m_pFile = NULL;
+	m_nOpen = 0;
+	m_nStartUs = 0;
+	m_nLastTimestamp = 0;
+	m_nRecords = 0;
+}
+
+CRawDataFixtureWriter::~CRawDataFixtureWriter()
+{
+	Close();
+}
+
+bool CRawDataFixtureWriter::Open(const char* path)
+{
+	Close();
+	if (NULL == path)
+		return false;
+
+	CMediaAutoLock lock(m_lock);
+	m_pFile = MediaOpenFile(path, "wb");
+	if (NULL == m_pFile)
+		return false;
+
+	RawDataFixtureHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = RAWDATA_FIXTURE_MAGIC;
+	header.version = RAWDATA_FIXTURE_VERSION;
+	header.headerSize = sizeof(RawDataFixtureHeader);
+	header.recordHeaderSize = sizeof(RawDataFixtureRecord);
+	if (1 != fwrite(&header, sizeof(header), 1, m_pFile))
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+		return false;
+	}
+	m_nStartUs = MediaGetTimeUs();
+	m_nLastTimestamp = 0;
+	m_nRecords = 0;
+	MediaAtomicStore(&m_nOpen, 1);
+	return true;
+}
+
+void CRawDataFixtureWriter::Close()
+{
+	CMediaAutoLock lock(m_lock);
+	if (NULL == m_pFile)
+		return;
+	MediaAtomicStore(&m_nOpen, 0);
+
+	RawDataFixtureHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = RAWDATA_FIXTURE_MAGIC;
+	header.version = RAWDATA_FIXTURE_VERSION;
+	header.headerSize = sizeof(RawDataFixtureHeader);
+	header.recordHeaderSize = sizeof(RawDataFixtureRecord);
+	header.recordCount = m_nRecords;
+	header.duration = m_nLastTimestamp;
+	if (0 == fseek(m_pFile, 0, SEEK_SET))
+		fwrite(&header, sizeof(header), 1, m_pFile);
+	fclose(m_pFile);
+	m_pFile = NULL;
+}
+
+bool CRawDataFixtureWriter::WriteRecord(RawDataFixtureRecord& record, const void* pParts[], const size_t sizes[], int parts)
+{
+	static const unsigned char s_padding[RAWDATA_FIXTURE_ALIGNMENT] = { 0 };
+	CMediaAutoLock lock(m_lock);
+	if (NULL == m_pFile)
+		return false;
+
+	record.timestamp = MediaGetTimeUs() - m_nStartUs;
+	size_t size = 0;
+	for (int i = 0; i < parts; ++i)
+		size += sizes[i];
+	record.size = (uint32_t)size;
+
+	bool bOK = 1 == fwrite(&record, sizeof(record), 1, m_pFile);
+	for (int i = 0; i < parts && bOK; ++i)
+		bOK = 0 == sizes[i] || 1 == fwrite(pParts[i], sizes[i], 1, m_pFile);
+	size_t padding = AlignFixtureOffset(size) - size;
+	if (bOK && padding > 0)
+		bOK = 1 == fwrite(s_padding, padding, 1, m_pFile);
+	if (!bOK)
+	{
+		//a torn record would hide everything after it, stop here and keep what is whole
+		MediaAtomicStore(&m_nOpen, 0);
+		fclose(m_pFile);
+		m_pFile = NULL;
+		return false;
+	}
+	m_nLastTimestamp = record.timestamp;
+	++m_nRecords;
+	return true;
+}
+
+bool CRawDataFixtureWriter::WriteVideo(uint32_t userId, YUVRawDataI420* data, bool bShare)
+{
+	if (!IsOpen() || NULL == data || NULL == data->GetYBuffer() || NULL == data->GetUBuffer() || NULL == data->GetVBuffer())
+		return false;
+
+	RawDataFixtureRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type = bShare ? RawDataFixtureRecord_Share : RawDataFixtureRecord_Video;
+	record.streamId = userId;
+	record.width = data->GetStreamWidth();
+	record.height = data->GetStreamHeight();
+	record.flags = (data->IsLimitedI420() ? 1 : 0) | (data->GetRotation() << 16);
+
+	size_t lumaSize = (size_t)record.width * record.height;
+	size_t chromaSize = (size_t)((record.width + 1) / 2) * ((record.height + 1) / 2);
+	const void* pParts[3] = { data->GetYBuffer(), data->GetUBuffer(), data->GetVBuffer() };
+	size_t sizes[3] = { lumaSize, chromaSize, chromaSize };
+	return WriteRecord(record, pParts, sizes, 3);
+}
+
+bool CRawDataFixtureWriter::WriteMixedAudio(AudioRawData* data)
+{
+	return WriteAudio(RawDataFixtureRecord_MixedAudio, 0, data);
+}
+
+bool CRawDataFixtureWriter::WriteOneWayAudio(uint32_t nodeId, AudioRawData* data)
+{
+	return WriteAudio(RawDataFixtureRecord_OneWayAudio, nodeId, data);
+}
+
+bool CRawDataFixtureWriter::WriteAudio(RawDataFixtureRecordType type, uint32_t streamId, AudioRawData* data)
+{
+	if (!IsOpen() || NULL == data || NULL == data->GetBuffer())
+		return false;
+
+	RawDataFixtureRecord record;
+	memset(&record, 0, sizeof(record));
+	record.type = type;
+	record.streamId = streamId;
+	record.width = data->GetSampleRate();
+	record.height = data->GetChannelNum();
+
+	const void* pParts[1] = { data->GetBuffer() };
+	size_t sizes[1] = { data->GetBufferLen() };
+	return WriteRecord(record, pParts, sizes, 1);
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataFixtureVideoTap::CRawDataFixtureVideoTap(CRawDataFixtureWriter& writer, IZoomSDKRendererDelegate* pNext, uint32_t userId, bool bShare)
+	: m_writer(writer), m_pNext(pNext), m_nUserId((LONG)userId), m_bShare(bShare)
+{
+}
+
+void CRawDataFixtureVideoTap::onRendererBeDestroyed()
+{
+	if (m_pNext)
+		m_pNext->onRendererBeDestroyed();
+}
+
+void CRawDataFixtureVideoTap::onRawDataFrameReceived(YUVRawDataI420* data)
+{
+	m_writer.WriteVideo((uint32_t)MediaAtomicLoad(&m_nUserId), data, m_bShare);
+	if (m_pNext)
+		m_pNext->onRawDataFrameReceived(data);
+}
+
+void CRawDataFixtureVideoTap::onRawDataStatusChanged(RawDataStatus status)
+{
+	if (m_pNext)
+		m_pNext->onRawDataStatusChanged(status);
+}
+
+CRawDataFixtureAudioTap::CRawDataFixtureAudioTap(CRawDataFixtureWriter& writer, IZoomSDKAudioRawDataDelegate* pNext)
+	: m_writer(writer), m_pNext(pNext)
+{
+}
+
+void CRawDataFixtureAudioTap::onMixedAudioRawDataReceived(AudioRawData* data_)
+{
+	m_writer.WriteMixedAudio(data_);
+	if (m_pNext)
+		m_pNext->onMixedAudioRawDataReceived(data_);
+}
+
+void CRawDataFixtureAudioTap::onOneWayAudioRawDataReceived(AudioRawData* data_, uint32_t node_id)
+{
+	m_writer.WriteOneWayAudio(node_id, data_);
+	if (m_pNext)
+		m_pNext->onOneWayAudioRawDataReceived(data_, node_id);
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataFixtureReader::CRawDataFixtureReader()
+{
+	m_pData = NULL;
+	m_nSize = 0;
+#ifdef _WIN32
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+#else
+	m_fd = -1;
+#endif
+}
+
+CRawDataFixtureReader::~CRawDataFixtureReader()
+{
+	Close();
+}
+
+bool CRawDataFixtureReader::Open(const char* path)
+{
+	Close();
+	if (NULL == path)
+		return false;
+
+#ifdef _WIN32
+	m_hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER size;
+	if (INVALID_HANDLE_VALUE == m_hFile || !GetFileSizeEx(m_hFile, &size) || 0 == size.QuadPart)
+	{
+		Close();
+		return false;
+	}
+	m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping)
+		m_pData = (const unsigned char*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	m_nSize = (size_t)size.QuadPart;
+#else
+	m_fd = open(path, O_RDONLY);
+	struct stat info;
+	if (m_fd < 0 || 0 != fstat(m_fd, &info) || 0 == info.st_size)
+	{
+		Close();
+		return false;
+	}
+	void* pMapped = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, m_fd, 0);
+	m_pData = MAP_FAILED == pMapped ? NULL : (const unsigned char*)pMapped;
+	m_nSize = (size_t)info.st_size;
+#endif
+	if (NULL == m_pData || m_nSize < sizeof(RawDataFixtureHeader))
+	{
+		Close();
+		return false;
+	}
+
+	const RawDataFixtureHeader* pHeader = (const RawDataFixtureHeader*)m_pData;
+	if (RAWDATA_FIXTURE_MAGIC != pHeader->magic || RAWDATA_FIXTURE_VERSION != pHeader->version
+		|| pHeader->headerSize < sizeof(RawDataFixtureHeader) || pHeader->recordHeaderSize < sizeof(RawDataFixtureRecord))
+	{
+		Close();
+		return false;
+	}
+
+	//index every whole record, a recording that was cut off simply ends early
+	size_t offset = AlignFixtureOffset(pHeader->headerSize);
+	while (offset + pHeader->recordHeaderSize <= m_nSize)
+	{
+		const RawDataFixtureRecord* pRecord = (const RawDataFixtureRecord*)(m_pData + offset);
+		size_t end = offset + pHeader->recordHeaderSize + pRecord->size;
+		if (pRecord->type > RawDataFixtureRecord_OneWayAudio || end > m_nSize)
+			break;
+		//the player hands out the planes at the offsets the frame size implies, a video record whose payload
+		//does not hold them is skipped
+		bool bVideo = RawDataFixtureRecord_Video == pRecord->type || RawDataFixtureRecord_Share == pRecord->type;
+		if (!bVideo || GetFixtureVideoSize(pRecord->width, pRecord->height) == pRecord->size)
+			m_records.push_back(offset);
+		offset = AlignFixtureOffset(end);
+	}
+	return true;
+}
+
+void CRawDataFixtureReader::Close()
+{
+#ifdef _WIN32
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (INVALID_HANDLE_VALUE != m_hFile)
+		CloseHandle(m_hFile);
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+#else
+	if (m_pData)
+		munmap((void*)m_pData, m_nSize);
+	if (m_fd >= 0)
+		close(m_fd);
+	m_fd = -1;
+#endif
+	m_pData = NULL;
+	m_nSize = 0;
+	m_records.clear();
+}
+
+const RawDataFixtureRecord* CRawDataFixtureReader::GetRecord(unsigned int index) const
+{
+	if (index >= m_records.size())
+		return NULL;
+	return (const RawDataFixtureRecord*)(m_pData + m_records[index]);
+}
+
+const unsigned char* CRawDataFixtureReader::GetPayload(unsigned int index) const
+{
+	if (index >= m_records.size())
+		return NULL;
+	return m_pData + m_records[index] + ((const RawDataFixtureHeader*)m_pData)->recordHeaderSize;
+}
+
+long long CRawDataFixtureReader::GetDuration() const
+{
+	if (m_records.empty())
+		return 0;
+	return GetRecord((unsigned int)m_records.size() - 1)->timestamp;
+}
+/////////////////////////////////////////////////////////////////////////
+//Frames handed to the delegates. Like the sdk's own, they delete themselves on the last Release().
+class CRawDataFixtureVideoFrame : public YUVRawDataI420
+{
+public:
+	CRawDataFixtureVideoFrame(const RawDataFixtureRecord* pRecord, const unsigned char* pPayload, bool bAddRef)
+		: m_pRecord(pRecord), m_pPayload((char*)pPayload), m_nRef(1), m_bAddRef(bAddRef)
+	{
+	}
+	virtual bool CanAddRef() { return m_bAddRef; }
+	virtual bool AddRef()
+	{
+		if (!m_bAddRef)
+			return false;
+		MediaAtomicIncrement(&m_nRef);
+		return true;
+	}
+	virtual int Release()
+	{
+		LONG ref = MediaAtomicDecrement(&m_nRef);
+		if (0 == ref)
+			delete this;
+		return (int)ref;
+	}
+	virtual char* GetYBuffer() { return m_pPayload; }
+	virtual char* GetUBuffer() { return m_pPayload + (size_t)m_pRecord->width * m_pRecord->height; }
+	virtual char* GetVBuffer() { return GetUBuffer() + (size_t)((m_pRecord->width + 1) / 2) * ((m_pRecord->height + 1) / 2); }
+	virtual char* GetBuffer() { return m_pPayload; }
+	virtual unsigned int GetBufferLen() { return m_pRecord->size; }
+	virtual bool IsLimitedI420() { return 0 != (m_pRecord->flags & 1); }
+	virtual unsigned int GetStreamWidth() { return m_pRecord->width; }
+	virtual unsigned int GetStreamHeight() { return m_pRecord->height; }
+	virtual unsigned int GetRotation() { return m_pRecord->flags >> 16; }
+	virtual unsigned int GetSourceID() { return 0; }
+
+private:
+	const RawDataFixtureRecord* m_pRecord;
+	char* m_pPayload;
+	volatile LONG m_nRef;
+	bool m_bAddRef;
+};
+
+class CRawDataFixtureAudioData : public AudioRawData
+{
+public:
+	CRawDataFixtureAudioData(const RawDataFixtureRecord* pRecord, const unsigned char* pPayload, bool bAddRef)
+		: m_pRecord(pRecord), m_pPayload((char*)pPayload), m_nRef(1), m_bAddRef(bAddRef)
+	{
+	}
+	virtual bool CanAddRef() { return m_bAddRef; }
+	virtual bool AddRef()
+	{
+		if (!m_bAddRef)
+			return false;
+		MediaAtomicIncrement(&m_nRef);
+		return true;
+	}
+	virtual int Release()
+	{
+		LONG ref = MediaAtomicDecrement(&m_nRef);
+		if (0 == ref)
+			delete this;
+		return (int)ref;
+	}
+	virtual char* GetBuffer() { return m_pPayload; }
+	virtual unsigned int GetBufferLen() { return m_pRecord->size; }
+	virtual unsigned int GetSampleRate() { return m_pRecord->width; }
+	virtual unsigned int GetChannelNum() { return m_pRecord->height; }
+
+private:
+	const RawDataFixtureRecord* m_pRecord;
+	char* m_pPayload;
+	volatile LONG m_nRef;
+	bool m_bAddRef;
+};
+
+CRawDataFixturePlayer::CRawDataFixturePlayer(CRawDataFixtureReader& reader) : m_reader(reader)
+{
+	m_pDefaultVideo = NULL;
+	m_pAudio = NULL;
+	m_bAddRef = true;
+}
+
+void CRawDataFixturePlayer::SetVideoDelegate(uint32_t userId, IZoomSDKRendererDelegate* pDelegate, bool bShare)
+{
+	unsigned long long key = ((unsigned long long)(bShare ? RawDataFixtureRecord_Share : RawDataFixtureRecord_Video) << 32) | userId;
+	if (pDelegate)
+		m_video[key] = pDelegate;
+	else
+		m_video.erase(key);
+}
+
+bool CRawDataFixturePlayer::Deliver(const RawDataFixtureRecord* pRecord, const unsigned char* pPayload)
+{
+	switch (pRecord->type)
+	{
+	case RawDataFixtureRecord_Video:
+	case RawDataFixtureRecord_Share:
+		{
+			VideoDelegateMap::iterator iter = m_video.find(((unsigned long long)pRecord->type << 32) | pRecord->streamId);
+			IZoomSDKRendererDelegate* pDelegate = iter != m_video.end() ? iter->second : m_pDefaultVideo;
+			if (NULL == pDelegate)
+				return false;
+			CRawDataFixtureVideoFrame* pFrame = new (std::nothrow) CRawDataFixtureVideoFrame(pRecord, pPayload, m_bAddRef);
+			if (NULL == pFrame)
+				return false;
+			pDelegate->onRawDataFrameReceived(pFrame);
+			pFrame->Release();
+		}
+		return true;
+	case RawDataFixtureRecord_MixedAudio:
+	case RawDataFixtureRecord_OneWayAudio:
+		{
+			if (NULL == m_pAudio)
+				return false;
+			CRawDataFixtureAudioData* pData = new (std::nothrow) CRawDataFixtureAudioData(pRecord, pPayload, m_bAddRef);
+			if (NULL == pData)
+				return false;
+			if (RawDataFixtureRecord_MixedAudio == pRecord->type)
+				m_pAudio->onMixedAudioRawDataReceived(pData);
+			else
+				m_pAudio->onOneWayAudioRawDataReceived(pData, pRecord->streamId);
+			pData->Release();
+		}
+		return true;
+	default:
+		return false;
+	}
+}
+
+unsigned long long CRawDataFixturePlayer::PlayRange(unsigned int first, unsigned int last, RawDataFixturePlayMode mode, long long startUs)
+{
+	unsigned long long delivered = 0;
+	if (last > m_reader.GetRecordCount())
+		last = m_reader.GetRecordCount();
+	for (unsigned int i = first; i < last; ++i)
+	{
+		const RawDataFixtureRecord* pRecord = m_reader.GetRecord(i);
+		if (RawDataFixturePlay_RealTime == mode)
+		{
+			//sleep off whole milliseconds, a late record is delivered right away rather than skipped
+			long long waitUs = startUs + pRecord->timestamp - MediaGetTimeUs();
+			while (waitUs >= 1000)
+			{
+				MediaSleepMs((unsigned int)(waitUs / 1000));
+				waitUs = startUs + pRecord->timestamp - MediaGetTimeUs();
+			}
+		}
+		if (Deliver(pRecord, m_reader.GetPayload(i)))
+			++delivered;
+	}
+	return delivered;
+}
+
+unsigned long long CRawDataFixturePlayer::Play(RawDataFixturePlayMode mode, unsigned int loops)
+{
+	unsigned long long delivered = 0;
+	long long startUs = MediaGetTimeUs();
+	long long duration = m_reader.GetDuration();
+	for (unsigned int loop = 0; loop < loops; ++loop)
+	{
+		delivered += PlayRange(0, m_reader.GetRecordCount(), mode, startUs);
+		startUs += duration;
+	}
+	return delivered;
+}
+END_ZOOM_SDK_NAMESPACE
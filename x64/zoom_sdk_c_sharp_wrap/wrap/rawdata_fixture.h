@@ -0,0 +1,198 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "zoom_sdk_def.h"
+#include "zoom_sdk_raw_data_def.h"
+#include "rawdata/rawdata_renderer_interface.h"
+#include "rawdata/rawdata_audio_helper_interface.h"
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//Raw media fixtures: what the sdk delivered to the raw data delegates during a meeting, recorded to a file
+//and replayed into the same delegate interfaces later, on Windows or on Linux without the sdk.
+//
+//File layout, little endian. Every record starts on a 32 byte boundary, so a mapped fixture hands out
+//planes and samples that the SIMD kernels can read in place:
+//  RawDataFixtureHeader
+//  RawDataFixtureRecord, payload, padding to 32 bytes
+//  ...
+//Video payloads are I420 with tightly packed planes (Y, then U, then V). Audio payloads are the sdk's
+//16 bit interleaved PCM.
+#define RAWDATA_FIXTURE_MAGIC 0x5846525A///<"ZRFX"
+#define RAWDATA_FIXTURE_VERSION 1
+#define RAWDATA_FIXTURE_ALIGNMENT 32
+
+typedef enum
+{
+	RawDataFixtureRecord_Video,///<onRawDataFrameReceived of a RAW_DATA_TYPE_VIDEO renderer, streamId is the user id.
+	RawDataFixtureRecord_Share,///<onRawDataFrameReceived of a RAW_DATA_TYPE_SHARE renderer, streamId is the user id.
+	RawDataFixtureRecord_MixedAudio,///<onMixedAudioRawDataReceived, streamId is 0.
+	RawDataFixtureRecord_OneWayAudio,///<onOneWayAudioRawDataReceived, streamId is the node id.
+}RawDataFixtureRecordType;
+
+typedef struct tagRawDataFixtureHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t headerSize;
+	uint32_t recordHeaderSize;
+	uint64_t recordCount;///<Written on Close(). A fixture cut short is still read up to its last whole record.
+	int64_t duration;///<Timestamp of the last record in microseconds.
+}RawDataFixtureHeader;
+
+typedef struct tagRawDataFixtureRecord
+{
+	uint32_t type;///<RawDataFixtureRecordType.
+	uint32_t streamId;
+	int64_t timestamp;///<Microseconds since the recording started.
+	uint32_t size;///<Payload bytes, without the padding.
+	uint32_t width;///<Video width, or audio sample rate.
+	uint32_t height;///<Video height, or audio channel count.
+	uint32_t flags;///<Video only: bit 0 is IsLimitedI420(), bits 16-31 are GetRotation().
+}RawDataFixtureRecord;
+
+//Appends records to a fixture file. The Write calls may come from several sdk threads at once, they are
+//serialized by a lock and written synchronously, so keep recordings to test sessions.
+//While no file is open they return right away without taking the lock.
+class CRawDataFixtureWriter
+{
+public:
+	//the writer the wrapper's own delegates record into, CRawDataRendererSlot and CRawDataAudioRingManager
+	static CRawDataFixtureWriter& GetInst();
+
+	CRawDataFixtureWriter();
+	~CRawDataFixtureWriter();
+
+	bool Open(const char* path);
+	//writes the record count and duration into the header and closes the file
+	void Close();
+	bool IsOpen() const { return 0 != MediaAtomicLoad(&m_nOpen); }
+
+	bool WriteVideo(uint32_t userId, YUVRawDataI420* data, bool bShare = false);
+	bool WriteMixedAudio(AudioRawData* data);
+	bool WriteOneWayAudio(uint32_t nodeId, AudioRawData* data);
+	unsigned long long GetRecordCount() const { return m_nRecords; }
+
+private:
+	CRawDataFixtureWriter(const CRawDataFixtureWriter&);
+	CRawDataFixtureWriter& operator=(const CRawDataFixtureWriter&);
+	bool WriteRecord(RawDataFixtureRecord& record, const void* pParts[], const size_t sizes[], int parts);
+	bool WriteAudio(RawDataFixtureRecordType type, uint32_t streamId, AudioRawData* data);
+
+	CMediaLock m_lock;
+	FILE* m_pFile;
+	volatile LONG m_nOpen;///<m_pFile is set, for the unlocked check in the Write calls.
+	long long m_nStartUs;
+	long long m_nLastTimestamp;
+	unsigned long long m_nRecords;
+};
+
+//Records the frames of one renderer and passes them on to the delegate that would have got them.
+//Create the renderer with the tap as its delegate. The wrapper's own delegates need no tap, they record into
+//CRawDataFixtureWriter::GetInst() already.
+class CRawDataFixtureVideoTap : public IZoomSDKRendererDelegate
+{
+public:
+	CRawDataFixtureVideoTap(CRawDataFixtureWriter& writer, IZoomSDKRendererDelegate* pNext, uint32_t userId, bool bShare = false);
+	//the renderer was moved to another user
+	void SetUserId(uint32_t userId) { MediaAtomicStore(&m_nUserId, (LONG)userId); }
+
+	virtual void onRendererBeDestroyed();
+	virtual void onRawDataFrameReceived(YUVRawDataI420* data);
+	virtual void onRawDataStatusChanged(RawDataStatus status);
+
+private:
+	CRawDataFixtureWriter& m_writer;
+	IZoomSDKRendererDelegate* m_pNext;
+	volatile LONG m_nUserId;
+	bool m_bShare;
+};
+
+//The same for IZoomSDKAudioRawDataHelper::subscribe().
+class CRawDataFixtureAudioTap : public IZoomSDKAudioRawDataDelegate
+{
+public:
+	CRawDataFixtureAudioTap(CRawDataFixtureWriter& writer, IZoomSDKAudioRawDataDelegate* pNext);
+
+	virtual void onMixedAudioRawDataReceived(AudioRawData* data_);
+	virtual void onOneWayAudioRawDataReceived(AudioRawData* data_, uint32_t node_id);
+
+private:
+	CRawDataFixtureWriter& m_writer;
+	IZoomSDKAudioRawDataDelegate* m_pNext;
+};
+
+//Maps a fixture read-only and indexes its records. Video records whose payload does not hold the frame their
+//size describes are left out.
+class CRawDataFixtureReader
+{
+public:
+	CRawDataFixtureReader();
+	~CRawDataFixtureReader();
+
+	bool Open(const char* path);
+	void Close();
+	bool IsOpen() const { return NULL != m_pData; }
+
+	unsigned int GetRecordCount() const { return (unsigned int)m_records.size(); }
+	//the payload follows the record and stays valid until Close()
+	const RawDataFixtureRecord* GetRecord(unsigned int index) const;
+	const unsigned char* GetPayload(unsigned int index) const;
+	long long GetDuration() const;
+
+private:
+	CRawDataFixtureReader(const CRawDataFixtureReader&);
+	CRawDataFixtureReader& operator=(const CRawDataFixtureReader&);
+
+	const unsigned char* m_pData;
+	size_t m_nSize;
+	std::vector<size_t> m_records;///<Offset of every record.
+#ifdef _WIN32
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+#else
+	int m_fd;
+#endif
+};
+
+typedef enum
+{
+	RawDataFixturePlay_RealTime,///<Records are delivered at their recorded times.
+	RawDataFixturePlay_AsFastAsPossible,///<Records are delivered back to back, for benchmarks.
+}RawDataFixturePlayMode;
+
+//Replays a fixture into sdk delegates on the calling thread. Frames are handed out the way the sdk does it:
+//refcounted objects whose buffers point into the mapped file, deleted on their last Release().
+//The reader has to stay open until every frame a delegate kept with AddRef() has been released.
+class CRawDataFixturePlayer
+{
+public:
+	CRawDataFixturePlayer(CRawDataFixtureReader& reader);
+
+	//NULL removes the delegate. Video records of users without a delegate go to the default one, if set.
+	void SetVideoDelegate(uint32_t userId, IZoomSDKRendererDelegate* pDelegate, bool bShare = false);
+	void SetDefaultVideoDelegate(IZoomSDKRendererDelegate* pDelegate) { m_pDefaultVideo = pDelegate; }
+	void SetAudioDelegate(IZoomSDKAudioRawDataDelegate* pDelegate) { m_pAudio = pDelegate; }
+	//frames report CanAddRef() false when disabled, to exercise the copying paths
+	void EnableAddRef(bool bEnable) { m_bAddRef = bEnable; }
+
+	//plays the whole fixture loops times and returns how many records were delivered.
+	//In real time the loops follow each other without a gap, so a looped fixture looks like one long meeting.
+	unsigned long long Play(RawDataFixturePlayMode mode, unsigned int loops = 1);
+	//plays records [first, last) once, timed against startUs when in real time
+	unsigned long long PlayRange(unsigned int first, unsigned int last, RawDataFixturePlayMode mode, long long startUs);
+
+private:
+	CRawDataFixturePlayer(const CRawDataFixturePlayer&);
+	CRawDataFixturePlayer& operator=(const CRawDataFixturePlayer&);
+	bool Deliver(const RawDataFixtureRecord* pRecord, const unsigned char* pPayload);
+
+	typedef std::map<unsigned long long, IZoomSDKRendererDelegate*> VideoDelegateMap;
+	CRawDataFixtureReader& m_reader;
+	VideoDelegateMap m_video;///<Keyed by record type << 32 | user id.
+	IZoomSDKRendererDelegate* m_pDefaultVideo;
+	IZoomSDKAudioRawDataDelegate* m_pAudio;
+	bool m_bAddRef;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,270 @@
+#include "rawdata_frame_ring.h"
+#include <new>
+BEGIN_ZOOM_SDK_NAMESPACE
+//latest-wins mode keeps three slots (back/middle/front). The middle index carries this flag while it
+//holds a frame the consumer has not picked up yet.
+#define FRAME_RING_MIDDLE_FRESH 0x4
+#define FRAME_RING_MIDDLE_INDEX 0x3
+
+CRawDataFrame::CRawDataFrame()
+{
+	m_pRef = NULL;
+	Reset();
+}
+
+CRawDataFrame::~CRawDataFrame()
+{
+	ReleaseData();
+}
+
+void CRawDataFrame::Reset()
+{
+	m_pY = NULL;
+	m_pU = NULL;
+	m_pV = NULL;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nRotation = 0;
+	m_nSourceID = 0;
+	m_nUserId = 0;
+	m_bLimited = false;
+	m_nSequence = 0;
+	m_nTimestamp = 0;
+	m_nGeneration = 0;
+}
+
+void CRawDataFrame::ReleaseData()
+{
+	if (m_pRef)
+	{
+		m_pRef->Release();
+		m_pRef = NULL;
+		m_pY = NULL;
+		m_pU = NULL;
+		m_pV = NULL;
+	}
+}
+
+bool CRawDataFrame::Assign(YUVRawDataI420* data, unsigned int userId, unsigned long long sequence, long long timestamp)
+{
+	ReleaseData();
+	Reset();
+
+	unsigned int width = data->GetStreamWidth();
+	unsigned int height = data->GetStreamHeight();
+	if (0 == width || 0 == height || NULL == data->GetYBuffer() || NULL == data->GetUBuffer() || NULL == data->GetVBuffer())
+		return false;
+
+	if (data->CanAddRef() && data->AddRef())
+	{
+		m_pRef = data;
+		m_pY = (const unsigned char*)data->GetYBuffer();
+		m_pU = (const unsigned char*)data->GetUBuffer();
+		m_pV = (const unsigned char*)data->GetVBuffer();
+	}
+	else
+	{
+		size_t ySize = (size_t)width * height;
+		size_t uvSize = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+		if (!m_copy.Resize(ySize + uvSize * 2))
+			return false;
+		unsigned char* pDst = m_copy.GetData();
+		memcpy(pDst, data->GetYBuffer(), ySize);
+		memcpy(pDst + ySize, data->GetUBuffer(), uvSize);
+		memcpy(pDst + ySize + uvSize, data->GetVBuffer(), uvSize);
+		m_pY = pDst;
+		m_pU = pDst + ySize;
+		m_pV = pDst + ySize + uvSize;
+	}
+
+	m_nWidth = width;
+	m_nHeight = height;
+	m_nRotation = data->GetRotation();
+	m_nSourceID = data->GetSourceID();
+	m_nUserId = userId;
+	m_bLimited = data->IsLimitedI420();
+	m_nSequence = sequence;
+	m_nTimestamp = timestamp;
+	return true;
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataFrameRing::CRawDataFrameRing()
+{
+	m_mode = FrameRingMode_Queue;
+	m_pSlots = NULL;
+	m_nCapacity = 0;
+	m_nUserId = 0;
+	m_nHead = 0;
+	m_iBack = 0;
+	m_nSequence = 0;
+	m_nTail = 0;
+	m_iFront = 0;
+	m_pAcquired = NULL;
+	m_nMiddle = 0;
+	m_nGeneration = 0;
+	m_nPushed = 0;
+	m_nDropped = 0;
+}
+
+CRawDataFrameRing::~CRawDataFrameRing()
+{
+	Uninit();
+}
+
+bool CRawDataFrameRing::Init(FrameRingMode mode, unsigned int capacity)
+{
+	Uninit();
+
+	unsigned int slots = 3;
+	if (FrameRingMode_Queue == mode)
+	{
+		slots = 2;
+		while (slots < capacity && slots < 0x10000)
+			slots <<= 1;
+	}
+
+	m_pSlots = new (std::nothrow) CRawDataFrame[slots];
+	if (NULL == m_pSlots)
+		return false;
+
+	m_mode = mode;
+	m_nCapacity = slots;
+	m_nHead = 0;
+	m_nTail = 0;
+	m_nSequence = 0;
+	m_pAcquired = NULL;
+	m_iBack = 0;
+	m_nMiddle = 1;
+	m_iFront = 2;
+	m_nPushed = 0;
+	m_nDropped = 0;
+	return true;
+}
+
+void CRawDataFrameRing::Uninit()
+{
+	if (m_pSlots)
+	{
+		delete[] m_pSlots;
+		m_pSlots = NULL;
+	}
+	m_nCapacity = 0;
+	m_pAcquired = NULL;
+}
+
+void CRawDataFrameRing::SetUserId(unsigned int userId)
+{
+	MediaAtomicStore(&m_nUserId, (LONG)userId);
+}
+
+void CRawDataFrameRing::Discard()
+{
+	MediaAtomicIncrement(&m_nGeneration);
+}
+
+bool CRawDataFrameRing::PushFrame(YUVRawDataI420* data)
+{
+	if (NULL == data || NULL == m_pSlots)
+		return false;
+
+	unsigned long long sequence = ++m_nSequence;
+	long long timestamp = MediaGetTimeUs();
+	MediaAtomicIncrement64(&m_nPushed);
+	if (FrameRingMode_LatestWins == m_mode)
+		return PushLatest(data, sequence, timestamp);
+	return PushQueue(data, sequence, timestamp);
+}
+
+bool CRawDataFrameRing::PushQueue(YUVRawDataI420* data, unsigned long long sequence, long long timestamp)
+{
+	ULONG head = (ULONG)m_nHead;
+	ULONG tail = (ULONG)MediaAtomicLoad(&m_nTail);
+	if (head - tail >= m_nCapacity)
+	{
+		MediaAtomicIncrement64(&m_nDropped);
+		return false;
+	}
+
+	//the generation is read before the user id, a frame of the current generation never has the old user's id
+	LONG generation = MediaAtomicLoad(&m_nGeneration);
+	CRawDataFrame& slot = m_pSlots[head & (m_nCapacity - 1)];
+	if (!slot.Assign(data, (unsigned int)MediaAtomicLoad(&m_nUserId), sequence, timestamp))
+	{
+		MediaAtomicIncrement64(&m_nDropped);
+		return false;
+	}
+	slot.m_nGeneration = generation;
+	MediaAtomicStore(&m_nHead, (LONG)(head + 1));
+	return true;
+}
+
+bool CRawDataFrameRing::PushLatest(YUVRawDataI420* data, unsigned long long sequence, long long timestamp)
+{
+	LONG generation = MediaAtomicLoad(&m_nGeneration);
+	CRawDataFrame& slot = m_pSlots[m_iBack];
+	if (!slot.Assign(data, (unsigned int)MediaAtomicLoad(&m_nUserId), sequence, timestamp))
+	{
+		MediaAtomicIncrement64(&m_nDropped);
+		return false;
+	}
+	slot.m_nGeneration = generation;
+
+	LONG prev = MediaAtomicExchange(&m_nMiddle, (LONG)(m_iBack | FRAME_RING_MIDDLE_FRESH));
+	m_iBack = (unsigned int)(prev & FRAME_RING_MIDDLE_INDEX);
+	if (prev & FRAME_RING_MIDDLE_FRESH)
+		MediaAtomicIncrement64(&m_nDropped);
+	//do not pin an sdk frame nobody is going to read
+	m_pSlots[m_iBack].ReleaseData();
+	return true;
+}
+
+const CRawDataFrame* CRawDataFrameRing::AcquireFrame()
+{
+	if (NULL == m_pSlots)
+		return NULL;
+	if (m_pAcquired)
+		ReleaseFrame(m_pAcquired);
+
+	//frames from before the last Discard() are released here, on the consumer side
+	const CRawDataFrame* pFrame = AcquireNext();
+	while (pFrame && pFrame->m_nGeneration != MediaAtomicLoad(&m_nGeneration))
+	{
+		MediaAtomicIncrement64(&m_nDropped);
+		ReleaseFrame(pFrame);
+		pFrame = AcquireNext();
+	}
+	return pFrame;
+}
+
+const CRawDataFrame* CRawDataFrameRing::AcquireNext()
+{
+	if (FrameRingMode_LatestWins == m_mode)
+	{
+		if (0 == (MediaAtomicLoad(&m_nMiddle) & FRAME_RING_MIDDLE_FRESH))
+			return NULL;
+		LONG prev = MediaAtomicExchange(&m_nMiddle, (LONG)m_iFront);
+		m_iFront = (unsigned int)(prev & FRAME_RING_MIDDLE_INDEX);
+		m_pAcquired = &m_pSlots[m_iFront];
+		return m_pAcquired;
+	}
+
+	ULONG tail = (ULONG)m_nTail;
+	ULONG head = (ULONG)MediaAtomicLoad(&m_nHead);
+	if (head == tail)
+		return NULL;
+	m_pAcquired = &m_pSlots[tail & (m_nCapacity - 1)];
+	return m_pAcquired;
+}
+
+void CRawDataFrameRing::ReleaseFrame(const CRawDataFrame* pFrame)
+{
+	if (NULL == pFrame || pFrame != m_pAcquired)
+		return;
+
+	//only the consumer touches an acquired slot, so it is safe to drop the sdk reference here
+	const_cast<CRawDataFrame*>(pFrame)->ReleaseData();
+	m_pAcquired = NULL;
+	if (FrameRingMode_Queue == m_mode)
+		MediaAtomicStore(&m_nTail, (LONG)((ULONG)m_nTail + 1));
+}
+END_ZOOM_SDK_NAMESPACE
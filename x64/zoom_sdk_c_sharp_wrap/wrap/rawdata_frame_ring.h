@@ -0,0 +1,129 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "zoom_sdk_raw_data_def.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+typedef enum
+{
+	FrameRingMode_Queue,///<Every frame is kept until the consumer pops it. When full, new frames are dropped.
+	FrameRingMode_LatestWins,///<The consumer always gets the newest frame. Unread older frames are recycled.
+}FrameRingMode;
+
+//One I420 frame owned by a ring slot. The planes either point into an sdk frame kept alive with AddRef(),
+//or into the slot's own copy when the sdk does not allow that. Planes are tightly packed:
+//the y stride is the width and the u/v stride is (width + 1) / 2.
+class CRawDataFrame
+{
+public:
+	CRawDataFrame();
+	~CRawDataFrame();
+
+	const unsigned char* GetYBuffer() const { return m_pY; }
+	const unsigned char* GetUBuffer() const { return m_pU; }
+	const unsigned char* GetVBuffer() const { return m_pV; }
+	unsigned int GetYStride() const { return m_nWidth; }
+	unsigned int GetUVStride() const { return (m_nWidth + 1) / 2; }
+	unsigned int GetStreamWidth() const { return m_nWidth; }
+	unsigned int GetStreamHeight() const { return m_nHeight; }
+	unsigned int GetRotation() const { return m_nRotation; }
+	unsigned int GetSourceID() const { return m_nSourceID; }
+	unsigned int GetUserId() const { return m_nUserId; }
+	bool IsLimitedI420() const { return m_bLimited; }
+	//true when the planes are borrowed from the sdk frame instead of copied
+	bool IsReferenced() const { return NULL != m_pRef; }
+	//per ring counter, starts at 1
+	unsigned long long GetSequence() const { return m_nSequence; }
+	//arrival time in microseconds, see MediaGetTimeUs()
+	long long GetTimestamp() const { return m_nTimestamp; }
+
+private:
+	friend class CRawDataFrameRing;
+	bool Assign(YUVRawDataI420* data, unsigned int userId, unsigned long long sequence, long long timestamp);
+	void ReleaseData();
+	void Reset();
+
+	YUVRawDataI420* m_pRef;
+	CMediaBuffer m_copy;
+	const unsigned char* m_pY;
+	const unsigned char* m_pU;
+	const unsigned char* m_pV;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+	unsigned int m_nRotation;
+	unsigned int m_nSourceID;
+	unsigned int m_nUserId;
+	bool m_bLimited;
+	unsigned long long m_nSequence;
+	long long m_nTimestamp;
+	LONG m_nGeneration;///<Ring generation at push time, see CRawDataFrameRing::Discard().
+};
+
+//Single-producer/single-consumer frame ring. The producer is the sdk callback thread calling PushFrame(),
+//the consumer is any one other thread calling AcquireFrame()/ReleaseFrame(). Neither side takes a lock,
+//so a slow consumer never stalls the sdk thread.
+class CRawDataFrameRing
+{
+public:
+	CRawDataFrameRing();
+	~CRawDataFrameRing();
+
+	//capacity is rounded up to a power of two in queue mode and ignored in latest-wins mode (3 slots).
+	//Init and Uninit are not thread safe, call them while no frames are delivered.
+	bool Init(FrameRingMode mode, unsigned int capacity = 4);
+	void Uninit();
+	bool IsValid() const { return NULL != m_pSlots; }
+	FrameRingMode GetMode() const { return m_mode; }
+
+	//frames pushed after this call are tagged with userId
+	void SetUserId(unsigned int userId);
+	//frames pushed before this call are never handed out. Any thread may call it, the consumer drops the
+	//stale frames on its next AcquireFrame(), so a ring that moves to another user needs no draining.
+	void Discard();
+
+	//producer side. Returns false if the frame was dropped.
+	bool PushFrame(YUVRawDataI420* data);
+
+	//consumer side. Queue mode returns the oldest unread frame, latest-wins mode the newest frame not yet
+	//acquired. Returns NULL when there is nothing new. The frame stays valid until ReleaseFrame(),
+	//which must be called before the next AcquireFrame().
+	const CRawDataFrame* AcquireFrame();
+	void ReleaseFrame(const CRawDataFrame* pFrame);
+	//the frame acquired and not yet released, NULL if there is none
+	const CRawDataFrame* GetAcquiredFrame() const { return m_pAcquired; }
+
+	unsigned long long GetPushedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nPushed); }
+	//frames lost because the ring was full (queue) or replaced before they were read (latest-wins)
+	unsigned long long GetDroppedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nDropped); }
+
+private:
+	CRawDataFrameRing(const CRawDataFrameRing&);
+	CRawDataFrameRing& operator=(const CRawDataFrameRing&);
+	bool PushQueue(YUVRawDataI420* data, unsigned long long sequence, long long timestamp);
+	bool PushLatest(YUVRawDataI420* data, unsigned long long sequence, long long timestamp);
+	const CRawDataFrame* AcquireNext();
+
+	FrameRingMode m_mode;
+	CRawDataFrame* m_pSlots;
+	unsigned int m_nCapacity;
+	volatile LONG m_nUserId;
+
+	//producer owned
+	char m_padProducer[64];
+	volatile LONG m_nHead;
+	unsigned int m_iBack;
+	unsigned long long m_nSequence;
+
+	//consumer owned
+	char m_padConsumer[64];
+	volatile LONG m_nTail;
+	unsigned int m_iFront;
+	const CRawDataFrame* m_pAcquired;
+
+	//shared between both sides
+	char m_padShared[64];
+	volatile LONG m_nMiddle;
+	volatile LONG m_nGeneration;
+	volatile LONGLONG m_nPushed;
+	volatile LONGLONG m_nDropped;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,281 @@
+#include "rawdata_lod_scheduler.h"
+#include <algorithm>
+BEGIN_ZOOM_SDK_NAMESPACE
+#define LOD_LEVEL_COUNT 6
+//a failed subscribe or step up waits this long before the next try, twice as long after every further failure
+#define LOD_RETRY_MIN_MS 500
+#define LOD_RETRY_MAX_MS 16000
+
+static const ZoomSDKResolution s_lodResolutions[LOD_LEVEL_COUNT] = { ZoomSDKResolution_NoUse, ZoomSDKResolution_90P, ZoomSDKResolution_180P, ZoomSDKResolution_360P, ZoomSDKResolution_720P, ZoomSDKResolution_1080P };
+static const unsigned int s_lodHeights[LOD_LEVEL_COUNT] = { 0, 90, 180, 360, 720, 1080 };
+static const unsigned int s_lodPixels[LOD_LEVEL_COUNT] = { 0, 160 * 90, 320 * 180, 640 * 360, 1280 * 720, 1920 * 1080 };
+
+CRawDataLODScheduler::CRawDataLODScheduler()
+{
+	m_nBudgetPixels = 2 * 1920 * 1080;
+	m_nMaxSubscriptions = 25;
+	m_nMaxChangesPerUpdate = 4;
+	m_nHoldMs = 1000;
+	m_nUsedPixels = 0;
+	m_fMargin = 0.15f;
+	m_fMinPixels = 4.0f;
+	m_fPixelsAtUnitDistance = 540.0f;
+}
+
+CRawDataLODScheduler& CRawDataLODScheduler::GetInst()
+{
+	static CRawDataLODScheduler inst;
+	return inst;
+}
+
+void CRawDataLODScheduler::SetBudget(unsigned int budgetPixels, unsigned int maxSubscriptions)
+{
+	m_nBudgetPixels = budgetPixels;
+	m_nMaxSubscriptions = maxSubscriptions;
+}
+
+void CRawDataLODScheduler::SetHysteresis(float margin, unsigned int holdMs)
+{
+	m_fMargin = margin < 0.0f ? 0.0f : (margin > 0.9f ? 0.9f : margin);
+	m_nHoldMs = holdMs;
+}
+
+void CRawDataLODScheduler::SetLimits(float minPixels, unsigned int maxChangesPerUpdate)
+{
+	m_fMinPixels = minPixels;
+	m_nMaxChangesPerUpdate = maxChangesPerUpdate > 0 ? maxChangesPerUpdate : 1;
+}
+
+void CRawDataLODScheduler::SetDistanceReference(float pixelsAtUnitDistance)
+{
+	m_fPixelsAtUnitDistance = pixelsAtUnitDistance;
+}
+
+void CRawDataLODScheduler::SetUserScreenSize(uint32_t userId, float pixels)
+{
+	UserMap::iterator iter = m_users.find(userId);
+	if (iter == m_users.end())
+	{
+		LODUser user;
+		user.demand = 0.0f;
+		user.level = 0;
+		user.target = 0;
+		user.lastChangeMs = 0;
+		user.retryMs = 0;
+		user.retryDelayMs = LOD_RETRY_MIN_MS;
+		user.bRemoved = false;
+		iter = m_users.insert(UserMap::value_type(userId, user)).first;
+	}
+	iter->second.demand = pixels > 0.0f ? pixels : 0.0f;
+	iter->second.bRemoved = false;
+}
+
+void CRawDataLODScheduler::SetUserDistance(uint32_t userId, float distance)
+{
+	SetUserScreenSize(userId, distance > 0.0f ? m_fPixelsAtUnitDistance / distance : 0.0f);
+}
+
+void CRawDataLODScheduler::RemoveUser(uint32_t userId)
+{
+	UserMap::iterator iter = m_users.find(userId);
+	if (iter != m_users.end())
+	{
+		iter->second.bRemoved = true;
+		iter->second.demand = 0.0f;
+	}
+}
+
+void CRawDataLODScheduler::OnUserLeft(IList<unsigned int>* lstUserID)
+{
+	if (NULL == lstUserID)
+		return;
+	CMediaAutoLock lock(m_leftLock);
+	for (int i = 0; i < lstUserID->GetCount(); ++i)
+		m_left.push_back(lstUserID->GetItem(i));
+}
+
+void CRawDataLODScheduler::RemoveAllUsers()
+{
+	for (UserMap::iterator iter = m_users.begin(); iter != m_users.end(); ++iter)
+	{
+		iter->second.bRemoved = true;
+		iter->second.demand = 0.0f;
+	}
+}
+
+ZoomSDKResolution CRawDataLODScheduler::GetUserResolution(uint32_t userId) const
+{
+	UserMap::const_iterator iter = m_users.find(userId);
+	if (iter == m_users.end())
+		return ZoomSDKResolution_NoUse;
+	return s_lodResolutions[iter->second.level];
+}
+
+int CRawDataLODScheduler::GetLevelFor(float demand) const
+{
+	if (demand < m_fMinPixels)
+		return 0;
+	for (int level = 1; level < LOD_LEVEL_COUNT; ++level)
+	{
+		if ((float)s_lodHeights[level] >= demand)
+			return level;
+	}
+	return LOD_LEVEL_COUNT - 1;
+}
+
+int CRawDataLODScheduler::GetHysteresisLevel(const LODUser& user, long long nowMs) const
+{
+	if (user.bRemoved)
+		return 0;
+	if (0 != user.level && nowMs - user.lastChangeMs < (long long)m_nHoldMs)
+		return user.level;
+
+	//going up needs the demand to clear the threshold by the margin, going down to fall below it by the margin
+	int up = GetLevelFor(user.demand * (1.0f - m_fMargin));
+	int down = GetLevelFor(user.demand * (1.0f + m_fMargin));
+	if (up > user.level)
+		return up;
+	if (down < user.level)
+		return down;
+	return user.level;
+}
+
+void CRawDataLODScheduler::ApplyBudget(std::vector<UserMap::iterator>& users)
+{
+	unsigned long long pixels = 0;
+	unsigned int subscriptions = 0;
+	for (size_t i = 0; i < users.size(); ++i)
+	{
+		pixels += s_lodPixels[users[i]->second.target];
+		if (users[i]->second.target > 0)
+			++subscriptions;
+	}
+
+	while (pixels > m_nBudgetPixels || subscriptions > m_nMaxSubscriptions)
+	{
+		//over the subscription cap the smallest user is dropped. Over the pixel budget the user whose level is
+		//the largest for how big they are drawn steps down, which spreads the cut over everyone. Whoever already
+		//holds the level gets the margin as a bonus, so two users of about the same size do not trade places
+		//every update.
+		bool bDrop = subscriptions > m_nMaxSubscriptions;
+		UserMap::iterator victim = m_users.end();
+		float victimScore = 0.0f;
+		for (size_t i = 0; i < users.size(); ++i)
+		{
+			LODUser& user = users[i]->second;
+			if (0 == user.target)
+				continue;
+			float demand = user.target <= user.level ? user.demand * (1.0f + m_fMargin) : user.demand;
+			float score = bDrop ? -demand : (float)s_lodHeights[user.target] / (demand > 1.0f ? demand : 1.0f);
+			if (victim == m_users.end() || score > victimScore || (score == victimScore && users[i]->first > victim->first))
+			{
+				victim = users[i];
+				victimScore = score;
+			}
+		}
+		if (victim == m_users.end())
+			break;
+
+		LODUser& user = victim->second;
+		pixels -= s_lodPixels[user.target];
+		if (bDrop)
+			user.target = 0;
+		else
+			--user.target;
+		pixels += s_lodPixels[user.target];
+		if (0 == user.target)
+			--subscriptions;
+	}
+}
+
+unsigned int CRawDataLODScheduler::Update(CRawDataRendererManager& manager)
+{
+	return Update(manager, MediaGetTimeUs() / 1000);
+}
+
+unsigned int CRawDataLODScheduler::Update(CRawDataRendererManager& manager, long long nowMs)
+{
+	std::vector<uint32_t> left;
+	{
+		CMediaAutoLock lock(m_leftLock);
+		left.swap(m_left);
+	}
+	for (size_t i = 0; i < left.size(); ++i)
+		RemoveUser(left[i]);
+
+	std::vector<UserMap::iterator> users;
+	users.reserve(m_users.size());
+	for (UserMap::iterator iter = m_users.begin(); iter != m_users.end(); ++iter)
+	{
+		//the sdk may have dropped the renderer, e.g. the user left the meeting
+		if (iter->second.level > 0 && !manager.IsSubscribed(iter->first))
+			iter->second.level = 0;
+		iter->second.target = GetHysteresisLevel(iter->second, nowMs);
+		//a user the sdk refused keeps what it has until the retry is due, and takes no budget meanwhile
+		if (iter->second.target > iter->second.level && nowMs < iter->second.retryMs)
+			iter->second.target = iter->second.level;
+		users.push_back(iter);
+	}
+	ApplyBudget(users);
+
+	//step downs first, so the budget is free before anyone steps up
+	unsigned int changes = 0;
+	for (size_t i = 0; i < users.size(); ++i)
+	{
+		LODUser& user = users[i]->second;
+		if (user.target >= user.level)
+			continue;
+		SDKError err = 0 == user.target ? manager.Unsubscribe(users[i]->first) : manager.SetResolution(users[i]->first, s_lodResolutions[user.target]);
+		if (SDKERR_SUCCESS == err || 0 == user.target)
+		{
+			user.level = user.target;
+			user.lastChangeMs = nowMs;
+			++changes;
+		}
+	}
+
+	//then the largest users step up, a few per update to spread the sdk calls over frames
+	std::vector<std::pair<float, size_t> > ups;
+	for (size_t i = 0; i < users.size(); ++i)
+	{
+		if (users[i]->second.target > users[i]->second.level)
+			ups.push_back(std::make_pair(-users[i]->second.demand, i));
+	}
+	std::sort(ups.begin(), ups.end());
+	unsigned int upgrades = 0;
+	for (size_t i = 0; i < ups.size() && upgrades < m_nMaxChangesPerUpdate; ++i)
+	{
+		UserMap::iterator iter = users[ups[i].second];
+		LODUser& user = iter->second;
+		SDKError err = 0 == user.level ? manager.Subscribe(iter->first, s_lodResolutions[user.target]) : manager.SetResolution(iter->first, s_lodResolutions[user.target]);
+		if (SDKERR_SUCCESS == err)
+		{
+			user.level = user.target;
+			user.lastChangeMs = nowMs;
+			user.retryMs = 0;
+			user.retryDelayMs = LOD_RETRY_MIN_MS;
+			++changes;
+		}
+		else
+		{
+			user.retryMs = nowMs + user.retryDelayMs;
+			user.retryDelayMs = user.retryDelayMs * 2 > LOD_RETRY_MAX_MS ? LOD_RETRY_MAX_MS : user.retryDelayMs * 2;
+		}
+		++upgrades;
+	}
+
+	m_nUsedPixels = 0;
+	UserMap::iterator iter = m_users.begin();
+	while (iter != m_users.end())
+	{
+		if (iter->second.bRemoved && 0 == iter->second.level)
+		{
+			iter = m_users.erase(iter);
+			continue;
+		}
+		m_nUsedPixels += s_lodPixels[iter->second.level];
+		++iter;
+	}
+	return changes;
+}
+END_ZOOM_SDK_NAMESPACE
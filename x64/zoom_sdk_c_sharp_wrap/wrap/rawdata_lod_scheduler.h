@@ -0,0 +1,82 @@
+#pragma once
+#include "rawdata_renderer_manager.h"
+#include <map>
+#include <vector>
+BEGIN_ZOOM_SDK_NAMESPACE
+//Picks a raw video resolution for every user from how large the host app draws them, and drives the
+//subscriptions of a CRawDataRendererManager to match.
+//- A user's demand is the height in screen pixels their video covers. It is given directly or derived from
+//  the distance to the viewer.
+//- Hysteresis: a user only moves up a level once the demand clears the threshold by the margin, and only
+//  moves down once it falls below by the margin. Changes are also held for a minimum time, so someone
+//  hovering at a threshold does not flip between resolutions.
+//- Budget: the sum of subscribed pixels and the number of subscriptions are capped. Over budget, the
+//  smallest users are stepped down first, and current holders of a level get the margin as a bonus.
+//- A subscription the sdk refuses is retried after a delay that doubles with every failure, users who left
+//  the meeting are dropped as soon as OnUserLeft() reports them.
+//Call everything but OnUserLeft() from the manager's control thread.
+class CRawDataLODScheduler
+{
+public:
+	static CRawDataLODScheduler& GetInst();
+
+	//budgetPixels is the sum of width * height over all subscriptions
+	void SetBudget(unsigned int budgetPixels, unsigned int maxSubscriptions);
+	//margin is a fraction of the threshold (0.15 = 15%), holdMs the minimum time between two changes of a user
+	void SetHysteresis(float margin, unsigned int holdMs);
+	//demand below minPixels unsubscribes the user. At most maxChangesPerUpdate upgrades are made per Update().
+	void SetLimits(float minPixels, unsigned int maxChangesPerUpdate);
+	//screen height in pixels that a user one distance unit away covers, used by SetUserDistance()
+	void SetDistanceReference(float pixelsAtUnitDistance);
+
+	void SetUserScreenSize(uint32_t userId, float pixels);
+	//distance <= 0 means the user is not visible
+	void SetUserDistance(uint32_t userId, float distance);
+	//unsubscribes the user on the next Update()
+	void RemoveUser(uint32_t userId);
+	void RemoveAllUsers();
+	//any thread, the sdk's onUserLeft. The users are removed on the next Update().
+	void OnUserLeft(IList<unsigned int>* lstUserID);
+
+	//applies the levels to manager, returns how many subscriptions changed
+	unsigned int Update(CRawDataRendererManager& manager);
+	unsigned int Update(CRawDataRendererManager& manager, long long nowMs);
+
+	//ZoomSDKResolution_NoUse when the user is not subscribed
+	ZoomSDKResolution GetUserResolution(uint32_t userId) const;
+	unsigned int GetUsedPixels() const { return m_nUsedPixels; }
+
+private:
+	CRawDataLODScheduler();
+	CRawDataLODScheduler(const CRawDataLODScheduler&);
+	CRawDataLODScheduler& operator=(const CRawDataLODScheduler&);
+
+	struct LODUser
+	{
+		float demand;
+		int level;///<0 is unsubscribed, 1 to 5 are 90P to 1080P
+		int target;
+		long long lastChangeMs;
+		long long retryMs;///<No subscribing or stepping up before this time after a failure.
+		unsigned int retryDelayMs;
+		bool bRemoved;
+	};
+	typedef std::map<uint32_t, LODUser> UserMap;
+
+	int GetLevelFor(float demand) const;
+	int GetHysteresisLevel(const LODUser& user, long long nowMs) const;
+	void ApplyBudget(std::vector<UserMap::iterator>& users);
+
+	UserMap m_users;
+	CMediaLock m_leftLock;///<guards m_left, which the sdk thread fills
+	std::vector<uint32_t> m_left;
+	unsigned int m_nBudgetPixels;
+	unsigned int m_nMaxSubscriptions;
+	unsigned int m_nMaxChangesPerUpdate;
+	unsigned int m_nHoldMs;
+	unsigned int m_nUsedPixels;
+	float m_fMargin;
+	float m_fMinPixels;
+	float m_fPixelsAtUnitDistance;
+};
+END_ZOOM_SDK_NAMESPACE
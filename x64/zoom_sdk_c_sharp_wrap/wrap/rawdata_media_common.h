@@ -0,0 +1,452 @@
+#pragma once
+#ifdef _WIN32
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+//POSIX builds, e.g. fixture replay on Linux, get the few Win32 types used by the media code and by the sdk
+//headers. The sdk headers also include <tchar.h>, add wrap/posix to the include path for that one.
+typedef int32_t LONG;
+typedef uint32_t ULONG;
+typedef int64_t LONGLONG;
+typedef uint64_t UINT64;
+typedef void* HWND;
+typedef struct tagRECT
+{
+	LONG left;
+	LONG top;
+	LONG right;
+	LONG bottom;
+}RECT;
+#endif
+#include <stdio.h>
+#include <string.h>
+
+//SIMD kernels are built for their instruction set one function at a time, so everything else keeps the
+//baseline target and the runtime dispatch stays safe. MSVC needs no attribute for that.
+#ifdef _MSC_VER
+#define MEDIA_TARGET_SSE41
+#define MEDIA_TARGET_AVX2
+#else
+#define MEDIA_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define MEDIA_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+//the raw data media helpers only need the namespace macros, not the whole sdk header set.
+#ifndef BEGIN_ZOOM_SDK_NAMESPACE
+#define ZOOM_SDK_NAMESPACE ZOOMSDK
+#define BEGIN_ZOOM_SDK_NAMESPACE namespace ZOOM_SDK_NAMESPACE {
+#define END_ZOOM_SDK_NAMESPACE };
+#endif
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//Synchronization helpers for the raw data media path. They are built on Win32 primitives on purpose:
+//these headers are included from /clr translation units, where <atomic> and <mutex> are rejected.
+#ifdef _WIN32
+inline LONG MediaAtomicLoad(LONG const volatile* p)
+{
+	return ReadAcquire(p);
+}
+
+inline void MediaAtomicStore(LONG volatile* p, LONG value)
+{
+	WriteRelease(p, value);
+}
+
+inline LONG MediaAtomicExchange(LONG volatile* p, LONG value)
+{
+	return InterlockedExchange(p, value);
+}
+
+//stores value when *p is comparand, returns what *p held before
+inline LONG MediaAtomicCompareExchange(LONG volatile* p, LONG value, LONG comparand)
+{
+	return InterlockedCompareExchange(p, value, comparand);
+}
+
+inline LONG MediaAtomicIncrement(LONG volatile* p)
+{
+	return InterlockedIncrement(p);
+}
+
+inline LONG MediaAtomicDecrement(LONG volatile* p)
+{
+	return InterlockedDecrement(p);
+}
+
+inline LONGLONG MediaAtomicLoad64(LONGLONG const volatile* p)
+{
+	return ReadAcquire64(p);
+}
+
+inline void MediaAtomicStore64(LONGLONG volatile* p, LONGLONG value)
+{
+	InterlockedExchange64(p, value);
+}
+
+inline LONGLONG MediaAtomicIncrement64(LONGLONG volatile* p)
+{
+	return InterlockedIncrement64(p);
+}
+
+class CMediaLock
+{
+public:
+	CMediaLock() { InitializeSRWLock(&m_lock); }
+	void Lock() { AcquireSRWLockExclusive(&m_lock); }
+	void Unlock() { ReleaseSRWLockExclusive(&m_lock); }
+	void LockShared() { AcquireSRWLockShared(&m_lock); }
+	void UnlockShared() { ReleaseSRWLockShared(&m_lock); }
+private:
+	CMediaLock(const CMediaLock&);
+	CMediaLock& operator=(const CMediaLock&);
+	SRWLOCK m_lock;
+};
+#else
+inline LONG MediaAtomicLoad(LONG const volatile* p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline void MediaAtomicStore(LONG volatile* p, LONG value)
+{
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+inline LONG MediaAtomicExchange(LONG volatile* p, LONG value)
+{
+	return __atomic_exchange_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+inline LONG MediaAtomicCompareExchange(LONG volatile* p, LONG value, LONG comparand)
+{
+	__atomic_compare_exchange_n(p, &comparand, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	return comparand;
+}
+
+inline LONG MediaAtomicIncrement(LONG volatile* p)
+{
+	return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONG MediaAtomicDecrement(LONG volatile* p)
+{
+	return __atomic_sub_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+inline LONGLONG MediaAtomicLoad64(LONGLONG const volatile* p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline void MediaAtomicStore64(LONGLONG volatile* p, LONGLONG value)
+{
+	__atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+inline LONGLONG MediaAtomicIncrement64(LONGLONG volatile* p)
+{
+	return __atomic_add_fetch(p, 1, __ATOMIC_SEQ_CST);
+}
+
+class CMediaLock
+{
+public:
+	CMediaLock() { pthread_rwlock_init(&m_lock, NULL); }
+	~CMediaLock() { pthread_rwlock_destroy(&m_lock); }
+	void Lock() { pthread_rwlock_wrlock(&m_lock); }
+	void Unlock() { pthread_rwlock_unlock(&m_lock); }
+	void LockShared() { pthread_rwlock_rdlock(&m_lock); }
+	void UnlockShared() { pthread_rwlock_unlock(&m_lock); }
+private:
+	CMediaLock(const CMediaLock&);
+	CMediaLock& operator=(const CMediaLock&);
+	pthread_rwlock_t m_lock;
+};
+#endif
+
+class CMediaAutoLock
+{
+public:
+	CMediaAutoLock(CMediaLock& lock, bool bShared = false) : m_lock(lock), m_bShared(bShared)
+	{
+		if (m_bShared)
+			m_lock.LockShared();
+		else
+			m_lock.Lock();
+	}
+	~CMediaAutoLock()
+	{
+		if (m_bShared)
+			m_lock.UnlockShared();
+		else
+			m_lock.Unlock();
+	}
+private:
+	CMediaAutoLock(const CMediaAutoLock&);
+	CMediaAutoLock& operator=(const CMediaAutoLock&);
+	CMediaLock& m_lock;
+	bool m_bShared;
+};
+
+//floats shared between threads are kept as their bits, so every value is read whole
+inline float MediaAtomicLoadFloat(LONG const volatile* p)
+{
+	LONG bits = MediaAtomicLoad(p);
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+inline void MediaAtomicStoreFloat(LONG volatile* p, float value)
+{
+	LONG bits;
+	memcpy(&bits, &value, sizeof(bits));
+	MediaAtomicStore(p, bits);
+}
+
+//monotonic clock in microseconds
+inline long long MediaGetTimeUs()
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq = { 0 };
+	if (0 == freq.QuadPart)
+		QueryPerformanceFrequency(&freq);
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	return (long long)(now.QuadPart / freq.QuadPart) * 1000000LL + (long long)((now.QuadPart % freq.QuadPart) * 1000000LL / freq.QuadPart);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec * 1000000LL + now.tv_nsec / 1000;
+#endif
+}
+
+inline void MediaSleepMs(unsigned int ms)
+{
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	struct timespec span;
+	span.tv_sec = ms / 1000;
+	span.tv_nsec = (long)(ms % 1000) * 1000000L;
+	nanosleep(&span, NULL);
+#endif
+}
+
+//logical processors, for sizing worker pools
+inline unsigned int MediaGetCpuCount()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (unsigned int)info.dwNumberOfProcessors : 1;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (unsigned int)count : 1;
+#endif
+}
+
+//fopen, without the MSVC deprecation warning. NULL when the file can't be opened.
+inline FILE* MediaOpenFile(const char* path, const char* mode)
+{
+#ifdef _WIN32
+	FILE* pFile = NULL;
+	return 0 == fopen_s(&pFile, path, mode) ? pFile : NULL;
+#else
+	return fopen(path, mode);
+#endif
+}
+
+//Auto-reset event for waking a worker thread.
+class CMediaEvent
+{
+public:
+#ifdef _WIN32
+	CMediaEvent() { m_hEvent = CreateEventW(NULL, FALSE, FALSE, NULL); }
+	~CMediaEvent() { if (m_hEvent) CloseHandle(m_hEvent); }
+	void Set() { SetEvent(m_hEvent); }
+	//true when the event was set, false on timeout
+	bool Wait(unsigned int timeoutMs) { return WAIT_OBJECT_0 == WaitForSingleObject(m_hEvent, timeoutMs); }
+#else
+	CMediaEvent() : m_bSignaled(false)
+	{
+		pthread_mutex_init(&m_mutex, NULL);
+		pthread_cond_init(&m_cond, NULL);
+	}
+	~CMediaEvent()
+	{
+		pthread_cond_destroy(&m_cond);
+		pthread_mutex_destroy(&m_mutex);
+	}
+	void Set()
+	{
+		pthread_mutex_lock(&m_mutex);
+		m_bSignaled = true;
+		pthread_cond_signal(&m_cond);
+		pthread_mutex_unlock(&m_mutex);
+	}
+	bool Wait(unsigned int timeoutMs)
+	{
+		struct timespec until;
+		clock_gettime(CLOCK_REALTIME, &until);
+		until.tv_sec += timeoutMs / 1000;
+		until.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+		if (until.tv_nsec >= 1000000000L)
+		{
+			until.tv_sec += 1;
+			until.tv_nsec -= 1000000000L;
+		}
+		pthread_mutex_lock(&m_mutex);
+		while (!m_bSignaled && 0 == pthread_cond_timedwait(&m_cond, &m_mutex, &until))
+			;
+		bool bSignaled = m_bSignaled;
+		m_bSignaled = false;
+		pthread_mutex_unlock(&m_mutex);
+		return bSignaled;
+	}
+#endif
+private:
+	CMediaEvent(const CMediaEvent&);
+	CMediaEvent& operator=(const CMediaEvent&);
+#ifdef _WIN32
+	HANDLE m_hEvent;
+#else
+	pthread_mutex_t m_mutex;
+	pthread_cond_t m_cond;
+	bool m_bSignaled;
+#endif
+};
+
+typedef void(*MediaThreadProc)(void* pParam);
+
+//Native worker thread. The media translation units are built without /clr, so the thread never runs managed code.
+class CMediaThread
+{
+public:
+	CMediaThread() : m_proc(NULL), m_pParam(NULL), m_bStarted(false) {}
+	~CMediaThread() { Join(); }
+
+	bool Start(MediaThreadProc proc, void* pParam)
+	{
+		if (m_bStarted || NULL == proc)
+			return false;
+		m_proc = proc;
+		m_pParam = pParam;
+#ifdef _WIN32
+		m_hThread = CreateThread(NULL, 0, ThreadProc, this, 0, NULL);
+		m_bStarted = NULL != m_hThread;
+#else
+		m_bStarted = 0 == pthread_create(&m_thread, NULL, ThreadProc, this);
+#endif
+		return m_bStarted;
+	}
+	//waits for the thread function to return, the caller has to tell it to stop first
+	void Join()
+	{
+		if (!m_bStarted)
+			return;
+#ifdef _WIN32
+		WaitForSingleObject(m_hThread, INFINITE);
+		CloseHandle(m_hThread);
+		m_hThread = NULL;
+#else
+		pthread_join(m_thread, NULL);
+#endif
+		m_bStarted = false;
+	}
+	bool IsStarted() const { return m_bStarted; }
+
+private:
+	CMediaThread(const CMediaThread&);
+	CMediaThread& operator=(const CMediaThread&);
+#ifdef _WIN32
+	static DWORD WINAPI ThreadProc(LPVOID pParam)
+	{
+		CMediaThread* pThis = (CMediaThread*)pParam;
+		pThis->m_proc(pThis->m_pParam);
+		return 0;
+	}
+	HANDLE m_hThread;
+#else
+	static void* ThreadProc(void* pParam)
+	{
+		CMediaThread* pThis = (CMediaThread*)pParam;
+		pThis->m_proc(pThis->m_pParam);
+		return NULL;
+	}
+	pthread_t m_thread;
+#endif
+	MediaThreadProc m_proc;
+	void* m_pParam;
+	bool m_bStarted;
+};
+
+inline void* MediaAlignedMalloc(size_t size, size_t alignment)
+{
+#ifdef _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	void* p = NULL;
+	return 0 == posix_memalign(&p, alignment, size) ? p : NULL;
+#endif
+}
+
+inline void MediaAlignedFree(void* p)
+{
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+#define MEDIA_BUFFER_ALIGNMENT 32
+
+//Growable byte buffer aligned for the SIMD kernels. It never shrinks, so a steady stream of
+//same-sized frames does not allocate after the first one.
+class CMediaBuffer
+{
+public:
+	CMediaBuffer() : m_pData(NULL), m_nCapacity(0), m_nSize(0) {}
+	~CMediaBuffer() { Free(); }
+
+	bool Resize(size_t size)
+	{
+		if (size > m_nCapacity)
+		{
+			unsigned char* pData = (unsigned char*)MediaAlignedMalloc(size, MEDIA_BUFFER_ALIGNMENT);
+			if (NULL == pData)
+				return false;
+			if (m_pData)
+				MediaAlignedFree(m_pData);
+			m_pData = pData;
+			m_nCapacity = size;
+		}
+		m_nSize = size;
+		return true;
+	}
+	void Free()
+	{
+		if (m_pData)
+			MediaAlignedFree(m_pData);
+		m_pData = NULL;
+		m_nCapacity = 0;
+		m_nSize = 0;
+	}
+	unsigned char* GetData() { return m_pData; }
+	const unsigned char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_nSize; }
+private:
+	CMediaBuffer(const CMediaBuffer&);
+	CMediaBuffer& operator=(const CMediaBuffer&);
+	unsigned char* m_pData;
+	size_t m_nCapacity;
+	size_t m_nSize;
+};
+END_ZOOM_SDK_NAMESPACE
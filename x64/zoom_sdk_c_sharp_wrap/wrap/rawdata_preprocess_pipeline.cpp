@@ -0,0 +1,173 @@
+#include "rawdata_preprocess_pipeline.h"
+#include <algorithm>
+BEGIN_ZOOM_SDK_NAMESPACE
+//bands smaller than this cost more in wake-ups than they save
+#define PREPROCESS_MIN_BAND_ROWS 32
+
+CRawDataPreprocessPipeline& CRawDataPreprocessPipeline::GetInst()
+{
+	static CRawDataPreprocessPipeline inst;
+	return inst;
+}
+
+CRawDataPreprocessPipeline::CRawDataPreprocessPipeline()
+{
+	for (int i = 0; i < PREPROCESS_MAX_WORKERS; ++i)
+	{
+		m_workers[i].pOwner = this;
+		m_workers[i].band = i + 1;
+	}
+	m_nWorkers = 0;
+	m_bStarted = false;
+	m_bQuit = 0;
+	m_nPending = 0;
+	m_nBandRows = 0;
+	m_nLastFrameUs = 0;
+	m_nFrames = 0;
+}
+
+CRawDataPreprocessPipeline::~CRawDataPreprocessPipeline()
+{
+	Stop();
+}
+
+bool CRawDataPreprocessPipeline::Start(unsigned int workers)
+{
+	CMediaAutoLock lock(m_lock);
+	if (m_bStarted)
+		return true;
+	if (0 == workers)
+		workers = MediaGetCpuCount() - 1;
+	if (workers > PREPROCESS_MAX_WORKERS)
+		workers = PREPROCESS_MAX_WORKERS;
+
+	MediaAtomicStore(&m_bQuit, 0);
+	m_nWorkers = 0;
+	for (unsigned int i = 0; i < workers; ++i)
+	{
+		//a worker that quit on its timeout may have left the stop signal behind
+		m_workers[i].start.Wait(0);
+		//fewer workers than asked for only means wider bands
+		if (!m_workers[i].thread.Start(WorkerProc, &m_workers[i]))
+			break;
+		++m_nWorkers;
+	}
+	//none at all means no thread can be created
+	if (workers > 0 && 0 == m_nWorkers)
+		return false;
+	m_bStarted = true;
+	return true;
+}
+
+void CRawDataPreprocessPipeline::Stop()
+{
+	//waits for a frame in progress
+	CMediaAutoLock lock(m_lock);
+	if (!m_bStarted)
+		return;
+	MediaAtomicStore(&m_bQuit, 1);
+	for (unsigned int i = 0; i < m_nWorkers; ++i)
+		m_workers[i].start.Set();
+	for (unsigned int i = 0; i < m_nWorkers; ++i)
+		m_workers[i].thread.Join();
+	m_nWorkers = 0;
+	m_bStarted = false;
+}
+
+void CRawDataPreprocessPipeline::AddFilter(IRawDataVideoFilter* pFilter)
+{
+	if (NULL == pFilter)
+		return;
+	CMediaAutoLock lock(m_lock);
+	if (m_filters.end() == std::find(m_filters.begin(), m_filters.end(), pFilter))
+		m_filters.push_back(pFilter);
+}
+
+void CRawDataPreprocessPipeline::RemoveFilter(IRawDataVideoFilter* pFilter)
+{
+	CMediaAutoLock lock(m_lock);
+	std::vector<IRawDataVideoFilter*>::iterator iter = std::find(m_filters.begin(), m_filters.end(), pFilter);
+	if (m_filters.end() != iter)
+		m_filters.erase(iter);
+}
+
+void CRawDataPreprocessPipeline::RemoveAllFilters()
+{
+	CMediaAutoLock lock(m_lock);
+	m_filters.clear();
+}
+
+void CRawDataPreprocessPipeline::WorkerProc(void* pParam)
+{
+	PreprocessWorker* pWorker = (PreprocessWorker*)pParam;
+	CRawDataPreprocessPipeline* pOwner = pWorker->pOwner;
+	while (0 == MediaAtomicLoad(&pOwner->m_bQuit))
+	{
+		if (!pWorker->start.Wait(100) || 0 != MediaAtomicLoad(&pOwner->m_bQuit))
+			continue;
+		pOwner->ProcessBand(pWorker->band);
+		if (0 == MediaAtomicDecrement(&pOwner->m_nPending))
+			pOwner->m_done.Set();
+	}
+}
+
+void CRawDataPreprocessPipeline::ProcessBand(unsigned int band)
+{
+	unsigned int yBegin = band * m_nBandRows;
+	unsigned int yEnd = yBegin + m_nBandRows < m_frame.height ? yBegin + m_nBandRows : m_frame.height;
+	for (std::vector<IRawDataVideoFilter*>::iterator iter = m_active.begin(); iter != m_active.end(); ++iter)
+		(*iter)->Process(m_frame, yBegin, yEnd);
+}
+
+void CRawDataPreprocessPipeline::ProcessFrame(const I420MutableView& frame)
+{
+	if (NULL == frame.pY || NULL == frame.pU || NULL == frame.pV || 0 == frame.width || 0 == frame.height)
+		return;
+
+	long long startUs = MediaGetTimeUs();
+	CMediaAutoLock lock(m_lock, true);
+	m_active.clear();
+	for (std::vector<IRawDataVideoFilter*>::iterator iter = m_filters.begin(); iter != m_filters.end(); ++iter)
+	{
+		if ((*iter)->Prepare(frame))
+			m_active.push_back(*iter);
+	}
+
+	if (!m_active.empty())
+	{
+		m_frame = frame;
+		unsigned int bands = m_nWorkers + 1;
+		m_nBandRows = ((frame.height + bands - 1) / bands + 1) & ~1u;
+		if (m_nBandRows < PREPROCESS_MIN_BAND_ROWS)
+			m_nBandRows = PREPROCESS_MIN_BAND_ROWS;
+		bands = (frame.height + m_nBandRows - 1) / m_nBandRows;
+
+		MediaAtomicStore(&m_nPending, (LONG)(bands - 1));
+		for (unsigned int i = 0; i + 1 < bands; ++i)
+			m_workers[i].start.Set();
+		ProcessBand(0);
+		while (MediaAtomicLoad(&m_nPending) > 0)
+			m_done.Wait(10);
+	}
+
+	MediaAtomicStore64(&m_nLastFrameUs, MediaGetTimeUs() - startUs);
+	MediaAtomicIncrement64(&m_nFrames);
+}
+
+void CRawDataPreprocessPipeline::onPreProcessRawData(YUVProcessDataI420* rawData)
+{
+	if (NULL == rawData)
+		return;
+	I420MutableView frame;
+	frame.pY = (unsigned char*)rawData->GetYBuffer(0);
+	frame.pU = (unsigned char*)rawData->GetUBuffer(0);
+	frame.pV = (unsigned char*)rawData->GetVBuffer(0);
+	frame.yStride = rawData->GetYStride();
+	frame.uStride = rawData->GetUStride();
+	frame.vStride = rawData->GetVStride();
+	frame.width = rawData->GetWidth();
+	frame.height = rawData->GetHeight();
+	frame.bLimited = rawData->IsLimitedI420();
+	ProcessFrame(frame);
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,111 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "zoom_sdk_def.h"
+#include "zoom_sdk_raw_data_def.h"
+#include "rawdata/rawdata_video_source_helper_interface.h"
+#include <vector>
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//Writable view of an I420 frame, built from YUVProcessDataI420 with its own per-plane strides.
+struct I420MutableView
+{
+	unsigned char* pY;
+	unsigned char* pU;
+	unsigned char* pV;
+	unsigned int yStride;
+	unsigned int uStride;
+	unsigned int vStride;
+	unsigned int width;
+	unsigned int height;
+	bool bLimited;///<BT.601 limited (16-235) range when true, full range otherwise.
+
+	I420MutableView()
+	{
+		pY = NULL;
+		pU = NULL;
+		pV = NULL;
+		yStride = 0;
+		uStride = 0;
+		vStride = 0;
+		width = 0;
+		height = 0;
+		bLimited = true;
+	}
+};
+
+//A filter that works in place on the outgoing camera frame.
+//The pipeline splits the frame into bands of rows and runs them on several threads at once, so Process() may only
+//read and write the rows it is given: luma rows [yBegin, yEnd) and chroma rows [yBegin / 2, (yEnd + 1) / 2).
+//yBegin is always even.
+class IRawDataVideoFilter
+{
+public:
+	virtual ~IRawDataVideoFilter(){}
+	//called once per frame on the sdk thread before any band, to pick up new settings or rebuild tables.
+	//Returning false skips the filter for this frame, e.g. when it is disabled or would not change anything.
+	virtual bool Prepare(const I420MutableView& frame) = 0;
+	virtual void Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd) = 0;
+};
+
+#define PREPROCESS_MAX_WORKERS 7
+
+//Runs a chain of IRawDataVideoFilter on every frame the camera sends, as the IZoomSDKPreProcessor registered with
+//IZoomSDKVideoSourceHelperWrap::setPreProcessor(). The sdk waits for onPreProcessRawData() before sending, so the
+//frame is cut into bands that the worker threads and the sdk thread filter together, keeping 720p and 1080p
+//within the camera frame interval. Filters run band by band, so a band is still in cache for the next filter.
+//Filters are not owned and must outlive their registration.
+class CRawDataPreprocessPipeline : public IZoomSDKPreProcessor
+{
+public:
+	static CRawDataPreprocessPipeline& GetInst();
+	~CRawDataPreprocessPipeline();
+
+	//workers besides the sdk thread, 0 picks one less than the processor count. Fails when none of them starts.
+	bool Start(unsigned int workers = 0);
+	void Stop();
+	bool IsStarted() const { return m_bStarted; }
+
+	void AddFilter(IRawDataVideoFilter* pFilter);
+	void RemoveFilter(IRawDataVideoFilter* pFilter);
+	void RemoveAllFilters();
+
+	//time the last frame spent in the filters, in microseconds
+	long long GetLastFrameUs() const { return (long long)MediaAtomicLoad64(&m_nLastFrameUs); }
+	unsigned long long GetFrameCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nFrames); }
+
+	//filters a frame right away, also usable without the sdk. One frame at a time: frames come from a single sdk thread.
+	void ProcessFrame(const I420MutableView& frame);
+	virtual void onPreProcessRawData(YUVProcessDataI420* rawData);
+
+private:
+	CRawDataPreprocessPipeline();
+	CRawDataPreprocessPipeline(const CRawDataPreprocessPipeline&);
+	CRawDataPreprocessPipeline& operator=(const CRawDataPreprocessPipeline&);
+
+	typedef struct tagPreprocessWorker
+	{
+		CRawDataPreprocessPipeline* pOwner;
+		unsigned int band;
+		CMediaThread thread;
+		CMediaEvent start;
+	}PreprocessWorker;
+
+	static void WorkerProc(void* pParam);
+	void ProcessBand(unsigned int band);
+
+	PreprocessWorker m_workers[PREPROCESS_MAX_WORKERS];
+	unsigned int m_nWorkers;
+	bool m_bStarted;
+	volatile LONG m_bQuit;
+	volatile LONG m_nPending;///<Bands of the current frame the workers have not finished yet.
+	CMediaEvent m_done;
+
+	CMediaLock m_lock;///<Guards the filter list, held shared while a frame is filtered.
+	std::vector<IRawDataVideoFilter*> m_filters;
+	std::vector<IRawDataVideoFilter*> m_active;///<Filters whose Prepare() accepted the current frame.
+	I420MutableView m_frame;///<Frame being filtered, read by the workers.
+	unsigned int m_nBandRows;
+	volatile LONGLONG m_nLastFrameUs;
+	volatile LONGLONG m_nFrames;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,436 @@
+#include "rawdata_renderer_manager.h"
+#include "rawdata_yuv_converter.h"
+#include "rawdata_fixture.h"
+#include <new>
+BEGIN_ZOOM_SDK_NAMESPACE
+CRawDataRendererSlot::CRawDataRendererSlot()
+{
+	m_pRenderer = NULL;
+	m_nUserId = 0;
+	m_nType = RAW_DATA_TYPE_VIDEO;
+	m_resolution = ZoomSDKResolution_NoUse;
+	m_nStatus = RawData_Off;
+	m_nDestroyed = 0;
+}
+
+CRawDataRendererSlot::~CRawDataRendererSlot()
+{
+	Destroy();
+}
+
+SDKError CRawDataRendererSlot::Create(FrameRingMode mode, unsigned int capacity)
+{
+	if (!m_frameRing.Init(mode, capacity))
+		return SDKERR_MEMORY_FAILED;
+
+	IZoomSDKRenderer* pRenderer(NULL);
+	SDKError err = CSDKImpl::GetInst().createRenderer(&pRenderer, this);
+	if (SDKERR_SUCCESS != err || NULL == pRenderer)
+	{
+		m_frameRing.Uninit();
+		return SDKERR_SUCCESS == err ? SDKERR_UNKNOWN : err;
+	}
+
+	CMediaAutoLock lock(m_lock);
+	m_pRenderer = pRenderer;
+	return SDKERR_SUCCESS;
+}
+
+void CRawDataRendererSlot::Destroy()
+{
+	IZoomSDKRenderer* pRenderer(NULL);
+	{
+		CMediaAutoLock lock(m_lock);
+		pRenderer = m_pRenderer;
+		m_pRenderer = NULL;
+	}
+	//the sdk may report onRendererBeDestroyed from inside destroyRenderer, so the lock is not held here
+	if (pRenderer && !IsDestroyed())
+	{
+		pRenderer->unSubscribe();
+		CSDKImpl::GetInst().destroyRenderer(pRenderer);
+	}
+	m_frameRing.Uninit();
+}
+
+SDKError CRawDataRendererSlot::Attach(uint32_t userId, ZoomSDKResolution resolution, ZoomSDKRawDataType type)
+{
+	CMediaAutoLock lock(m_lock);
+	if (NULL == m_pRenderer)
+		return SDKERR_UNINITIALIZE;
+
+	//frames left over from the previous user must not show up as the new one. The consumer may be reading
+	//the ring on another thread, so it drops them itself.
+	MediaAtomicStore(&m_nUserId, (LONG)userId);
+	MediaAtomicStore(&m_nType, (LONG)type);
+	m_frameRing.SetUserId(userId);
+	m_frameRing.Discard();
+	if (resolution != m_resolution)
+	{
+		SDKError err = m_pRenderer->setRawDataResolution(resolution);
+		if (SDKERR_SUCCESS != err)
+			return err;
+		m_resolution = resolution;
+	}
+	return m_pRenderer->subscribe(userId, type);
+}
+
+void CRawDataRendererSlot::Detach()
+{
+	{
+		CMediaAutoLock lock(m_lock);
+		if (m_pRenderer)
+			m_pRenderer->unSubscribe();
+	}
+	MediaAtomicStore(&m_nStatus, RawData_Off);
+	m_frameRing.Discard();
+	MediaAtomicStore(&m_nUserId, 0);
+}
+
+ZoomSDKResolution CRawDataRendererSlot::GetResolution()
+{
+	CMediaAutoLock lock(m_lock);
+	if (NULL == m_pRenderer)
+		return ZoomSDKResolution_NoUse;
+	return m_pRenderer->getResolution();
+}
+
+void CRawDataRendererSlot::onRendererBeDestroyed()
+{
+	MediaAtomicStore(&m_nDestroyed, 1);
+	MediaAtomicStore(&m_nStatus, RawData_Off);
+	CMediaAutoLock lock(m_lock);
+	m_pRenderer = NULL;
+}
+
+void CRawDataRendererSlot::onRawDataFrameReceived(YUVRawDataI420* data)
+{
+	CRawDataFixtureWriter::GetInst().WriteVideo(GetUserId(), data, RAW_DATA_TYPE_SHARE == MediaAtomicLoad(&m_nType));
+	m_frameRing.PushFrame(data);
+}
+
+void CRawDataRendererSlot::onRawDataStatusChanged(RawDataStatus status)
+{
+	MediaAtomicStore(&m_nStatus, (LONG)status);
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataRendererManager::CRawDataRendererManager()
+{
+	m_mode = FrameRingMode_LatestWins;
+	m_nRingCapacity = 4;
+	m_nMaxPooled = 16;
+	m_bInited = false;
+}
+
+CRawDataRendererManager::~CRawDataRendererManager()
+{
+	Uninit();
+}
+
+CRawDataRendererManager& CRawDataRendererManager::GetInst()
+{
+	static CRawDataRendererManager inst;
+	return inst;
+}
+
+SDKError CRawDataRendererManager::Init(FrameRingMode mode, unsigned int warmCount, unsigned int maxPooled, unsigned int ringCapacity)
+{
+	if (m_bInited)
+		return SDKERR_WRONG_USAGE;
+	m_mode = mode;
+	m_nRingCapacity = ringCapacity;
+	m_nMaxPooled = maxPooled < warmCount ? warmCount : maxPooled;
+	m_bInited = true;
+	return Prewarm(warmCount);
+}
+
+void CRawDataRendererManager::Uninit()
+{
+	if (!m_bInited)
+		return;
+
+	SlotMap active;
+	std::vector<CRawDataRendererSlot*> pool;
+	{
+		CMediaAutoLock lock(m_lock);
+		active.swap(m_active);
+		pool.swap(m_pool);
+	}
+	for (SlotMap::iterator iter = active.begin(); iter != active.end(); ++iter)
+		DeleteSlot(iter->second);
+	for (std::vector<CRawDataRendererSlot*>::iterator iter = pool.begin(); iter != pool.end(); ++iter)
+		DeleteSlot(*iter);
+	m_bInited = false;
+}
+
+SDKError CRawDataRendererManager::Prewarm(unsigned int count)
+{
+	if (!m_bInited)
+		return SDKERR_UNINITIALIZE;
+	ReapDestroyed();
+
+	while (GetPooledCount() < count)
+	{
+		CRawDataRendererSlot* pSlot = new (std::nothrow) CRawDataRendererSlot;
+		if (NULL == pSlot)
+			return SDKERR_MEMORY_FAILED;
+		SDKError err = pSlot->Create(m_mode, m_nRingCapacity);
+		if (SDKERR_SUCCESS != err)
+		{
+			delete pSlot;
+			return err;
+		}
+		CMediaAutoLock lock(m_lock);
+		m_pool.push_back(pSlot);
+	}
+	return SDKERR_SUCCESS;
+}
+
+SDKError CRawDataRendererManager::Subscribe(uint32_t userId, ZoomSDKResolution resolution)
+{
+	if (!m_bInited)
+		return SDKERR_UNINITIALIZE;
+	ReapDestroyed();
+
+	CRawDataRendererSlot* pSlot = GetSlot(userId);
+	if (pSlot)
+		return SetResolution(userId, resolution);
+
+	pSlot = TakeIdleSlot();
+	if (NULL == pSlot)
+	{
+		pSlot = new (std::nothrow) CRawDataRendererSlot;
+		if (NULL == pSlot)
+			return SDKERR_MEMORY_FAILED;
+		SDKError err = pSlot->Create(m_mode, m_nRingCapacity);
+		if (SDKERR_SUCCESS != err)
+		{
+			delete pSlot;
+			return err;
+		}
+	}
+
+	SDKError err = pSlot->Attach(userId, resolution);
+	if (SDKERR_SUCCESS != err)
+	{
+		RecycleSlot(pSlot);
+		return err;
+	}
+
+	CMediaAutoLock lock(m_lock);
+	m_active[userId] = pSlot;
+	return SDKERR_SUCCESS;
+}
+
+SDKError CRawDataRendererManager::Unsubscribe(uint32_t userId)
+{
+	if (!m_bInited)
+		return SDKERR_UNINITIALIZE;
+
+	CRawDataRendererSlot* pSlot(NULL);
+	{
+		CMediaAutoLock lock(m_lock);
+		SlotMap::iterator iter = m_active.find(userId);
+		if (iter == m_active.end())
+			return SDKERR_INVALID_PARAMETER;
+		pSlot = iter->second;
+		m_active.erase(iter);
+	}
+	RecycleSlot(pSlot);
+	ReapDestroyed();
+	return SDKERR_SUCCESS;
+}
+
+void CRawDataRendererManager::UnsubscribeAll()
+{
+	SlotMap active;
+	{
+		CMediaAutoLock lock(m_lock);
+		active.swap(m_active);
+	}
+	for (SlotMap::iterator iter = active.begin(); iter != active.end(); ++iter)
+		RecycleSlot(iter->second);
+}
+
+SDKError CRawDataRendererManager::SetResolution(uint32_t userId, ZoomSDKResolution resolution)
+{
+	CRawDataRendererSlot* pSlot = GetSlot(userId);
+	if (NULL == pSlot)
+		return SDKERR_INVALID_PARAMETER;
+
+	CMediaAutoLock lock(pSlot->m_lock);
+	if (NULL == pSlot->m_pRenderer)
+		return SDKERR_UNINITIALIZE;
+	if (resolution == pSlot->m_resolution)
+		return SDKERR_SUCCESS;
+	SDKError err = pSlot->m_pRenderer->setRawDataResolution(resolution);
+	if (SDKERR_SUCCESS == err)
+		pSlot->m_resolution = resolution;
+	return err;
+}
+
+bool CRawDataRendererManager::IsSubscribed(uint32_t userId)
+{
+	return NULL != GetSlot(userId);
+}
+
+CRawDataRendererSlot* CRawDataRendererManager::GetSlot(uint32_t userId)
+{
+	CMediaAutoLock lock(m_lock, true);
+	SlotMap::iterator iter = m_active.find(userId);
+	if (iter == m_active.end())
+		return NULL;
+	return iter->second;
+}
+
+const CRawDataFrame* CRawDataRendererManager::AcquireFrame(uint32_t userId)
+{
+	CRawDataRendererSlot* pSlot = GetSlot(userId);
+	if (NULL == pSlot)
+		return NULL;
+	return pSlot->GetFrameRing().AcquireFrame();
+}
+
+void CRawDataRendererManager::ReleaseFrame(uint32_t userId, const CRawDataFrame* pFrame)
+{
+	CRawDataRendererSlot* pSlot = GetSlot(userId);
+	if (pSlot)
+		pSlot->GetFrameRing().ReleaseFrame(pFrame);
+}
+
+bool CRawDataRendererManager::AcquireLease(uint32_t userId, RawDataFrameLease& lease)
+{
+	memset(&lease, 0, sizeof(lease));
+	const CRawDataFrame* pFrame = AcquireFrame(userId);
+	if (NULL == pFrame)
+		return false;
+
+	//user id and the low half of the sequence, so a handle can be checked without touching the frame
+	lease.handle = ((unsigned long long)userId << 32) | (pFrame->GetSequence() & 0xFFFFFFFF);
+	lease.sequence = pFrame->GetSequence();
+	lease.timestamp = pFrame->GetTimestamp();
+	lease.pY = pFrame->GetYBuffer();
+	lease.pU = pFrame->GetUBuffer();
+	lease.pV = pFrame->GetVBuffer();
+	lease.yStride = pFrame->GetYStride();
+	lease.uStride = pFrame->GetUVStride();
+	lease.vStride = pFrame->GetUVStride();
+	lease.width = pFrame->GetStreamWidth();
+	lease.height = pFrame->GetStreamHeight();
+	lease.rotation = RawDataRotationToDegrees(pFrame->GetRotation());
+	lease.format = pFrame->IsLimitedI420() ? RawDataFrameFormat_I420Limited : RawDataFrameFormat_I420Full;
+	lease.userId = userId;
+	return true;
+}
+
+void CRawDataRendererManager::ReleaseLease(unsigned long long handle)
+{
+	CRawDataRendererSlot* pSlot = GetSlot((uint32_t)(handle >> 32));
+	if (NULL == pSlot)
+		return;
+	CRawDataFrameRing& ring = pSlot->GetFrameRing();
+	const CRawDataFrame* pFrame = ring.GetAcquiredFrame();
+	if (pFrame && (pFrame->GetSequence() & 0xFFFFFFFF) == (handle & 0xFFFFFFFF))
+		ring.ReleaseFrame(pFrame);
+}
+
+unsigned int CRawDataRendererManager::GetSubscribedCount()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return (unsigned int)m_active.size();
+}
+
+unsigned int CRawDataRendererManager::GetPooledCount()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return (unsigned int)m_pool.size();
+}
+
+unsigned int CRawDataRendererManager::GetSubscribedUsers(uint32_t* pUserIds, unsigned int count)
+{
+	CMediaAutoLock lock(m_lock, true);
+	unsigned int index = 0;
+	for (SlotMap::iterator iter = m_active.begin(); iter != m_active.end() && index < count && pUserIds; ++iter)
+		pUserIds[index++] = iter->first;
+	return (unsigned int)m_active.size();
+}
+
+void CRawDataRendererManager::ReapDestroyed()
+{
+	std::vector<CRawDataRendererSlot*> dead;
+	{
+		CMediaAutoLock lock(m_lock);
+		SlotMap::iterator iter = m_active.begin();
+		while (iter != m_active.end())
+		{
+			if (iter->second->IsDestroyed())
+			{
+				dead.push_back(iter->second);
+				iter = m_active.erase(iter);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+		std::vector<CRawDataRendererSlot*>::iterator poolIter = m_pool.begin();
+		while (poolIter != m_pool.end())
+		{
+			if ((*poolIter)->IsDestroyed())
+			{
+				dead.push_back(*poolIter);
+				poolIter = m_pool.erase(poolIter);
+			}
+			else
+			{
+				++poolIter;
+			}
+		}
+	}
+	for (std::vector<CRawDataRendererSlot*>::iterator iter = dead.begin(); iter != dead.end(); ++iter)
+		DeleteSlot(*iter);
+}
+
+CRawDataRendererSlot* CRawDataRendererManager::TakeIdleSlot()
+{
+	CMediaAutoLock lock(m_lock);
+	while (!m_pool.empty())
+	{
+		CRawDataRendererSlot* pSlot = m_pool.back();
+		m_pool.pop_back();
+		if (!pSlot->IsDestroyed())
+			return pSlot;
+		//already gone on the sdk side, nothing to destroy but the slot itself
+		delete pSlot;
+	}
+	return NULL;
+}
+
+void CRawDataRendererManager::RecycleSlot(CRawDataRendererSlot* pSlot)
+{
+	if (NULL == pSlot)
+		return;
+	if (pSlot->IsDestroyed())
+	{
+		DeleteSlot(pSlot);
+		return;
+	}
+
+	pSlot->Detach();
+	{
+		CMediaAutoLock lock(m_lock);
+		if (m_pool.size() < m_nMaxPooled)
+		{
+			m_pool.push_back(pSlot);
+			return;
+		}
+	}
+	DeleteSlot(pSlot);
+}
+
+void CRawDataRendererManager::DeleteSlot(CRawDataRendererSlot* pSlot)
+{
+	if (pSlot)
+		delete pSlot;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,137 @@
+#pragma once
+#include "common_include.h"
+#include "rawdata_frame_ring.h"
+#include <map>
+#include <vector>
+BEGIN_ZOOM_SDK_NAMESPACE
+typedef enum
+{
+	RawDataFrameFormat_I420Limited,///<BT.601 limited (16-235) range I420.
+	RawDataFrameFormat_I420Full,///<BT.601 full range I420.
+}RawDataFrameFormat;
+
+//A frame lent to a caller outside the wrapper, e.g. C# through the dll exports. The layout is part of the
+//exported ABI: 8 byte fields first, so the struct has no padding on x64. Do not reorder.
+typedef struct tagRawDataFrameLease
+{
+	unsigned long long handle;///<Pass to ReleaseLease(). 0 when nothing is leased.
+	unsigned long long sequence;///<Per user counter, see CRawDataFrame::GetSequence().
+	long long timestamp;///<Arrival time in microseconds.
+	const unsigned char* pY;
+	const unsigned char* pU;
+	const unsigned char* pV;
+	unsigned int yStride;
+	unsigned int uStride;
+	unsigned int vStride;
+	unsigned int width;
+	unsigned int height;
+	unsigned int rotation;///<Clockwise rotation in degrees, 0/90/180/270.
+	unsigned int format;///<RawDataFrameFormat.
+	unsigned int userId;
+}RawDataFrameLease;
+
+//One pooled IZoomSDKRenderer. The slot is the renderer's delegate, so frames go straight into its own ring
+//and subscriptions never share a lock on the sdk thread. Frames are also recorded while
+//CRawDataFixtureWriter::GetInst() is open. Frames of a previous user are dropped by the ring's consumer,
+//a pooled slot keeps at most a ring's worth of them until it is attached and read again.
+class CRawDataRendererSlot : public IZoomSDKRendererDelegate
+{
+public:
+	CRawDataRendererSlot();
+	virtual ~CRawDataRendererSlot();
+
+	//the renderer is NULL once the sdk destroyed it, see IsDestroyed()
+	IZoomSDKRenderer* GetRenderer() { return m_pRenderer; }
+	CRawDataFrameRing& GetFrameRing() { return m_frameRing; }
+	uint32_t GetUserId() const { return (uint32_t)MediaAtomicLoad(&m_nUserId); }
+	RawDataStatus GetStatus() const { return (RawDataStatus)MediaAtomicLoad(&m_nStatus); }
+	bool IsDestroyed() const { return 0 != MediaAtomicLoad(&m_nDestroyed); }
+	//resolution reported by the renderer, ZoomSDKResolution_NoUse once it is destroyed
+	ZoomSDKResolution GetResolution();
+
+	virtual void onRendererBeDestroyed();
+	virtual void onRawDataFrameReceived(YUVRawDataI420* data);
+	virtual void onRawDataStatusChanged(RawDataStatus status);
+
+private:
+	friend class CRawDataRendererManager;
+	friend class CRawDataShareTileStream;
+	CRawDataRendererSlot(const CRawDataRendererSlot&);
+	CRawDataRendererSlot& operator=(const CRawDataRendererSlot&);
+	SDKError Create(FrameRingMode mode, unsigned int capacity);
+	void Destroy();
+	SDKError Attach(uint32_t userId, ZoomSDKResolution resolution, ZoomSDKRawDataType type = RAW_DATA_TYPE_VIDEO);
+	void Detach();
+
+	CMediaLock m_lock;///<guards m_pRenderer against onRendererBeDestroyed()
+	IZoomSDKRenderer* m_pRenderer;
+	CRawDataFrameRing m_frameRing;
+	volatile LONG m_nUserId;///<read on the sdk thread, written by Attach and Detach
+	volatile LONG m_nType;///<ZoomSDKRawDataType, likewise
+	ZoomSDKResolution m_resolution;
+	volatile LONG m_nStatus;
+	volatile LONG m_nDestroyed;
+};
+
+//Keeps a warm pool of renderers made with CSDKImpl::createRenderer() and hands them out per user id,
+//so subscribing to someone who walks into view does not pay for renderer creation.
+//Unsubscribed renderers go back to the pool instead of being destroyed. Renderers the sdk destroys on its
+//own (onRendererBeDestroyed) are flagged by their slot and reaped by the manager, never touched again.
+//Control calls and the frame consumer (AcquireFrame/ReleaseFrame) belong on one thread, the Unity main
+//thread in practice. Frames are produced on the sdk thread.
+class CRawDataRendererManager
+{
+public:
+	static CRawDataRendererManager& GetInst();
+
+	//warmCount renderers are created up front, at most maxPooled idle ones are kept afterwards
+	SDKError Init(FrameRingMode mode = FrameRingMode_LatestWins, unsigned int warmCount = 4, unsigned int maxPooled = 16, unsigned int ringCapacity = 4);
+	void Uninit();
+	bool IsInited() const { return m_bInited; }
+
+	//tops the idle pool up to count renderers
+	SDKError Prewarm(unsigned int count);
+
+	//subscribing an already subscribed user only updates the resolution
+	SDKError Subscribe(uint32_t userId, ZoomSDKResolution resolution = ZoomSDKResolution_360P);
+	SDKError Unsubscribe(uint32_t userId);
+	void UnsubscribeAll();
+	SDKError SetResolution(uint32_t userId, ZoomSDKResolution resolution);
+	bool IsSubscribed(uint32_t userId);
+
+	//NULL when the user is not subscribed. The slot stays valid until the user is unsubscribed.
+	CRawDataRendererSlot* GetSlot(uint32_t userId);
+	//consumer side of the user's ring, see CRawDataFrameRing
+	const CRawDataFrame* AcquireFrame(uint32_t userId);
+	void ReleaseFrame(uint32_t userId, const CRawDataFrame* pFrame);
+	//the same for callers that can only hold plain data. The planes stay valid until ReleaseLease(), the
+	//next AcquireLease() for the user or Unsubscribe(). Returns false when there is no new frame.
+	bool AcquireLease(uint32_t userId, RawDataFrameLease& lease);
+	//stale handles, e.g. from before a later AcquireLease(), are ignored
+	void ReleaseLease(unsigned long long handle);
+
+	unsigned int GetSubscribedCount();
+	unsigned int GetPooledCount();
+	//fills pUserIds with up to count subscribed users and returns how many there are in total
+	unsigned int GetSubscribedUsers(uint32_t* pUserIds, unsigned int count);
+
+	//drops slots whose renderer the sdk has destroyed. Called by the other control calls as well.
+	void ReapDestroyed();
+
+private:
+	CRawDataRendererManager();
+	~CRawDataRendererManager();
+	CRawDataRendererSlot* TakeIdleSlot();
+	void RecycleSlot(CRawDataRendererSlot* pSlot);
+	void DeleteSlot(CRawDataRendererSlot* pSlot);
+
+	typedef std::map<uint32_t, CRawDataRendererSlot*> SlotMap;
+	CMediaLock m_lock;///<guards m_active and m_pool for readers on other threads
+	SlotMap m_active;
+	std::vector<CRawDataRendererSlot*> m_pool;
+	FrameRingMode m_mode;
+	unsigned int m_nRingCapacity;
+	unsigned int m_nMaxPooled;
+	bool m_bInited;
+};
+END_ZOOM_SDK_NAMESPACE
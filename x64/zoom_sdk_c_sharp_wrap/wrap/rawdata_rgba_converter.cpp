@@ -0,0 +1,233 @@
+#include "rawdata_rgba_converter.h"
+#include <immintrin.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//BT.601 limited range, coefficients in pixel byte order. Y is 7 bit fixed point and U/V 8 bit, small enough
+//for pmaddubsw: every pair sum fits a signed 16 bit lane without saturating.
+struct RgbaConstants
+{
+	signed char y[4];
+	signed char u[4];
+	signed char v[4];
+};
+
+static const RgbaConstants s_rgbaConstants = { { 33, 64, 13, 0 }, { -38, -74, 112, 0 }, { 112, -94, -18, 0 } };
+static const RgbaConstants s_bgraConstants = { { 13, 64, 33, 0 }, { 112, -74, -38, 0 }, { -18, -94, 112, 0 } };
+
+#define RGBA_Y_OFFSET 0x840///<16.5 in 7 bit fixed point, the 0.5 rounds
+#define RGBA_UV_OFFSET 0x8080///<128.5 in 8 bit fixed point
+
+typedef void(*RgbaToYRowFunc)(const unsigned char* pSrc, unsigned char* pY, int width, const RgbaConstants* k);
+//one chroma row from two source rows, each output is the average of a 2x2 block
+typedef void(*RgbaToUVRowFunc)(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pU, unsigned char* pV, int width, const RgbaConstants* k);
+
+static inline int AverageByte(int a, int b)
+{
+	return (a + b + 1) >> 1;
+}
+
+static inline unsigned char RgbaToYPixel(const unsigned char* p, const RgbaConstants* k)
+{
+	return (unsigned char)((k->y[0] * p[0] + k->y[1] * p[1] + k->y[2] * p[2] + RGBA_Y_OFFSET) >> 7);
+}
+
+//averages rows first and columns second, rounding each step the way pavgb does
+static inline void RgbaToUVPixel(const unsigned char* p0, const unsigned char* p1, bool bPair, unsigned char* pU, unsigned char* pV, const RgbaConstants* k)
+{
+	int c[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		int left = AverageByte(p0[i], p1[i]);
+		c[i] = bPair ? AverageByte(left, AverageByte(p0[4 + i], p1[4 + i])) : left;
+	}
+	*pU = (unsigned char)((k->u[0] * c[0] + k->u[1] * c[1] + k->u[2] * c[2] + RGBA_UV_OFFSET) >> 8);
+	*pV = (unsigned char)((k->v[0] * c[0] + k->v[1] * c[1] + k->v[2] * c[2] + RGBA_UV_OFFSET) >> 8);
+}
+
+static void RgbaToYRow_Scalar(const unsigned char* pSrc, unsigned char* pY, int width, const RgbaConstants* k)
+{
+	for (int x = 0; x < width; ++x)
+		pY[x] = RgbaToYPixel(pSrc + x * 4, k);
+}
+
+static void RgbaToUVRow_Scalar(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pU, unsigned char* pV, int width, const RgbaConstants* k)
+{
+	for (int x = 0; x < width; x += 2)
+		RgbaToUVPixel(pRow0 + x * 4, pRow1 + x * 4, x + 1 < width, pU + (x >> 1), pV + (x >> 1), k);
+}
+
+static inline int LoadCoefficients(const signed char* p)
+{
+	int v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static MEDIA_TARGET_SSE41 void RgbaToYRow_SSE41(const unsigned char* pSrc, unsigned char* pY, int width, const RgbaConstants* k)
+{
+	const __m128i ky = _mm_set1_epi32(LoadCoefficients(k->y));
+	const __m128i offset = _mm_set1_epi16(RGBA_Y_OFFSET);
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		const unsigned char* p = pSrc + x * 4;
+		__m128i m0 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)p), ky);
+		__m128i m1 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(p + 16)), ky);
+		__m128i m2 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(p + 32)), ky);
+		__m128i m3 = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(p + 48)), ky);
+		__m128i y0 = _mm_srli_epi16(_mm_add_epi16(_mm_hadd_epi16(m0, m1), offset), 7);
+		__m128i y1 = _mm_srli_epi16(_mm_add_epi16(_mm_hadd_epi16(m2, m3), offset), 7);
+		_mm_storeu_si128((__m128i*)(pY + x), _mm_packus_epi16(y0, y1));
+	}
+	for (; x < width; ++x)
+		pY[x] = RgbaToYPixel(pSrc + x * 4, k);
+}
+
+//averages the even and odd pixels of two registers of 4 pixels each
+static MEDIA_TARGET_SSE41 inline __m128i AveragePairs_SSE41(__m128i a, __m128i b)
+{
+	__m128i even = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+	__m128i odd = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm_avg_epu8(even, odd);
+}
+
+static MEDIA_TARGET_SSE41 void RgbaToUVRow_SSE41(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pU, unsigned char* pV, int width, const RgbaConstants* k)
+{
+	const __m128i ku = _mm_set1_epi32(LoadCoefficients(k->u));
+	const __m128i kv = _mm_set1_epi32(LoadCoefficients(k->v));
+	const __m128i offset = _mm_set1_epi16((short)RGBA_UV_OFFSET);
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		const unsigned char* p0 = pRow0 + x * 4;
+		const unsigned char* p1 = pRow1 + x * 4;
+		__m128i a0 = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)p0), _mm_loadu_si128((const __m128i*)p1));
+		__m128i a1 = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p0 + 16)), _mm_loadu_si128((const __m128i*)(p1 + 16)));
+		__m128i a2 = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p0 + 32)), _mm_loadu_si128((const __m128i*)(p1 + 32)));
+		__m128i a3 = _mm_avg_epu8(_mm_loadu_si128((const __m128i*)(p0 + 48)), _mm_loadu_si128((const __m128i*)(p1 + 48)));
+		__m128i c0 = AveragePairs_SSE41(a0, a1);//chroma 0-3
+		__m128i c1 = AveragePairs_SSE41(a2, a3);//chroma 4-7
+
+		__m128i u = _mm_hadd_epi16(_mm_maddubs_epi16(c0, ku), _mm_maddubs_epi16(c1, ku));
+		__m128i v = _mm_hadd_epi16(_mm_maddubs_epi16(c0, kv), _mm_maddubs_epi16(c1, kv));
+		u = _mm_srli_epi16(_mm_add_epi16(u, offset), 8);
+		v = _mm_srli_epi16(_mm_add_epi16(v, offset), 8);
+		__m128i uv = _mm_packus_epi16(u, v);
+		_mm_storel_epi64((__m128i*)(pU + (x >> 1)), uv);
+		_mm_storel_epi64((__m128i*)(pV + (x >> 1)), _mm_srli_si128(uv, 8));
+	}
+	for (; x < width; x += 2)
+		RgbaToUVPixel(pRow0 + x * 4, pRow1 + x * 4, x + 1 < width, pU + (x >> 1), pV + (x >> 1), k);
+}
+
+static MEDIA_TARGET_AVX2 void RgbaToYRow_AVX2(const unsigned char* pSrc, unsigned char* pY, int width, const RgbaConstants* k)
+{
+	const __m256i ky = _mm256_set1_epi32(LoadCoefficients(k->y));
+	const __m256i offset = _mm256_set1_epi16(RGBA_Y_OFFSET);
+	const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	int x = 0;
+	for (; x + 32 <= width; x += 32)
+	{
+		const unsigned char* p = pSrc + x * 4;
+		__m256i m0 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)p), ky);
+		__m256i m1 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(p + 32)), ky);
+		__m256i m2 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(p + 64)), ky);
+		__m256i m3 = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(p + 96)), ky);
+		__m256i y0 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(m0, m1), offset), 7);
+		__m256i y1 = _mm256_srli_epi16(_mm256_add_epi16(_mm256_hadd_epi16(m2, m3), offset), 7);
+		//the in-lane hadd and pack leave groups of 4 pixels as 0,8,16,24 | 4,12,20,28
+		_mm256_storeu_si256((__m256i*)(pY + x), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(y0, y1), order));
+	}
+	for (; x < width; ++x)
+		pY[x] = RgbaToYPixel(pSrc + x * 4, k);
+}
+
+static MEDIA_TARGET_AVX2 inline __m256i AveragePairs_AVX2(__m256i a, __m256i b)
+{
+	__m256i even = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(2, 0, 2, 0)));
+	__m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _MM_SHUFFLE(3, 1, 3, 1)));
+	return _mm256_avg_epu8(even, odd);
+}
+
+static MEDIA_TARGET_AVX2 void RgbaToUVRow_AVX2(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pU, unsigned char* pV, int width, const RgbaConstants* k)
+{
+	const __m256i ku = _mm256_set1_epi32(LoadCoefficients(k->u));
+	const __m256i kv = _mm256_set1_epi32(LoadCoefficients(k->v));
+	const __m256i offset = _mm256_set1_epi16((short)RGBA_UV_OFFSET);
+	int x = 0;
+	for (; x + 32 <= width; x += 32)
+	{
+		const unsigned char* p0 = pRow0 + x * 4;
+		const unsigned char* p1 = pRow1 + x * 4;
+		__m256i a0 = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)p0), _mm256_loadu_si256((const __m256i*)p1));
+		__m256i a1 = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)(p0 + 32)), _mm256_loadu_si256((const __m256i*)(p1 + 32)));
+		__m256i a2 = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)(p0 + 64)), _mm256_loadu_si256((const __m256i*)(p1 + 64)));
+		__m256i a3 = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i*)(p0 + 96)), _mm256_loadu_si256((const __m256i*)(p1 + 96)));
+		__m256i c0 = AveragePairs_AVX2(a0, a1);//chroma 0,1,4,5 | 2,3,6,7
+		__m256i c1 = AveragePairs_AVX2(a2, a3);//chroma 8,9,12,13 | 10,11,14,15
+
+		__m256i u = _mm256_hadd_epi16(_mm256_maddubs_epi16(c0, ku), _mm256_maddubs_epi16(c1, ku));
+		__m256i v = _mm256_hadd_epi16(_mm256_maddubs_epi16(c0, kv), _mm256_maddubs_epi16(c1, kv));
+		u = _mm256_srli_epi16(_mm256_add_epi16(u, offset), 8);
+		v = _mm256_srli_epi16(_mm256_add_epi16(v, offset), 8);
+		//u and v bytes come in pairs 0-1,4-5,8-9,12-13 | 2-3,6-7,10-11,14-15: gather u in the low lane and
+		//v in the high one, then interleave the pairs of the two halves of each lane
+		__m256i uv = _mm256_permute4x64_epi64(_mm256_packus_epi16(u, v), _MM_SHUFFLE(3, 1, 2, 0));
+		uv = _mm256_unpacklo_epi16(uv, _mm256_srli_si256(uv, 8));
+		_mm_storeu_si128((__m128i*)(pU + (x >> 1)), _mm256_castsi256_si128(uv));
+		_mm_storeu_si128((__m128i*)(pV + (x >> 1)), _mm256_extracti128_si256(uv, 1));
+	}
+	for (; x < width; x += 2)
+		RgbaToUVPixel(pRow0 + x * 4, pRow1 + x * 4, x + 1 < width, pU + (x >> 1), pV + (x >> 1), k);
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataRGBAConverter::CRawDataRGBAConverter()
+{
+	m_maxLevel = CRawDataYUVConverter::SimdLevel_AVX2;
+}
+
+bool CRawDataRGBAConverter::Convert(const unsigned char* pSrc, unsigned int srcStride, unsigned int width, unsigned int height,
+	RawDataPixelFormat format, bool bFlipVertical, CRawDataI420Image& dst)
+{
+	if (NULL == pSrc || 0 == width || 0 == height || srcStride < width * 4 || !dst.Resize(width, height))
+		return false;
+	dst.m_view.bLimited = true;
+	dst.m_view.rotation = 0;
+
+	CRawDataYUVConverter::SimdLevel level = CRawDataYUVConverter::GetSimdLevel();
+	if (level > m_maxLevel)
+		level = m_maxLevel;
+	RgbaToYRowFunc toY = RgbaToYRow_Scalar;
+	RgbaToUVRowFunc toUV = RgbaToUVRow_Scalar;
+	if (CRawDataYUVConverter::SimdLevel_AVX2 == level)
+	{
+		toY = RgbaToYRow_AVX2;
+		toUV = RgbaToUVRow_AVX2;
+	}
+	else if (CRawDataYUVConverter::SimdLevel_SSE41 == level)
+	{
+		toY = RgbaToYRow_SSE41;
+		toUV = RgbaToUVRow_SSE41;
+	}
+	const RgbaConstants* k = RawDataPixelFormat_BGRA32 == format ? &s_bgraConstants : &s_rgbaConstants;
+
+	const unsigned char* pFirst = pSrc;
+	ptrdiff_t stride = (ptrdiff_t)srcStride;
+	if (bFlipVertical)
+	{
+		pFirst = pSrc + (size_t)(height - 1) * srcStride;
+		stride = -stride;
+	}
+	for (unsigned int y = 0; y < height; y += 2)
+	{
+		//the last row of an odd height pairs with itself
+		const unsigned char* pRow0 = pFirst + (ptrdiff_t)y * stride;
+		const unsigned char* pRow1 = y + 1 < height ? pRow0 + stride : pRow0;
+		toY(pRow0, dst.GetYBuffer() + (size_t)y * dst.GetYStride(), (int)width, k);
+		if (y + 1 < height)
+			toY(pRow1, dst.GetYBuffer() + (size_t)(y + 1) * dst.GetYStride(), (int)width, k);
+		size_t uvOffset = (size_t)(y / 2) * dst.GetUVStride();
+		toUV(pRow0, pRow1, dst.GetUBuffer() + uvOffset, dst.GetVBuffer() + uvOffset, (int)width, k);
+	}
+	return true;
+}
+END_ZOOM_SDK_NAMESPACE
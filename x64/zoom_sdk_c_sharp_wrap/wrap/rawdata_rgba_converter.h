@@ -0,0 +1,27 @@
+#pragma once
+#include "rawdata_yuv_scaler.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//Converts 32 bit RGBA/BGRA images, e.g. a Unity render texture read back from the gpu, to BT.601 limited
+//range I420 for sending. Chroma is the average of each 2x2 block. AVX2 or SSE4.1 kernels are selected at
+//runtime with a scalar fallback, and every level produces the same bytes. Not thread safe.
+class CRawDataRGBAConverter
+{
+public:
+	CRawDataRGBAConverter();
+
+	//srcStride is in bytes. bFlipVertical reads the rows bottom-up, which is how Texture2D and
+	//AsyncGPUReadback hand them out. The alpha channel is ignored.
+	bool Convert(const unsigned char* pSrc, unsigned int srcStride, unsigned int width, unsigned int height,
+		RawDataPixelFormat format, bool bFlipVertical, CRawDataI420Image& dst);
+
+	//limits the kernels to the given level, mainly to compare them against each other
+	void SetMaxSimdLevel(CRawDataYUVConverter::SimdLevel level) { m_maxLevel = level; }
+
+private:
+	CRawDataRGBAConverter(const CRawDataRGBAConverter&);
+	CRawDataRGBAConverter& operator=(const CRawDataRGBAConverter&);
+
+	CRawDataYUVConverter::SimdLevel m_maxLevel;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,71 @@
+#include "rawdata_rgba_mailbox.h"
+#include <string.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+#define RGBA_MAILBOX_FRESH 0x100
+#define RGBA_MAILBOX_SLOT_MASK 0xFF
+
+CRawDataRGBAMailbox::CRawDataRGBAMailbox()
+{
+	for (int i = 0; i < RGBA_MAILBOX_SLOTS; ++i)
+	{
+		m_slots[i].width = 0;
+		m_slots[i].height = 0;
+		m_slots[i].format = RawDataPixelFormat_RGBA32;
+		m_slots[i].bFlipVertical = false;
+	}
+	m_nDropped = 0;
+	Reset();
+}
+
+void CRawDataRGBAMailbox::Reset()
+{
+	m_nBack = 0;
+	m_nMiddle = 1;
+	m_nFront = 2;
+}
+
+void CRawDataRGBAMailbox::Free()
+{
+	for (int i = 0; i < RGBA_MAILBOX_SLOTS; ++i)
+		m_slots[i].rgba.Free();
+}
+
+bool CRawDataRGBAMailbox::Push(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	if (NULL == pRGBA || 0 == width || 0 == height || stride < width * 4)
+		return false;
+
+	RawDataRGBAFrame& slot = m_slots[m_nBack];
+	size_t rowSize = (size_t)width * 4;
+	if (!slot.rgba.Resize(rowSize * height))
+		return false;
+	if (stride == rowSize)
+	{
+		memcpy(slot.rgba.GetData(), pRGBA, rowSize * height);
+	}
+	else
+	{
+		for (unsigned int y = 0; y < height; ++y)
+			memcpy(slot.rgba.GetData() + rowSize * y, pRGBA + (size_t)stride * y, rowSize);
+	}
+	slot.width = width;
+	slot.height = height;
+	slot.format = format;
+	slot.bFlipVertical = bFlipVertical;
+
+	LONG previous = MediaAtomicExchange(&m_nMiddle, (LONG)m_nBack | RGBA_MAILBOX_FRESH);
+	m_nBack = (unsigned int)(previous & RGBA_MAILBOX_SLOT_MASK);
+	if (previous & RGBA_MAILBOX_FRESH)
+		MediaAtomicIncrement64(&m_nDropped);
+	return true;
+}
+
+RawDataRGBAFrame* CRawDataRGBAMailbox::Take()
+{
+	//only the producer sets the fresh flag, so it cannot be lost between the check and the swap
+	if (0 == (MediaAtomicLoad(&m_nMiddle) & RGBA_MAILBOX_FRESH))
+		return NULL;
+	m_nFront = (unsigned int)(MediaAtomicExchange(&m_nMiddle, (LONG)m_nFront) & RGBA_MAILBOX_SLOT_MASK);
+	return &m_slots[m_nFront];
+}
+END_ZOOM_SDK_NAMESPACE
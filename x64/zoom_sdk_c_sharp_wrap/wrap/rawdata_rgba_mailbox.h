@@ -0,0 +1,47 @@
+#pragma once
+#include "rawdata_yuv_converter.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define RGBA_MAILBOX_SLOTS 3
+
+//A frame pushed by the host, rows packed without padding.
+typedef struct tagRawDataRGBAFrame
+{
+	CMediaBuffer rgba;
+	unsigned int width;
+	unsigned int height;
+	RawDataPixelFormat format;
+	bool bFlipVertical;
+}RawDataRGBAFrame;
+
+//Hands RGBA frames rendered by the host from one producer thread to one consumer thread through a triple buffer.
+//Push() copies the pixels into the slot only the producer owns and swaps it into the middle, Take() swaps the
+//middle out when it holds a new frame. Neither side waits for the other, a frame pushed before the previous one
+//was taken replaces it.
+class CRawDataRGBAMailbox
+{
+public:
+	CRawDataRGBAMailbox();
+
+	//stride is in bytes. Returns false for an invalid frame or when the slot could not grow.
+	bool Push(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical);
+	//the newest frame not taken yet, NULL when there is none. Valid until the next Take().
+	RawDataRGBAFrame* Take();
+	//forgets a pending frame, only while neither side is running
+	void Reset();
+	//frees the slots, only while neither side is running
+	void Free();
+
+	//frames replaced by a newer one before they were taken
+	unsigned long long GetDroppedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nDropped); }
+
+private:
+	CRawDataRGBAMailbox(const CRawDataRGBAMailbox&);
+	CRawDataRGBAMailbox& operator=(const CRawDataRGBAMailbox&);
+
+	RawDataRGBAFrame m_slots[RGBA_MAILBOX_SLOTS];
+	unsigned int m_nBack;///<Slot the producer fills, owned by Push().
+	volatile LONG m_nMiddle;///<Slot handed over between the threads, flagged while it holds a frame not taken yet.
+	unsigned int m_nFront;///<Slot last taken, owned by the consumer.
+	volatile LONGLONG m_nDropped;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,153 @@
+#include "rawdata_share_source.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+CRawDataShareSource& CRawDataShareSource::GetInst()
+{
+	static CRawDataShareSource inst;
+	return inst;
+}
+
+CRawDataShareSource::CRawDataShareSource()
+{
+	m_bQuit = 0;
+	m_bSending = 0;
+	m_bNewShare = 0;
+	m_nSent = 0;
+	m_nUnchanged = 0;
+	m_nThrottled = 0;
+	m_nNextSendUs = 0;
+	m_pSender = NULL;
+	m_nTargetWidth = 0;
+	m_nTargetHeight = 0;
+	m_nTargetFps = 0;
+	m_nTolerance = 2;
+	m_nChangedPermille = 1;
+}
+
+void CRawDataShareSource::SetTargetSize(unsigned int width, unsigned int height, unsigned int fps)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nTargetWidth = width;
+	m_nTargetHeight = height;
+	m_nTargetFps = fps;
+}
+
+void CRawDataShareSource::SetChangeThreshold(unsigned int tolerance, unsigned int changedPermille)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nTolerance = tolerance;
+	m_nChangedPermille = changedPermille;
+}
+
+void CRawDataShareSource::onStartSend(IZoomSDKShareSender* pSender)
+{
+	CMediaAutoLock lock(m_lock);
+	m_pSender = pSender;
+	MediaAtomicStore(&m_bNewShare, 1);
+	MediaAtomicStore(&m_bSending, NULL != pSender ? 1 : 0);
+}
+
+void CRawDataShareSource::onStopSend()
+{
+	//waits for a send in progress on the worker
+	CMediaAutoLock lock(m_lock);
+	MediaAtomicStore(&m_bSending, 0);
+	m_pSender = NULL;
+}
+
+bool CRawDataShareSource::Start()
+{
+	if (m_thread.IsStarted())
+		return true;
+	m_mailbox.Reset();
+	m_nNextSendUs = 0;
+	MediaAtomicStore(&m_bNewShare, 1);
+	MediaAtomicStore(&m_bQuit, 0);
+	return m_thread.Start(WorkerProc, this);
+}
+
+void CRawDataShareSource::Stop()
+{
+	if (!m_thread.IsStarted())
+		return;
+	MediaAtomicStore(&m_bQuit, 1);
+	m_event.Set();
+	m_thread.Join();
+	m_mailbox.Free();
+	m_image.Free();
+	m_scaled.Free();
+}
+
+bool CRawDataShareSource::PushFrame(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	if (!m_thread.IsStarted() || !IsSending())
+		return false;
+	if (!m_mailbox.Push(pRGBA, width, height, stride, format, bFlipVertical))
+		return false;
+	m_event.Set();
+	return true;
+}
+
+void CRawDataShareSource::WorkerProc(void* pParam)
+{
+	((CRawDataShareSource*)pParam)->WorkerLoop();
+}
+
+void CRawDataShareSource::WorkerLoop()
+{
+	while (0 == MediaAtomicLoad(&m_bQuit))
+	{
+		m_event.Wait(100);
+		RawDataRGBAFrame* pFrame = m_mailbox.Take();
+		if (pFrame)
+			SendFrame(*pFrame);
+	}
+}
+
+void CRawDataShareSource::SendFrame(const RawDataRGBAFrame& frame)
+{
+	if (!IsSending())
+		return;
+
+	unsigned int maxWidth, maxHeight, fps;
+	{
+		CMediaAutoLock lock(m_lock, true);
+		maxWidth = m_nTargetWidth;
+		maxHeight = m_nTargetHeight;
+		fps = m_nTargetFps;
+		m_detector.SetThreshold(m_nTolerance, m_nChangedPermille);
+	}
+
+	if (fps > 0)
+	{
+		long long nowUs = MediaGetTimeUs();
+		long long intervalUs = 1000000 / fps;
+		//see CRawDataVirtualCamera::SendFrame()
+		if (nowUs + intervalUs / 8 < m_nNextSendUs)
+		{
+			MediaAtomicIncrement64(&m_nThrottled);
+			return;
+		}
+		m_nNextSendUs = m_nNextSendUs + intervalUs > nowUs ? m_nNextSendUs + intervalUs : nowUs + intervalUs;
+	}
+
+	if (!m_converter.Convert(frame.rgba.GetData(), frame.width * 4, frame.width, frame.height, frame.format, frame.bFlipVertical, m_image))
+		return;
+	CRawDataI420Image* pImage = m_scaler.ScaleToFit(m_image, m_scaled, maxWidth, maxHeight);
+
+	//a new share starts from a full picture even when the venue did not move since the last one
+	if (0 != MediaAtomicExchange(&m_bNewShare, 0))
+		m_detector.Reset();
+	if (!m_detector.IsChanged(pImage->GetView()))
+	{
+		MediaAtomicIncrement64(&m_nUnchanged);
+		return;
+	}
+
+	CMediaAutoLock lock(m_lock, true);
+	if (m_pSender && IsSending())
+	{
+		if (SDKERR_SUCCESS == m_pSender->sendShareFrame((char*)pImage->GetYBuffer(), (int)pImage->GetWidth(), (int)pImage->GetHeight(), (int)pImage->GetSize()))
+			MediaAtomicIncrement64(&m_nSent);
+	}
+}
+END_ZOOM_SDK_NAMESPACE
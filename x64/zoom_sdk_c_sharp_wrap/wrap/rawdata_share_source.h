@@ -0,0 +1,75 @@
+#pragma once
+#include "rawdata_rgba_converter.h"
+#include "rawdata_rgba_mailbox.h"
+#include "rawdata_change_detector.h"
+#include "zoom_sdk_def.h"
+#include "rawdata/rawdata_share_source_helper_interface.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//External share source fed with RGBA frames rendered by the host, e.g. a Unity camera overlooking the venue, so
+//attendees in regular Zoom clients get the 3D space as this user's share instead of a capture of the window.
+//Like CRawDataVirtualCamera, PushFrame() only copies the pixels into a triple buffer, a worker thread converts the
+//newest frame to I420 and scales it down to the target size. Frames whose content did not change since the last one
+//sent are dropped there, a venue seen from a fixed camera is mostly static, and the frame rate is capped.
+//Register it with IZoomSDKShareSourceHelperWrap::setExternalShareSource(), which starts the share.
+class CRawDataShareSource : public IZoomSDKShareSource
+{
+public:
+	static CRawDataShareSource& GetInst();
+
+	//largest size sent, larger frames are scaled down keeping the aspect ratio. 0 does not limit.
+	void SetTargetSize(unsigned int width, unsigned int height, unsigned int fps);
+	//see CRawDataChangeDetector::SetThreshold(), applied from the next frame
+	void SetChangeThreshold(unsigned int tolerance, unsigned int changedPermille);
+	bool Start();
+	void Stop();
+	bool IsStarted() const { return m_thread.IsStarted(); }
+
+	//returns false when the sdk is not taking frames. See CRawDataVirtualCamera::PushFrame().
+	bool PushFrame(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical);
+	//true between onStartSend and onStopSend
+	bool IsSending() const { return 0 != MediaAtomicLoad(&m_bSending); }
+	unsigned long long GetSentCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nSent); }
+	//frames not sent because they looked like the last one sent
+	unsigned long long GetUnchangedCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nUnchanged); }
+	//frames skipped to stay within the frame rate
+	unsigned long long GetThrottledCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nThrottled); }
+	//frames replaced by a newer one before the worker got to them
+	unsigned long long GetDroppedCount() const { return m_mailbox.GetDroppedCount(); }
+
+	virtual void onStartSend(IZoomSDKShareSender* pSender);
+	virtual void onStopSend();
+
+private:
+	CRawDataShareSource();
+	CRawDataShareSource(const CRawDataShareSource&);
+	CRawDataShareSource& operator=(const CRawDataShareSource&);
+	static void WorkerProc(void* pParam);
+	void WorkerLoop();
+	void SendFrame(const RawDataRGBAFrame& frame);
+
+	CRawDataRGBAMailbox m_mailbox;
+	CMediaThread m_thread;
+	CMediaEvent m_event;
+	volatile LONG m_bQuit;
+	volatile LONG m_bSending;
+	volatile LONG m_bNewShare;///<Set by onStartSend, the worker then sends the next frame whatever it shows.
+	volatile LONGLONG m_nSent;
+	volatile LONGLONG m_nUnchanged;
+	volatile LONGLONG m_nThrottled;
+	long long m_nNextSendUs;
+
+	CMediaLock m_lock;///<Guards the sender and the settings.
+	IZoomSDKShareSender* m_pSender;
+	unsigned int m_nTargetWidth;
+	unsigned int m_nTargetHeight;
+	unsigned int m_nTargetFps;
+	unsigned int m_nTolerance;
+	unsigned int m_nChangedPermille;
+
+	CRawDataRGBAConverter m_converter;
+	CRawDataYUVScaler m_scaler;
+	CRawDataChangeDetector m_detector;
+	CRawDataI420Image m_image;
+	CRawDataI420Image m_scaled;
+};
+END_ZOOM_SDK_NAMESPACE
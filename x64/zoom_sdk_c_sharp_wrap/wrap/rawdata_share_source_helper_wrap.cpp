@@ -0,0 +1,16 @@
+#include "rawdata_share_source_helper_wrap.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+IZoomSDKShareSourceHelper* InitIZoomSDKShareSourceHelperFunc()
+{
+	IZoomSDKShareSourceHelper* pObj(NULL);
+	pObj = CSDKImpl::GetInst().GetRawdataShareSourceHelper();
+	return pObj;
+}
+
+void UninitIZoomSDKShareSourceHelperFunc(IZoomSDKShareSourceHelper* obj)
+{
+}
+
+//virtual SDKError setExternalShareSource(IZoomSDKShareSource* pShareSource) = 0;
+IMPL_FUNC_1(IZoomSDKShareSourceHelper, setExternalShareSource, SDKError, IZoomSDKShareSource*, pShareSource, SDKERR_UNINITIALIZE)
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,15 @@
+#pragma once
+#include "common_include.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+IZoomSDKShareSourceHelper* InitIZoomSDKShareSourceHelperFunc();
+void UninitIZoomSDKShareSourceHelperFunc(IZoomSDKShareSourceHelper* obj);
+
+BEGIN_CLASS_DEFINE(IZoomSDKShareSourceHelper)
+STAITC_CLASS(IZoomSDKShareSourceHelper)
+INIT_UNINIT(IZoomSDKShareSourceHelper)
+
+//virtual SDKError setExternalShareSource(IZoomSDKShareSource* pShareSource) = 0;
+DEFINE_FUNC_1(setExternalShareSource, SDKError, IZoomSDKShareSource*, pShareSource)
+
+END_CLASS_DEFINE(IZoomSDKShareSourceHelper)
+END_ZOOM_SDK_NAMESPACE
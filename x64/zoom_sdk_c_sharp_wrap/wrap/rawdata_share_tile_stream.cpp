@@ -0,0 +1,95 @@
+#include "rawdata_share_tile_stream.h"
+#include <new>
+BEGIN_ZOOM_SDK_NAMESPACE
+CRawDataShareTileStream::CRawDataShareTileStream()
+{
+	m_pSlot = NULL;
+	m_nSharerUserId = 0;
+	m_bSubscribed = false;
+}
+
+CRawDataShareTileStream::~CRawDataShareTileStream()
+{
+	DeleteSlot();
+}
+
+void CRawDataShareTileStream::DeleteSlot()
+{
+	if (m_pSlot)
+	{
+		if (m_bSubscribed && !m_pSlot->IsDestroyed())
+			m_pSlot->Detach();
+		delete m_pSlot;
+		m_pSlot = NULL;
+	}
+	m_bSubscribed = false;
+	m_nSharerUserId = 0;
+	m_tracker.Free();
+}
+
+SDKError CRawDataShareTileStream::Subscribe(uint32_t sharerUserId, ZoomSDKResolution resolution)
+{
+	//a renderer the sdk destroyed cannot be used again
+	if (m_pSlot && m_pSlot->IsDestroyed())
+		DeleteSlot();
+
+	if (NULL == m_pSlot)
+	{
+		CRawDataRendererSlot* pSlot = new (std::nothrow) CRawDataRendererSlot;
+		if (NULL == pSlot)
+			return SDKERR_MEMORY_FAILED;
+		//only the newest share frame matters, older ones would be diffed for nothing
+		SDKError err = pSlot->Create(FrameRingMode_LatestWins, 3);
+		if (SDKERR_SUCCESS != err)
+		{
+			delete pSlot;
+			return err;
+		}
+		m_pSlot = pSlot;
+	}
+	else if (m_bSubscribed)
+	{
+		m_pSlot->Detach();
+		m_bSubscribed = false;
+	}
+
+	SDKError err = m_pSlot->Attach(sharerUserId, resolution, RAW_DATA_TYPE_SHARE);
+	if (SDKERR_SUCCESS != err)
+		return err;
+	m_nSharerUserId = sharerUserId;
+	m_bSubscribed = true;
+	//a different share must not be diffed against the old one
+	m_tracker.Reset();
+	return SDKERR_SUCCESS;
+}
+
+void CRawDataShareTileStream::Unsubscribe()
+{
+	if (m_pSlot && m_bSubscribed && !m_pSlot->IsDestroyed())
+		m_pSlot->Detach();
+	m_bSubscribed = false;
+	m_nSharerUserId = 0;
+	m_tracker.Reset();
+}
+
+IZoomSDKRendererDelegate::RawDataStatus CRawDataShareTileStream::GetStatus() const
+{
+	if (NULL == m_pSlot || !m_bSubscribed)
+		return IZoomSDKRendererDelegate::RawData_Off;
+	return m_pSlot->GetStatus();
+}
+
+unsigned int CRawDataShareTileStream::Poll()
+{
+	if (NULL == m_pSlot || !m_bSubscribed)
+		return 0;
+
+	CRawDataFrameRing& ring = m_pSlot->GetFrameRing();
+	const CRawDataFrame* pFrame = ring.AcquireFrame();
+	if (NULL == pFrame)
+		return 0;
+	unsigned int rects = m_tracker.Update(pFrame);
+	ring.ReleaseFrame(pFrame);
+	return rects;
+}
+END_ZOOM_SDK_NAMESPACE
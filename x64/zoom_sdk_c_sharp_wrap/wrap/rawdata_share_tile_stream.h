@@ -0,0 +1,38 @@
+#pragma once
+#include "rawdata_renderer_manager.h"
+#include "rawdata_share_tile_tracker.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//Receives one screen share as raw data (RAW_DATA_TYPE_SHARE) and hands the consumer only the tiles that
+//changed, see CRawDataShareTileTracker. Several in-world surfaces showing the same share should use one
+//stream and upload the dirty rects into one texture.
+//The renderer is its own, share subscriptions are not pooled by CRawDataRendererManager.
+//Control calls and Poll() belong on one thread, frames arrive on the sdk thread.
+class CRawDataShareTileStream
+{
+public:
+	CRawDataShareTileStream();
+	~CRawDataShareTileStream();
+
+	//subscribes to the share of sharerUserId, replacing the previous sharer
+	SDKError Subscribe(uint32_t sharerUserId, ZoomSDKResolution resolution = ZoomSDKResolution_1080P);
+	void Unsubscribe();
+	bool IsSubscribed() const { return m_bSubscribed; }
+	uint32_t GetSharerUserId() const { return m_nSharerUserId; }
+	IZoomSDKRendererDelegate::RawDataStatus GetStatus() const;
+
+	//diffs the newest share frame against the previous one and returns the number of dirty rects,
+	//0 when no new frame arrived or nothing changed. The rects are read from GetTracker().
+	unsigned int Poll();
+	CRawDataShareTileTracker& GetTracker() { return m_tracker; }
+
+private:
+	CRawDataShareTileStream(const CRawDataShareTileStream&);
+	CRawDataShareTileStream& operator=(const CRawDataShareTileStream&);
+	void DeleteSlot();
+
+	CRawDataRendererSlot* m_pSlot;
+	CRawDataShareTileTracker m_tracker;
+	uint32_t m_nSharerUserId;
+	bool m_bSubscribed;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,222 @@
+#include "rawdata_share_tile_tracker.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+CRawDataShareTileTracker::CRawDataShareTileTracker()
+{
+	m_nBufferUsed = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nTilesX = 0;
+	m_nTilesY = 0;
+	m_nLastDirtyTiles = 0;
+	m_format = RawDataPixelFormat_RGBA32;
+	m_bFlipVertical = true;
+	m_bFullFrame = false;
+	m_bHasReference = false;
+}
+
+void CRawDataShareTileTracker::SetOutputFormat(RawDataPixelFormat format, bool bFlipVertical)
+{
+	if (format != m_format || bFlipVertical != m_bFlipVertical)
+		Reset();
+	m_format = format;
+	m_bFlipVertical = bFlipVertical;
+}
+
+void CRawDataShareTileTracker::Reset()
+{
+	m_bHasReference = false;
+}
+
+void CRawDataShareTileTracker::Free()
+{
+	Reset();
+	m_reference.Free();
+	m_buffer.Free();
+	m_rects.clear();
+	m_nBufferUsed = 0;
+	m_nWidth = 0;
+	m_nHeight = 0;
+	m_nTilesX = 0;
+	m_nTilesY = 0;
+}
+
+unsigned int CRawDataShareTileTracker::Update(const CRawDataFrame* pFrame)
+{
+	return Update(MakeI420PlaneView(pFrame));
+}
+
+unsigned int CRawDataShareTileTracker::Update(YUVRawDataI420* data)
+{
+	return Update(MakeI420PlaneView(data));
+}
+
+bool CRawDataShareTileTracker::ResetReference(const I420PlaneView& frame)
+{
+	size_t chromaSize = (size_t)((frame.width + 1) / 2) * ((frame.height + 1) / 2);
+	if (!m_reference.Resize((size_t)frame.width * frame.height + 2 * chromaSize))
+		return false;
+	m_nWidth = frame.width;
+	m_nHeight = frame.height;
+	m_nTilesX = (frame.width + SHARE_TILE_SIZE - 1) / SHARE_TILE_SIZE;
+	m_nTilesY = (frame.height + SHARE_TILE_SIZE - 1) / SHARE_TILE_SIZE;
+	m_dirty.resize(m_nTilesX);
+	return true;
+}
+
+void CRawDataShareTileTracker::MarkDirtyTiles(const I420PlaneView& frame, unsigned int tileY)
+{
+	unsigned int top = tileY * SHARE_TILE_SIZE;
+	unsigned int rows = m_nHeight - top < SHARE_TILE_SIZE ? m_nHeight - top : SHARE_TILE_SIZE;
+	unsigned int chromaWidth = (m_nWidth + 1) / 2;
+	unsigned int chromaHeight = (m_nHeight + 1) / 2;
+	const unsigned char* pRefY = m_reference.GetData();
+	const unsigned char* pRefU = pRefY + (size_t)m_nWidth * m_nHeight;
+	const unsigned char* pRefV = pRefU + (size_t)chromaWidth * chromaHeight;
+	unsigned int clean = m_nTilesX;
+	for (unsigned int i = 0; i < m_nTilesX; ++i)
+		m_dirty[i] = 0;
+
+	//row by row keeps both frames streaming through the cache, tiles already found dirty are not compared again
+	for (unsigned int row = 0; row < rows && clean > 0; ++row)
+	{
+		const unsigned char* pCur = frame.pY + (size_t)(top + row) * frame.yStride;
+		const unsigned char* pRef = pRefY + (size_t)(top + row) * m_nWidth;
+		for (unsigned int i = 0; i < m_nTilesX; ++i)
+		{
+			unsigned int x = i * SHARE_TILE_SIZE;
+			unsigned int cols = m_nWidth - x < SHARE_TILE_SIZE ? m_nWidth - x : SHARE_TILE_SIZE;
+			if (0 == m_dirty[i] && 0 != memcmp(pCur + x, pRef + x, cols))
+			{
+				m_dirty[i] = 1;
+				--clean;
+			}
+		}
+	}
+
+	unsigned int chromaTop = top / 2;
+	unsigned int chromaRows = (top + rows + 1) / 2 - chromaTop;
+	for (unsigned int row = 0; row < chromaRows && clean > 0; ++row)
+	{
+		const unsigned char* pCurU = frame.pU + (size_t)(chromaTop + row) * frame.uStride;
+		const unsigned char* pCurV = frame.pV + (size_t)(chromaTop + row) * frame.vStride;
+		const unsigned char* pU = pRefU + (size_t)(chromaTop + row) * chromaWidth;
+		const unsigned char* pV = pRefV + (size_t)(chromaTop + row) * chromaWidth;
+		for (unsigned int i = 0; i < m_nTilesX; ++i)
+		{
+			unsigned int x = i * (SHARE_TILE_SIZE / 2);
+			unsigned int cols = chromaWidth - x < SHARE_TILE_SIZE / 2 ? chromaWidth - x : SHARE_TILE_SIZE / 2;
+			if (0 == m_dirty[i] && (0 != memcmp(pCurU + x, pU + x, cols) || 0 != memcmp(pCurV + x, pV + x, cols)))
+			{
+				m_dirty[i] = 1;
+				--clean;
+			}
+		}
+	}
+}
+
+void CRawDataShareTileTracker::CopyToReference(const I420PlaneView& frame, unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	unsigned int chromaWidth = (m_nWidth + 1) / 2;
+	unsigned int chromaHeight = (m_nHeight + 1) / 2;
+	unsigned char* pRefY = m_reference.GetData();
+	unsigned char* pRefU = pRefY + (size_t)m_nWidth * m_nHeight;
+	unsigned char* pRefV = pRefU + (size_t)chromaWidth * chromaHeight;
+	for (unsigned int row = y; row < y + height; ++row)
+		memcpy(pRefY + (size_t)row * m_nWidth + x, frame.pY + (size_t)row * frame.yStride + x, width);
+
+	//x and y are tile aligned and therefore even
+	unsigned int cx = x / 2;
+	unsigned int cw = (x + width + 1) / 2 - cx;
+	for (unsigned int row = y / 2; row < (y + height + 1) / 2; ++row)
+	{
+		memcpy(pRefU + (size_t)row * chromaWidth + cx, frame.pU + (size_t)row * frame.uStride + cx, cw);
+		memcpy(pRefV + (size_t)row * chromaWidth + cx, frame.pV + (size_t)row * frame.vStride + cx, cw);
+	}
+}
+
+void CRawDataShareTileTracker::AddRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height)
+{
+	RawDataDirtyRect rect;
+	rect.x = x;
+	rect.y = m_bFlipVertical ? m_nHeight - y - height : y;
+	rect.width = width;
+	rect.height = height;
+	rect.offset = m_nBufferUsed;
+	m_rects.push_back(rect);
+	m_nBufferUsed += width * height * 4;
+}
+
+unsigned int CRawDataShareTileTracker::Update(const I420PlaneView& frame)
+{
+	m_rects.clear();
+	m_nBufferUsed = 0;
+	m_nLastDirtyTiles = 0;
+	m_bFullFrame = false;
+	if (!frame.IsValid())
+		return 0;
+
+	I420PlaneView view = frame;
+	view.rotation = 0;
+	if (!m_bHasReference || view.width != m_nWidth || view.height != m_nHeight)
+	{
+		if (!ResetReference(view))
+			return 0;
+		CopyToReference(view, 0, 0, m_nWidth, m_nHeight);
+		m_bHasReference = true;
+		m_bFullFrame = true;
+		m_nLastDirtyTiles = GetTileCount();
+		AddRect(0, 0, m_nWidth, m_nHeight);
+	}
+	else
+	{
+		for (unsigned int tileY = 0; tileY < m_nTilesY; ++tileY)
+		{
+			MarkDirtyTiles(view, tileY);
+			unsigned int top = tileY * SHARE_TILE_SIZE;
+			unsigned int rows = m_nHeight - top < SHARE_TILE_SIZE ? m_nHeight - top : SHARE_TILE_SIZE;
+			unsigned int i = 0;
+			while (i < m_nTilesX)
+			{
+				if (0 == m_dirty[i])
+				{
+					++i;
+					continue;
+				}
+				unsigned int first = i;
+				while (i < m_nTilesX && m_dirty[i])
+					++i;
+				unsigned int x = first * SHARE_TILE_SIZE;
+				unsigned int width = (i * SHARE_TILE_SIZE < m_nWidth ? i * SHARE_TILE_SIZE : m_nWidth) - x;
+				m_nLastDirtyTiles += i - first;
+				AddRect(x, top, width, rows);
+				CopyToReference(view, x, top, width, rows);
+			}
+		}
+	}
+
+	if (m_rects.empty())
+		return 0;
+	if (!m_buffer.Resize(m_nBufferUsed))
+	{
+		//the reference already moved on, so the next frame has to be complete
+		m_rects.clear();
+		m_nBufferUsed = 0;
+		m_bHasReference = false;
+		return 0;
+	}
+
+	for (size_t i = 0; i < m_rects.size(); ++i)
+	{
+		const RawDataDirtyRect& rect = m_rects[i];
+		unsigned int top = m_bFlipVertical ? m_nHeight - rect.y - rect.height : rect.y;
+		I420PlaneView tile = view;
+		tile.pY = view.pY + (size_t)top * view.yStride + rect.x;
+		tile.pU = view.pU + (size_t)(top / 2) * view.uStride + rect.x / 2;
+		tile.pV = view.pV + (size_t)(top / 2) * view.vStride + rect.x / 2;
+		tile.width = rect.width;
+		tile.height = rect.height;
+		m_converter.Convert(tile, m_buffer.GetData() + rect.offset, rect.width * 4, m_format, m_bFlipVertical);
+	}
+	return (unsigned int)m_rects.size();
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,79 @@
+#pragma once
+#include "rawdata_yuv_converter.h"
+#include <vector>
+
+BEGIN_ZOOM_SDK_NAMESPACE
+#define SHARE_TILE_SIZE 64
+
+//One changed area of a share frame, already converted.
+typedef struct tagRawDataDirtyRect
+{
+	unsigned int x;///<Left edge in pixels.
+	unsigned int y;///<First buffer row in pixels. With a flipped tracker this is the bottom edge, as Unity expects.
+	unsigned int width;
+	unsigned int height;
+	unsigned int offset;///<Byte offset of the pixels in the tile buffer, rows are width * 4 bytes.
+}RawDataDirtyRect;
+
+//Turns a stream of share frames into partial updates. Every frame is cut into 64x64 tiles, and tiles whose
+//Y, U or V bytes differ from the previous frame are dirty. Neighbouring dirty tiles of a tile row are merged
+//into one rect, converted to RGBA/BGRA and packed into one buffer, so the consumer only uploads what changed.
+//The comparison is exact, since one changed glyph on a slide must not be lost. The reference copy is only
+//updated inside dirty tiles.
+//The first frame, a size change and Reset() publish the whole frame as one rect, see IsFullFrame().
+//Rotation is ignored, share frames are not rotated. Use one tracker per thread.
+class CRawDataShareTileTracker
+{
+public:
+	CRawDataShareTileTracker();
+
+	//bFlipVertical stores the rows of every rect bottom-up and counts rect.y from the bottom
+	void SetOutputFormat(RawDataPixelFormat format, bool bFlipVertical = true);
+	//the next frame is published in full
+	void Reset();
+	//frees the reference and the tile buffer
+	void Free();
+
+	//returns how many dirty rects the frame produced, 0 when it is identical to the previous one
+	unsigned int Update(const I420PlaneView& frame);
+	unsigned int Update(const CRawDataFrame* pFrame);
+	unsigned int Update(YUVRawDataI420* data);
+
+	//the rects of the last Update(), valid until the next one
+	unsigned int GetRectCount() const { return (unsigned int)m_rects.size(); }
+	const RawDataDirtyRect* GetRects() const { return m_rects.empty() ? NULL : &m_rects[0]; }
+	const unsigned char* GetBuffer() const { return m_buffer.GetData(); }
+	unsigned int GetBufferSize() const { return m_nBufferUsed; }
+	bool IsFullFrame() const { return m_bFullFrame; }
+
+	unsigned int GetFrameWidth() const { return m_nWidth; }
+	unsigned int GetFrameHeight() const { return m_nHeight; }
+	unsigned int GetTileCount() const { return m_nTilesX * m_nTilesY; }
+	unsigned int GetLastDirtyTiles() const { return m_nLastDirtyTiles; }
+
+private:
+	CRawDataShareTileTracker(const CRawDataShareTileTracker&);
+	CRawDataShareTileTracker& operator=(const CRawDataShareTileTracker&);
+
+	bool ResetReference(const I420PlaneView& frame);
+	void MarkDirtyTiles(const I420PlaneView& frame, unsigned int tileY);
+	void AddRect(unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+	void CopyToReference(const I420PlaneView& frame, unsigned int x, unsigned int y, unsigned int width, unsigned int height);
+
+	CRawDataYUVConverter m_converter;
+	CMediaBuffer m_reference;///<Y, U and V of the previous frame, packed without padding.
+	CMediaBuffer m_buffer;
+	std::vector<RawDataDirtyRect> m_rects;
+	std::vector<unsigned char> m_dirty;///<One flag per tile of the current tile row.
+	unsigned int m_nBufferUsed;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+	unsigned int m_nTilesX;
+	unsigned int m_nTilesY;
+	unsigned int m_nLastDirtyTiles;
+	RawDataPixelFormat m_format;
+	bool m_bFlipVertical;
+	bool m_bFullFrame;
+	bool m_bHasReference;
+};
+END_ZOOM_SDK_NAMESPACE
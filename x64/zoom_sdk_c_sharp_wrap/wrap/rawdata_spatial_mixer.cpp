@@ -0,0 +1,299 @@
+#include "rawdata_spatial_mixer.h"
+#include <xmmintrin.h>
+#include <math.h>
+#include <string.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//share of the level moved to the near ear at 90 degrees, 1 would leave the far ear silent
+#define SPATIAL_ILD 0.7f
+//head radius over the speed of sound, in seconds
+#define SPATIAL_HEAD_DELAY (0.0875f / 343.0f)
+
+static inline SpatialVector LoadVector(const volatile LONG* p)
+{
+	SpatialVector v;
+	v.x = MediaAtomicLoadFloat(p);
+	v.y = MediaAtomicLoadFloat(p + 1);
+	v.z = MediaAtomicLoadFloat(p + 2);
+	return v;
+}
+
+static inline void StoreVector(volatile LONG* p, const SpatialVector& v)
+{
+	MediaAtomicStoreFloat(p, v.x);
+	MediaAtomicStoreFloat(p + 1, v.y);
+	MediaAtomicStoreFloat(p + 2, v.z);
+}
+
+static inline float Dot(const SpatialVector& a, const SpatialVector& b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static inline SpatialVector Cross(const SpatialVector& a, const SpatialVector& b)
+{
+	SpatialVector v;
+	v.x = a.y * b.z - a.z * b.y;
+	v.y = a.z * b.x - a.x * b.z;
+	v.z = a.x * b.y - a.y * b.x;
+	return v;
+}
+
+static inline bool Normalize(SpatialVector& v)
+{
+	float len = sqrtf(Dot(v, v));
+	if (len < 1e-6f)
+		return false;
+	v.x /= len;
+	v.y /= len;
+	v.z /= len;
+	return true;
+}
+
+//pAcc[i] += pSrc[i] * gain, with the gain going from g0 on the first sample towards g1 after the last
+static void MixRamp(float* pAcc, const float* pSrc, unsigned int count, float g0, float g1)
+{
+	if (0.0f == g0 && 0.0f == g1)
+		return;
+	float dg = (g1 - g0) / count;
+	__m128 gain = _mm_setr_ps(g0, g0 + dg, g0 + 2.0f * dg, g0 + 3.0f * dg);
+	const __m128 step = _mm_set1_ps(4.0f * dg);
+	unsigned int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 acc = _mm_loadu_ps(pAcc + i);
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(pSrc + i), gain));
+		_mm_storeu_ps(pAcc + i, acc);
+		gain = _mm_add_ps(gain, step);
+	}
+	for (; i < count; ++i)
+		pAcc[i] += pSrc[i] * (g0 + dg * i);
+}
+
+CRawDataSpatialMixer& CRawDataSpatialMixer::GetInst()
+{
+	static CRawDataSpatialMixer inst;
+	return inst;
+}
+
+CRawDataSpatialMixer::CRawDataSpatialMixer()
+{
+	memset(m_params, 0, sizeof(m_params));
+	memset(m_states, 0, sizeof(m_states));
+	SpatialVector position = { 0.0f, 0.0f, 0.0f };
+	SpatialVector forward = { 0.0f, 0.0f, 1.0f };
+	SpatialVector up = { 0.0f, 1.0f, 0.0f };
+	SetListener(position, forward, up);
+	SetDistanceModel(1.0f, 50.0f, 1.0f);
+	m_nLastMixUs = 0;
+}
+
+void CRawDataSpatialMixer::SetListener(const SpatialVector& position, const SpatialVector& forward, const SpatialVector& up)
+{
+	StoreVector(m_listener, position);
+	StoreVector(m_listener + 3, forward);
+	StoreVector(m_listener + 6, up);
+}
+
+bool CRawDataSpatialMixer::SetSource(uint32_t nodeId, const SpatialVector& position, float gain)
+{
+	int free = -1;
+	for (int i = 0; i < SPATIAL_MIXER_MAX_SOURCES; ++i)
+	{
+		SpatialSourceParams& params = m_params[i];
+		if (0 == params.bUsed)
+		{
+			if (free < 0)
+				free = i;
+			continue;
+		}
+		if (nodeId == (uint32_t)params.nodeId)
+		{
+			StoreVector(params.position, position);
+			MediaAtomicStoreFloat(&params.gain, gain);
+			return true;
+		}
+	}
+	if (free < 0)
+		return false;
+
+	SpatialSourceParams& params = m_params[free];
+	MediaAtomicStore(&params.nodeId, (LONG)nodeId);
+	StoreVector(params.position, position);
+	MediaAtomicStoreFloat(&params.gain, gain);
+	MediaAtomicStore(&params.bUsed, 1);
+	return true;
+}
+
+void CRawDataSpatialMixer::RemoveSource(uint32_t nodeId)
+{
+	for (int i = 0; i < SPATIAL_MIXER_MAX_SOURCES; ++i)
+	{
+		if (0 != m_params[i].bUsed && nodeId == (uint32_t)m_params[i].nodeId)
+			MediaAtomicStore(&m_params[i].bUsed, 0);
+	}
+}
+
+void CRawDataSpatialMixer::RemoveAllSources()
+{
+	for (int i = 0; i < SPATIAL_MIXER_MAX_SOURCES; ++i)
+		MediaAtomicStore(&m_params[i].bUsed, 0);
+}
+
+void CRawDataSpatialMixer::SetDistanceModel(float minDistance, float maxDistance, float rolloff)
+{
+	if (minDistance < 0.01f)
+		minDistance = 0.01f;
+	if (maxDistance < minDistance)
+		maxDistance = minDistance;
+	if (rolloff < 0.0f)
+		rolloff = 0.0f;
+	MediaAtomicStoreFloat(&m_distance[0], minDistance);
+	MediaAtomicStoreFloat(&m_distance[1], maxDistance);
+	MediaAtomicStoreFloat(&m_distance[2], rolloff);
+}
+
+unsigned int CRawDataSpatialMixer::MixPass(unsigned int frames, unsigned int sampleRate)
+{
+	memset(m_mix, 0, sizeof(m_mix));
+	CRawDataAudioRingManager& rings = CRawDataAudioRingManager::GetInst();
+
+	SpatialVector listener = LoadVector(m_listener);
+	SpatialVector forward = LoadVector(m_listener + 3);
+	SpatialVector up = LoadVector(m_listener + 6);
+	SpatialVector right = Cross(up, forward);
+	if (!Normalize(right))
+	{
+		right.x = 1.0f;
+		right.y = 0.0f;
+		right.z = 0.0f;
+	}
+	float minDistance = MediaAtomicLoadFloat(&m_distance[0]);
+	float maxDistance = MediaAtomicLoadFloat(&m_distance[1]);
+	float rolloff = MediaAtomicLoadFloat(&m_distance[2]);
+
+	unsigned int sources = 0;
+	for (int i = 0; i < SPATIAL_MIXER_MAX_SOURCES; ++i)
+	{
+		SpatialSourceParams& params = m_params[i];
+		SpatialSourceState& state = m_states[i];
+		bool bUsed = 0 != MediaAtomicLoad(&params.bUsed);
+		uint32_t nodeId = (uint32_t)MediaAtomicLoad(&params.nodeId);
+		//a source that went away or changed hands fades out over this pass, the new one starts on the next
+		bool bLeaving = state.bActive && (!bUsed || nodeId != state.nodeId);
+		if (!bLeaving)
+		{
+			if (!bUsed)
+				continue;
+			if (!state.bActive)
+			{
+				memset(&state, 0, sizeof(state));
+				state.bActive = true;
+				state.nodeId = nodeId;
+			}
+		}
+
+		float* pIn = state.samples + SPATIAL_MIXER_MAX_DELAY;
+		if (rings.Read(state.nodeId, pIn, frames, 1, sampleRate) > 0)
+			++sources;
+
+		float gain[2] = { 0.0f, 0.0f };
+		unsigned int delay[2] = { state.delay[0], state.delay[1] };
+		if (!bLeaving)
+		{
+			SpatialVector position = LoadVector(params.position);
+			SpatialVector v = { position.x - listener.x, position.y - listener.y, position.z - listener.z };
+			float distance = sqrtf(Dot(v, v));
+			float clamped = distance < minDistance ? minDistance : (distance > maxDistance ? maxDistance : distance);
+			float level = MediaAtomicLoadFloat(&params.gain) * minDistance / (minDistance + rolloff * (clamped - minDistance));
+
+			float lateral = distance > 1e-4f ? Dot(v, right) / distance : 0.0f;
+			lateral = lateral < -1.0f ? -1.0f : (lateral > 1.0f ? 1.0f : lateral);
+			gain[0] = level * sqrtf(0.5f * (1.0f - SPATIAL_ILD * lateral));
+			gain[1] = level * sqrtf(0.5f * (1.0f + SPATIAL_ILD * lateral));
+
+			//Woodworth's spherical head, lateral is the sine of the angle off the median plane
+			float angle = asinf(lateral < 0.0f ? -lateral : lateral);
+			unsigned int itd = (unsigned int)(SPATIAL_HEAD_DELAY * (angle + sinf(angle)) * sampleRate + 0.5f);
+			if (itd > SPATIAL_MIXER_MAX_DELAY)
+				itd = SPATIAL_MIXER_MAX_DELAY;
+			delay[0] = lateral > 0.0f ? itd : 0;
+			delay[1] = lateral > 0.0f ? 0 : itd;
+		}
+
+		for (int ear = 0; ear < 2; ++ear)
+		{
+			if (delay[ear] == state.delay[ear])
+			{
+				MixRamp(m_mix[ear], pIn - delay[ear], frames, state.gain[ear], gain[ear]);
+			}
+			else
+			{
+				//crossfade from the old delay to the new one, a jump in the delay would click
+				MixRamp(m_mix[ear], pIn - state.delay[ear], frames, state.gain[ear], 0.0f);
+				MixRamp(m_mix[ear], pIn - delay[ear], frames, 0.0f, gain[ear]);
+			}
+			state.gain[ear] = gain[ear];
+			state.delay[ear] = delay[ear];
+		}
+		memmove(state.samples, state.samples + frames, SPATIAL_MIXER_MAX_DELAY * sizeof(float));
+		if (bLeaving)
+			state.bActive = false;
+	}
+	return sources;
+}
+
+unsigned int CRawDataSpatialMixer::Mix(float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate)
+{
+	if (NULL == pOut || 0 == channels || 0 == sampleRate)
+		return 0;
+
+	long long startUs = MediaGetTimeUs();
+	unsigned int sources = 0;
+	for (unsigned int done = 0; done < frames;)
+	{
+		unsigned int count = frames - done < SPATIAL_MIXER_BLOCK ? frames - done : SPATIAL_MIXER_BLOCK;
+		unsigned int mixed = MixPass(count, sampleRate);
+		if (mixed > sources)
+			sources = mixed;
+
+		float* pDst = pOut + (size_t)done * channels;
+		const float* pLeft = m_mix[0];
+		const float* pRight = m_mix[1];
+		unsigned int i = 0;
+		if (2 == channels)
+		{
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128 l = _mm_loadu_ps(pLeft + i);
+				__m128 r = _mm_loadu_ps(pRight + i);
+				_mm_storeu_ps(pDst + i * 2, _mm_unpacklo_ps(l, r));
+				_mm_storeu_ps(pDst + i * 2 + 4, _mm_unpackhi_ps(l, r));
+			}
+			for (; i < count; ++i)
+			{
+				pDst[i * 2] = pLeft[i];
+				pDst[i * 2 + 1] = pRight[i];
+			}
+		}
+		else if (1 == channels)
+		{
+			for (; i < count; ++i)
+				pDst[i] = (pLeft[i] + pRight[i]) * 0.5f;
+		}
+		else
+		{
+			for (; i < count; ++i)
+			{
+				float* pFrame = pDst + (size_t)i * channels;
+				pFrame[0] = pLeft[i];
+				pFrame[1] = pRight[i];
+				for (unsigned int c = 2; c < channels; ++c)
+					pFrame[c] = 0.0f;
+			}
+		}
+		done += count;
+	}
+	MediaAtomicStore64(&m_nLastMixUs, MediaGetTimeUs() - startUs);
+	return sources;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,79 @@
+#pragma once
+#include "rawdata_audio_ring.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define SPATIAL_MIXER_MAX_SOURCES 64
+//frames mixed per pass, longer Mix() calls are cut into passes of this size
+#define SPATIAL_MIXER_BLOCK 512
+//longest interaural delay in samples, about 0.66 ms at 96 kHz
+#define SPATIAL_MIXER_MAX_DELAY 64
+
+typedef struct tagSpatialVector
+{
+	float x;
+	float y;
+	float z;
+}SpatialVector;
+
+//Mixes the speakers of CRawDataAudioRingManager to stereo from the positions of their avatars, in the engine's
+//coordinates. Each source is attenuated with distance like a logarithmic rolloff, panned by level (ILD) and the far
+//ear is delayed by the time sound needs around the head (ITD). Gains and delays move smoothly from one pass to the
+//next, so avatars walking around do not click.
+//The listener and sources are set from one thread, typically the engine's main thread, and picked up on the next
+//pass. Mix() runs on one other thread, typically the engine's audio thread, and neither locks nor allocates. It
+//reads the rings itself, so it takes the place of CRawDataAudioRingManager::Read() for the sources it mixes.
+class CRawDataSpatialMixer
+{
+public:
+	static CRawDataSpatialMixer& GetInst();
+
+	//forward and up need not be normalized, the mixer's right ear is on up x forward
+	void SetListener(const SpatialVector& position, const SpatialVector& forward, const SpatialVector& up);
+	//adds the speaker or moves it. gain 1 keeps the speaker's level. Returns false when every source is taken.
+	bool SetSource(uint32_t nodeId, const SpatialVector& position, float gain);
+	void RemoveSource(uint32_t nodeId);
+	void RemoveAllSources();
+	//full level up to minDistance, then minDistance / (minDistance + rolloff * (distance - minDistance)) up to
+	//maxDistance, where it stays
+	void SetDistanceModel(float minDistance, float maxDistance, float rolloff);
+
+	//writes frames of the mix to pOut, interleaved with channels per frame: left and right on the first two, the
+	//rest silent, or both averaged for mono. Returns the sources that had audio.
+	unsigned int Mix(float* pOut, unsigned int frames, unsigned int channels, unsigned int sampleRate);
+	//time the last Mix() took, in microseconds
+	long long GetLastMixUs() const { return (long long)MediaAtomicLoad64(&m_nLastMixUs); }
+
+private:
+	CRawDataSpatialMixer();
+	CRawDataSpatialMixer(const CRawDataSpatialMixer&);
+	CRawDataSpatialMixer& operator=(const CRawDataSpatialMixer&);
+
+	//set by the control thread, floats go through MediaAtomicStoreFloat()
+	typedef struct tagSpatialSourceParams
+	{
+		volatile LONG bUsed;
+		volatile LONG nodeId;
+		volatile LONG position[3];
+		volatile LONG gain;
+	}SpatialSourceParams;
+
+	//owned by the mixing thread
+	typedef struct tagSpatialSourceState
+	{
+		bool bActive;
+		uint32_t nodeId;
+		float gain[2];///<Left and right gain of the last pass.
+		unsigned int delay[2];///<Left and right delay of the last pass, in samples.
+		float samples[SPATIAL_MIXER_MAX_DELAY + SPATIAL_MIXER_BLOCK];///<Delay history followed by this pass.
+	}SpatialSourceState;
+
+	unsigned int MixPass(unsigned int frames, unsigned int sampleRate);
+
+	SpatialSourceParams m_params[SPATIAL_MIXER_MAX_SOURCES];
+	volatile LONG m_listener[9];///<Position, forward and up.
+	volatile LONG m_distance[3];///<Min distance, max distance and rolloff.
+
+	SpatialSourceState m_states[SPATIAL_MIXER_MAX_SOURCES];
+	float m_mix[2][SPATIAL_MIXER_BLOCK];
+	volatile LONGLONG m_nLastMixUs;
+};
+END_ZOOM_SDK_NAMESPACE
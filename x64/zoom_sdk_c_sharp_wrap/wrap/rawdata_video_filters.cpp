@@ -0,0 +1,248 @@
+#include "rawdata_video_filters.h"
+#include <math.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+static inline int ClampLevel(int v, int lo, int hi)
+{
+	return v < lo ? lo : (v > hi ? hi : v);
+}
+
+static inline unsigned char ScaleToward(int v, int center, int gain)
+{
+	return (unsigned char)(center + (((v - center) * gain + 128) >> 8));
+}
+
+static float Clamp01(float v)
+{
+	return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+CRawDataBrightnessContrastFilter::CRawDataBrightnessContrastFilter()
+{
+	m_nBrightness = 0;
+	m_fContrast = 1.0f;
+	m_bEnabled = false;
+	m_bDirty = true;
+	m_bLimited = true;
+	for (int i = 0; i < 256; ++i)
+		m_lut[i] = (unsigned char)i;
+}
+
+void CRawDataBrightnessContrastFilter::SetParams(int brightness, float contrast)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nBrightness = ClampLevel(brightness, -255, 255);
+	m_fContrast = contrast < 0.0f ? 0.0f : contrast;
+	m_bDirty = true;
+}
+
+void CRawDataBrightnessContrastFilter::Enable(bool bEnable)
+{
+	CMediaAutoLock lock(m_lock);
+	m_bEnabled = bEnable;
+}
+
+bool CRawDataBrightnessContrastFilter::Prepare(const I420MutableView& frame)
+{
+	CMediaAutoLock lock(m_lock);
+	if (!m_bEnabled || (0 == m_nBrightness && 1.0f == m_fContrast))
+		return false;
+	if (m_bDirty || m_bLimited != frame.bLimited)
+	{
+		int lo = frame.bLimited ? 16 : 0;
+		int hi = frame.bLimited ? 235 : 255;
+		float mid = (lo + hi) * 0.5f;
+		for (int i = 0; i < 256; ++i)
+			m_lut[i] = (unsigned char)ClampLevel((int)floorf((i - mid) * m_fContrast + mid + m_nBrightness + 0.5f), lo, hi);
+		m_bLimited = frame.bLimited;
+		m_bDirty = false;
+	}
+	return true;
+}
+
+void CRawDataBrightnessContrastFilter::Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd)
+{
+	for (unsigned int y = yBegin; y < yEnd; ++y)
+	{
+		unsigned char* pRow = frame.pY + (size_t)y * frame.yStride;
+		for (unsigned int x = 0; x < frame.width; ++x)
+			pRow[x] = m_lut[pRow[x]];
+	}
+}
+/////////////////////////////////////////////////////////////////////////
+#define VIGNETTE_EDGE 512
+
+CRawDataVignetteFilter::CRawDataVignetteFilter()
+{
+	m_fStrength = 0.5f;
+	m_fRadius = 0.5f;
+	m_bEnabled = false;
+	m_bDirty = true;
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+void CRawDataVignetteFilter::SetParams(float strength, float radius)
+{
+	CMediaAutoLock lock(m_lock);
+	m_fStrength = Clamp01(strength);
+	m_fRadius = Clamp01(radius);
+	m_bDirty = true;
+}
+
+void CRawDataVignetteFilter::Enable(bool bEnable)
+{
+	CMediaAutoLock lock(m_lock);
+	m_bEnabled = bEnable;
+}
+
+static void BuildVignetteDistances(std::vector<unsigned short>& table, unsigned int size)
+{
+	table.resize(size);
+	float center = (size - 1) * 0.5f;
+	float half = size * 0.5f;
+	for (unsigned int i = 0; i < size; ++i)
+	{
+		float d = (i - center) / half;
+		table[i] = (unsigned short)ClampLevel((int)(d * d * VIGNETTE_EDGE + 0.5f), 0, VIGNETTE_EDGE);
+	}
+}
+
+bool CRawDataVignetteFilter::Prepare(const I420MutableView& frame)
+{
+	CMediaAutoLock lock(m_lock);
+	if (!m_bEnabled || m_fStrength <= 0.0f)
+		return false;
+	if (m_nWidth != frame.width || m_nHeight != frame.height)
+	{
+		BuildVignetteDistances(m_dx, frame.width);
+		BuildVignetteDistances(m_dy, frame.height);
+		m_nWidth = frame.width;
+		m_nHeight = frame.height;
+	}
+	if (m_bDirty)
+	{
+		//dx + dy is the squared elliptical distance, 2 * VIGNETTE_EDGE in the corners
+		m_gain.resize(2 * VIGNETTE_EDGE + 1);
+		for (int i = 0; i <= 2 * VIGNETTE_EDGE; ++i)
+		{
+			float r = sqrtf(i / (2.0f * VIGNETTE_EDGE));
+			float t = m_fRadius >= 1.0f ? 0.0f : Clamp01((r - m_fRadius) / (1.0f - m_fRadius));
+			t = t * t * (3.0f - 2.0f * t);
+			m_gain[i] = (unsigned short)((1.0f - m_fStrength * t) * 256.0f + 0.5f);
+		}
+		m_bDirty = false;
+	}
+	return true;
+}
+
+void CRawDataVignetteFilter::Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd)
+{
+	const unsigned short* pDx = &m_dx[0];
+	const unsigned short* pGain = &m_gain[0];
+	int black = frame.bLimited ? 16 : 0;
+	for (unsigned int y = yBegin; y < yEnd; ++y)
+	{
+		unsigned char* pRow = frame.pY + (size_t)y * frame.yStride;
+		const unsigned short* pRowGain = pGain + m_dy[y];
+		for (unsigned int x = 0; x < frame.width; ++x)
+		{
+			if (pRow[x] > black)
+				pRow[x] = ScaleToward(pRow[x], black, pRowGain[pDx[x]]);
+		}
+	}
+
+	//chroma sample (x, y) sits on luma (2x, 2y)
+	unsigned int uvWidth = (frame.width + 1) / 2;
+	for (unsigned int y = yBegin / 2; y < (yEnd + 1) / 2; ++y)
+	{
+		unsigned char* pU = frame.pU + (size_t)y * frame.uStride;
+		unsigned char* pV = frame.pV + (size_t)y * frame.vStride;
+		const unsigned short* pRowGain = pGain + m_dy[y * 2];
+		for (unsigned int x = 0; x < uvWidth; ++x)
+		{
+			int gain = pRowGain[pDx[x * 2]];
+			pU[x] = ScaleToward(pU[x], 128, gain);
+			pV[x] = ScaleToward(pV[x], 128, gain);
+		}
+	}
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataBackgroundDimFilter::CRawDataBackgroundDimFilter()
+{
+	m_nThreshold = 60;
+	m_nSoftness = 16;
+	m_fAmount = 0.5f;
+	m_bEnabled = false;
+	m_bDirty = true;
+	m_bLimited = true;
+}
+
+void CRawDataBackgroundDimFilter::SetParams(int threshold, int softness, float amount)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nThreshold = ClampLevel(threshold, 0, 255);
+	m_nSoftness = ClampLevel(softness, 0, 255);
+	m_fAmount = Clamp01(amount);
+	m_bDirty = true;
+}
+
+void CRawDataBackgroundDimFilter::Enable(bool bEnable)
+{
+	CMediaAutoLock lock(m_lock);
+	m_bEnabled = bEnable;
+}
+
+bool CRawDataBackgroundDimFilter::Prepare(const I420MutableView& frame)
+{
+	CMediaAutoLock lock(m_lock);
+	if (!m_bEnabled || m_fAmount <= 0.0f)
+		return false;
+	if (m_bDirty || m_bLimited != frame.bLimited)
+	{
+		int black = frame.bLimited ? 16 : 0;
+		for (int i = 0; i < 256; ++i)
+		{
+			//1 for background, 0 for foreground, a linear ramp across threshold +- softness
+			float background = 0.0f;
+			if (i <= m_nThreshold - m_nSoftness)
+				background = 1.0f;
+			else if (i < m_nThreshold + m_nSoftness)
+				background = (m_nThreshold + m_nSoftness - i) / (2.0f * m_nSoftness);
+			int gain = (int)((1.0f - m_fAmount * background) * 256.0f + 0.5f);
+			m_gain[i] = (unsigned short)gain;
+			m_luma[i] = i > black ? ScaleToward(i, black, gain) : (unsigned char)i;
+		}
+		m_bLimited = frame.bLimited;
+		m_bDirty = false;
+	}
+	return true;
+}
+
+void CRawDataBackgroundDimFilter::Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd)
+{
+	unsigned int uvWidth = (frame.width + 1) / 2;
+	for (unsigned int y = yBegin; y < yEnd; y += 2)
+	{
+		unsigned char* pRow0 = frame.pY + (size_t)y * frame.yStride;
+		unsigned char* pRow1 = y + 1 < yEnd ? pRow0 + frame.yStride : pRow0;
+		unsigned char* pU = frame.pU + (size_t)(y / 2) * frame.uStride;
+		unsigned char* pV = frame.pV + (size_t)(y / 2) * frame.vStride;
+		//chroma first, it is keyed on the luma before dimming
+		for (unsigned int x = 0; x < uvWidth; ++x)
+		{
+			unsigned int x0 = x * 2;
+			unsigned int x1 = x0 + 1 < frame.width ? x0 + 1 : x0;
+			int gain = m_gain[(pRow0[x0] + pRow0[x1] + pRow1[x0] + pRow1[x1] + 2) >> 2];
+			pU[x] = ScaleToward(pU[x], 128, gain);
+			pV[x] = ScaleToward(pV[x], 128, gain);
+		}
+		for (unsigned int x = 0; x < frame.width; ++x)
+			pRow0[x] = m_luma[pRow0[x]];
+		if (pRow1 != pRow0)
+		{
+			for (unsigned int x = 0; x < frame.width; ++x)
+				pRow1[x] = m_luma[pRow1[x]];
+		}
+	}
+}
+END_ZOOM_SDK_NAMESPACE
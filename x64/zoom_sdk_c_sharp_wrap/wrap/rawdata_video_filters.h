@@ -0,0 +1,83 @@
+#pragma once
+#include "rawdata_preprocess_pipeline.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//Filters for CRawDataPreprocessPipeline. Setters may be called from any thread, the values are picked up by
+//Prepare() on the next frame. All of them are disabled until enabled, and keep the frame in its range.
+
+//Brightness and contrast through a 256 entry luma table, chroma is left alone.
+class CRawDataBrightnessContrastFilter : public IRawDataVideoFilter
+{
+public:
+	CRawDataBrightnessContrastFilter();
+
+	//brightness is added to luma (-255 to 255), contrast scales it around mid gray (1 keeps it)
+	void SetParams(int brightness, float contrast);
+	void Enable(bool bEnable);
+
+	virtual bool Prepare(const I420MutableView& frame);
+	virtual void Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd);
+
+private:
+	CMediaLock m_lock;
+	int m_nBrightness;
+	float m_fContrast;
+	bool m_bEnabled;
+	bool m_bDirty;
+	bool m_bLimited;///<Range the table was built for.
+	unsigned char m_lut[256];
+};
+
+//Darkens the frame towards the corners along an ellipse fitted to the frame.
+class CRawDataVignetteFilter : public IRawDataVideoFilter
+{
+public:
+	CRawDataVignetteFilter();
+
+	//strength 0 to 1 is how dark the corners get, radius 0 to 1 is where the falloff starts
+	//as a fraction of the center-to-corner distance
+	void SetParams(float strength, float radius);
+	void Enable(bool bEnable);
+
+	virtual bool Prepare(const I420MutableView& frame);
+	virtual void Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd);
+
+private:
+	CMediaLock m_lock;
+	float m_fStrength;
+	float m_fRadius;
+	bool m_bEnabled;
+	bool m_bDirty;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+	std::vector<unsigned short> m_dx;///<Squared horizontal distance per luma column, 512 at the frame edge.
+	std::vector<unsigned short> m_dy;///<The same per luma row.
+	std::vector<unsigned short> m_gain;///<Gain in 8.8 fixed point, indexed by dx + dy.
+};
+
+//Treats pixels darker than a luma threshold as background and dims them, so a person lit in front of a
+//dark room stands out. Chroma of a 2x2 block follows the block's average luma.
+class CRawDataBackgroundDimFilter : public IRawDataVideoFilter
+{
+public:
+	CRawDataBackgroundDimFilter();
+
+	//threshold and softness are luma levels, amount 0 to 1 is how far background is dimmed
+	void SetParams(int threshold, int softness, float amount);
+	void Enable(bool bEnable);
+
+	virtual bool Prepare(const I420MutableView& frame);
+	virtual void Process(const I420MutableView& frame, unsigned int yBegin, unsigned int yEnd);
+
+private:
+	CMediaLock m_lock;
+	int m_nThreshold;
+	int m_nSoftness;
+	float m_fAmount;
+	bool m_bEnabled;
+	bool m_bDirty;
+	bool m_bLimited;
+	unsigned char m_luma[256];///<Dimmed luma per input luma.
+	unsigned short m_gain[256];///<Chroma gain in 8.8 fixed point per block luma.
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,156 @@
+#include "rawdata_video_send_controller.h"
+#include "meeting_service_interface.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define VIDEO_SEND_SAMPLE_MS 1000
+//statistics are averaged over a few seconds, a reading right after a step down still shows the old level
+#define VIDEO_SEND_SETTLE_MS 3000
+#define VIDEO_SEND_PROBE_MS 10000
+#define VIDEO_SEND_HOLD_MIN_MS 5000
+#define VIDEO_SEND_HOLD_MAX_MS 80000
+
+static const RawDataVideoSendLevel s_levels[] =
+{
+	{ 0, 0, 0 },
+	{ 1280, 720, 30 },
+	{ 1280, 720, 20 },
+	{ 960, 540, 15 },
+	{ 640, 360, 15 },
+	{ 640, 360, 10 },
+	{ 320, 180, 10 },
+};
+#define VIDEO_SEND_LEVEL_COUNT (sizeof(s_levels) / sizeof(s_levels[0]))
+
+//levels to step down by, or -1 for a clean reading and 0 for one in between
+static int ClassifyReading(const RawDataVideoSendStats& stats)
+{
+	if (Conn_Quality_Very_Bad == stats.quality || stats.packetLossAvg >= 10.0f || stats.latencyMs >= 800)
+		return 2;
+	if (Conn_Quality_Bad == stats.quality || stats.packetLossAvg >= 3.0f || stats.packetLossMax >= 15.0f
+		|| stats.jitterMs >= 80 || stats.latencyMs >= 400)
+		return 1;
+	if ((Conn_Quality_Unknow == stats.quality || stats.quality >= Conn_Quality_Normal)
+		&& stats.packetLossAvg < 1.0f && stats.packetLossMax < 5.0f && stats.jitterMs < 40 && stats.latencyMs < 250)
+		return -1;
+	return 0;
+}
+
+CRawDataVideoSendController& CRawDataVideoSendController::GetInst()
+{
+	static CRawDataVideoSendController inst;
+	return inst;
+}
+
+CRawDataVideoSendController::CRawDataVideoSendController()
+{
+	m_pCamera = NULL;
+	m_nLevel = 0;
+	m_nNextSampleMs = 0;
+	m_nCleanSinceMs = -1;
+	m_nNoStepDownUntilMs = 0;
+	m_nProbeUntilMs = 0;
+	m_nHoldMs = VIDEO_SEND_HOLD_MIN_MS;
+}
+
+void CRawDataVideoSendController::SetCamera(CRawDataVirtualCamera* pCamera)
+{
+	CMediaAutoLock lock(m_lock);
+	m_pCamera = pCamera;
+	if (m_pCamera)
+	{
+		RawDataVideoSendLevel limit = s_levels[m_nLevel];
+		m_pCamera->SetSendLimit(limit.width, limit.height, limit.fps);
+	}
+}
+
+void CRawDataVideoSendController::Reset()
+{
+	CMediaAutoLock lock(m_lock);
+	m_nNextSampleMs = 0;
+	m_nCleanSinceMs = -1;
+	m_nNoStepDownUntilMs = 0;
+	m_nProbeUntilMs = 0;
+	m_nHoldMs = VIDEO_SEND_HOLD_MIN_MS;
+	SetLevel(0);
+}
+
+unsigned int CRawDataVideoSendController::GetLevel()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return m_nLevel;
+}
+
+unsigned int CRawDataVideoSendController::GetLevelCount()
+{
+	return (unsigned int)VIDEO_SEND_LEVEL_COUNT;
+}
+
+RawDataVideoSendLevel CRawDataVideoSendController::GetLevelLimit(unsigned int level)
+{
+	return s_levels[level < VIDEO_SEND_LEVEL_COUNT ? level : VIDEO_SEND_LEVEL_COUNT - 1];
+}
+
+bool CRawDataVideoSendController::IsDue(long long nowMs)
+{
+	CMediaAutoLock lock(m_lock, true);
+	return nowMs >= m_nNextSampleMs;
+}
+
+void CRawDataVideoSendController::SetLevel(unsigned int level)
+{
+	m_nLevel = level;
+	m_nCleanSinceMs = -1;
+	if (m_pCamera)
+	{
+		RawDataVideoSendLevel limit = s_levels[level];
+		m_pCamera->SetSendLimit(limit.width, limit.height, limit.fps);
+	}
+}
+
+bool CRawDataVideoSendController::Update(const RawDataVideoSendStats& stats, long long nowMs)
+{
+	CMediaAutoLock lock(m_lock);
+	if (nowMs < m_nNextSampleMs)
+		return false;
+	m_nNextSampleMs = nowMs + VIDEO_SEND_SAMPLE_MS;
+
+	int steps = ClassifyReading(stats);
+	if (steps > 0)
+	{
+		m_nCleanSinceMs = -1;
+		if (nowMs < m_nNoStepDownUntilMs || m_nLevel + 1 >= VIDEO_SEND_LEVEL_COUNT)
+			return false;
+		//the last step up was too much for the link, wait longer before trying it again
+		if (nowMs < m_nProbeUntilMs)
+		{
+			m_nHoldMs = m_nHoldMs * 2 < VIDEO_SEND_HOLD_MAX_MS ? m_nHoldMs * 2 : VIDEO_SEND_HOLD_MAX_MS;
+			m_nProbeUntilMs = 0;
+		}
+		unsigned int level = m_nLevel + steps;
+		SetLevel(level < VIDEO_SEND_LEVEL_COUNT ? level : VIDEO_SEND_LEVEL_COUNT - 1);
+		m_nNoStepDownUntilMs = nowMs + VIDEO_SEND_SETTLE_MS;
+		return true;
+	}
+
+	if (steps < 0)
+	{
+		//a step up that held through the probe window earns back some of the hold
+		if (m_nProbeUntilMs > 0 && nowMs >= m_nProbeUntilMs)
+		{
+			m_nHoldMs = m_nHoldMs / 2 > VIDEO_SEND_HOLD_MIN_MS ? m_nHoldMs / 2 : VIDEO_SEND_HOLD_MIN_MS;
+			m_nProbeUntilMs = 0;
+		}
+		if (0 == m_nLevel)
+			return false;
+		if (m_nCleanSinceMs < 0)
+			m_nCleanSinceMs = nowMs;
+		if (nowMs - m_nCleanSinceMs < m_nHoldMs)
+			return false;
+		SetLevel(m_nLevel - 1);
+		m_nProbeUntilMs = nowMs + VIDEO_SEND_PROBE_MS;
+		return true;
+	}
+
+	m_nCleanSinceMs = -1;
+	return false;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,71 @@
+#pragma once
+#include "rawdata_virtual_camera.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//One reading of the sending side, from IStatisticSettingContext::QueryVideoStatisticInfo() and
+//IMeetingServiceWrap::GetVideoConnQuality(true).
+typedef struct tagRawDataVideoSendStats
+{
+	int quality;///<ConnectionQuality, Conn_Quality_Unknow when the sdk has no verdict yet.
+	float packetLossAvg;///<Sending average packet loss, unit: %.
+	float packetLossMax;///<Sending max packet loss, unit: %.
+	int jitterMs;///<Sending jitter.
+	int latencyMs;///<Sending latency.
+
+	tagRawDataVideoSendStats()
+	{
+		quality = 0;
+		packetLossAvg = 0.0f;
+		packetLossMax = 0.0f;
+		jitterMs = 0;
+		latencyMs = 0;
+	}
+}RawDataVideoSendStats;
+
+typedef struct tagRawDataVideoSendLevel
+{
+	unsigned int width;///<0 for no limit.
+	unsigned int height;
+	unsigned int fps;
+}RawDataVideoSendLevel;
+
+//Steps the send limit of CRawDataVirtualCamera down a ladder of sizes and frame rates while the sending side is
+//congested, so the avatar video does not take the bandwidth our own audio needs, and back up once it recovered.
+//A congested reading steps down at once, a clean link has to hold for a while before each step up. When a step up
+//has to be taken back within the probe window, the hold doubles, so a link that cannot carry more is not probed
+//every few seconds. Update() is meant for a single thread, the sdk calls behind the readings are not thread safe.
+class CRawDataVideoSendController
+{
+public:
+	static CRawDataVideoSendController& GetInst();
+
+	//camera the limit is applied to, NULL to stop applying it
+	void SetCamera(CRawDataVirtualCamera* pCamera);
+	//back to the top level with the limit lifted and the hold reset
+	void Reset();
+
+	//true when a reading is due, so the caller can skip querying the sdk on most frames
+	bool IsDue(long long nowMs);
+	//feeds a reading, returns true when the level changed. Readings before IsDue() are ignored.
+	bool Update(const RawDataVideoSendStats& stats, long long nowMs);
+
+	//0 is the top level, without a limit
+	unsigned int GetLevel();
+	static unsigned int GetLevelCount();
+	static RawDataVideoSendLevel GetLevelLimit(unsigned int level);
+
+private:
+	CRawDataVideoSendController();
+	CRawDataVideoSendController(const CRawDataVideoSendController&);
+	CRawDataVideoSendController& operator=(const CRawDataVideoSendController&);
+	void SetLevel(unsigned int level);
+
+	CMediaLock m_lock;
+	CRawDataVirtualCamera* m_pCamera;
+	unsigned int m_nLevel;
+	long long m_nNextSampleMs;
+	long long m_nCleanSinceMs;///<Start of the current run of clean readings, -1 outside of one.
+	long long m_nNoStepDownUntilMs;///<Readings still describe the level before the last step down until then.
+	long long m_nProbeUntilMs;///<Congestion before this undoes the last step up.
+	long long m_nHoldMs;///<Clean time needed before the next step up.
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,235 @@
+#include "rawdata_virtual_camera.h"
+#include <math.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//aspect ratios closer than this, as a log ratio, count as equal
+#define VIRTUAL_CAMERA_ASPECT_TOLERANCE 0.05
+
+CRawDataVirtualCamera& CRawDataVirtualCamera::GetInst()
+{
+	static CRawDataVirtualCamera inst;
+	return inst;
+}
+
+CRawDataVirtualCamera::CRawDataVirtualCamera()
+{
+	m_bQuit = 0;
+	m_bSending = 0;
+	m_nSent = 0;
+	m_nThrottled = 0;
+	m_nNextSendUs = 0;
+	m_pSender = NULL;
+	m_nTargetWidth = 0;
+	m_nTargetHeight = 0;
+	m_nTargetFps = 0;
+	m_nLimitWidth = 0;
+	m_nLimitHeight = 0;
+	m_nLimitFps = 0;
+}
+
+void CRawDataVirtualCamera::SetTargetSize(unsigned int width, unsigned int height, unsigned int fps)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nTargetWidth = width;
+	m_nTargetHeight = height;
+	m_nTargetFps = fps;
+}
+
+void CRawDataVirtualCamera::SetSendLimit(unsigned int width, unsigned int height, unsigned int fps)
+{
+	CMediaAutoLock lock(m_lock);
+	m_nLimitWidth = width;
+	m_nLimitHeight = height;
+	m_nLimitFps = fps;
+}
+
+VideoSourceCapability CRawDataVirtualCamera::GetCapability()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return m_capability;
+}
+
+static double AspectDistance(unsigned int width, unsigned int height, unsigned int targetWidth, unsigned int targetHeight)
+{
+	return fabs(log(((double)width * targetHeight) / ((double)height * targetWidth)));
+}
+
+//true when a is a better match for the target than b
+static bool IsBetterCapability(const VideoSourceCapability& a, const VideoSourceCapability& b, unsigned int width, unsigned int height, unsigned int fps)
+{
+	bool bCoversA = a.width >= width && a.height >= height;
+	bool bCoversB = b.width >= width && b.height >= height;
+	if (bCoversA != bCoversB)
+		return bCoversA;
+
+	double aspectA = AspectDistance(a.width, a.height, width, height);
+	double aspectB = AspectDistance(b.width, b.height, width, height);
+	if (fabs(aspectA - aspectB) > VIRTUAL_CAMERA_ASPECT_TOLERANCE)
+		return aspectA < aspectB;
+
+	//no more pixels than needed when covering, as many as possible otherwise
+	unsigned long long areaA = (unsigned long long)a.width * a.height;
+	unsigned long long areaB = (unsigned long long)b.width * b.height;
+	if (areaA != areaB)
+		return bCoversA ? areaA < areaB : areaA > areaB;
+
+	//a frame rate at or above the target beats any below it
+	unsigned int fpsA = a.frame >= fps ? a.frame - fps : (fps - a.frame) * 1000;
+	unsigned int fpsB = b.frame >= fps ? b.frame - fps : (fps - b.frame) * 1000;
+	return fpsA < fpsB;
+}
+
+bool CRawDataVirtualCamera::SelectCapability(IList<VideoSourceCapability >* pList, unsigned int width, unsigned int height, unsigned int fps, VideoSourceCapability& cap)
+{
+	if (NULL == pList || 0 == width || 0 == height)
+		return false;
+
+	bool bFound = false;
+	int count = pList->GetCount();
+	for (int i = 0; i < count; ++i)
+	{
+		VideoSourceCapability item = pList->GetItem(i);
+		if (0 == item.width || 0 == item.height)
+			continue;
+		if (!bFound || IsBetterCapability(item, cap, width, height, fps))
+		{
+			cap = item;
+			bFound = true;
+		}
+	}
+	return bFound;
+}
+
+void CRawDataVirtualCamera::onInitialize(IZoomSDKVideoSender* sender, IList<VideoSourceCapability >* support_cap_list, VideoSourceCapability& suggest_cap)
+{
+	CMediaAutoLock lock(m_lock);
+	m_pSender = sender;
+	VideoSourceCapability cap;
+	if (SelectCapability(support_cap_list, m_nTargetWidth, m_nTargetHeight, m_nTargetFps, cap))
+		suggest_cap = cap;
+	m_capability = suggest_cap;
+}
+
+void CRawDataVirtualCamera::onPropertyChange(IList<VideoSourceCapability >* support_cap_list, VideoSourceCapability suggest_cap)
+{
+	CMediaAutoLock lock(m_lock);
+	VideoSourceCapability cap;
+	m_capability = SelectCapability(support_cap_list, m_nTargetWidth, m_nTargetHeight, m_nTargetFps, cap) ? cap : suggest_cap;
+}
+
+void CRawDataVirtualCamera::onStartSend()
+{
+	MediaAtomicStore(&m_bSending, 1);
+}
+
+void CRawDataVirtualCamera::onStopSend()
+{
+	MediaAtomicStore(&m_bSending, 0);
+}
+
+void CRawDataVirtualCamera::onUninitialized()
+{
+	//waits for a send in progress on the worker
+	CMediaAutoLock lock(m_lock);
+	MediaAtomicStore(&m_bSending, 0);
+	m_pSender = NULL;
+	m_capability.Reset();
+}
+
+bool CRawDataVirtualCamera::Start()
+{
+	if (m_thread.IsStarted())
+		return true;
+	m_mailbox.Reset();
+	m_nNextSendUs = 0;
+	MediaAtomicStore(&m_bQuit, 0);
+	return m_thread.Start(WorkerProc, this);
+}
+
+void CRawDataVirtualCamera::Stop()
+{
+	if (!m_thread.IsStarted())
+		return;
+	MediaAtomicStore(&m_bQuit, 1);
+	m_event.Set();
+	m_thread.Join();
+	m_mailbox.Free();
+	m_image.Free();
+	m_scaled.Free();
+}
+
+bool CRawDataVirtualCamera::PushFrame(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	//nothing would be sent, the host can skip reading the frame back from the gpu
+	if (!m_thread.IsStarted() || !IsSending())
+		return false;
+	if (!m_mailbox.Push(pRGBA, width, height, stride, format, bFlipVertical))
+		return false;
+	m_event.Set();
+	return true;
+}
+
+void CRawDataVirtualCamera::WorkerProc(void* pParam)
+{
+	((CRawDataVirtualCamera*)pParam)->WorkerLoop();
+}
+
+void CRawDataVirtualCamera::WorkerLoop()
+{
+	while (0 == MediaAtomicLoad(&m_bQuit))
+	{
+		m_event.Wait(100);
+		RawDataRGBAFrame* pFrame = m_mailbox.Take();
+		if (pFrame)
+			SendFrame(*pFrame);
+	}
+}
+
+void CRawDataVirtualCamera::SendFrame(const RawDataRGBAFrame& frame)
+{
+	if (!IsSending())
+		return;
+
+	VideoSourceCapability cap;
+	unsigned int limitWidth, limitHeight, limitFps;
+	{
+		CMediaAutoLock lock(m_lock, true);
+		cap = m_capability;
+		limitWidth = m_nLimitWidth;
+		limitHeight = m_nLimitHeight;
+		limitFps = m_nLimitFps;
+	}
+
+	//skipped before the conversion, a throttled frame costs nothing
+	if (limitFps > 0 && (0 == cap.frame || limitFps < cap.frame))
+	{
+		long long nowUs = MediaGetTimeUs();
+		long long intervalUs = 1000000 / limitFps;
+		//an eighth of the interval early still counts, host frames do not arrive exactly on time
+		if (nowUs + intervalUs / 8 < m_nNextSendUs)
+		{
+			MediaAtomicIncrement64(&m_nThrottled);
+			return;
+		}
+		m_nNextSendUs = m_nNextSendUs + intervalUs > nowUs ? m_nNextSendUs + intervalUs : nowUs + intervalUs;
+	}
+
+	if (!m_converter.Convert(frame.rgba.GetData(), frame.width * 4, frame.width, frame.height, frame.format, frame.bFlipVertical, m_image))
+		return;
+
+	unsigned int maxWidth = cap.width;
+	unsigned int maxHeight = cap.height;
+	if (limitWidth > 0 && (0 == maxWidth || limitWidth < maxWidth))
+		maxWidth = limitWidth;
+	if (limitHeight > 0 && (0 == maxHeight || limitHeight < maxHeight))
+		maxHeight = limitHeight;
+
+	CRawDataI420Image* pImage = m_scaler.ScaleToFit(m_image, m_scaled, maxWidth, maxHeight);
+
+	CMediaAutoLock lock(m_lock, true);
+	if (m_pSender && IsSending())
+	{
+		if (SDKERR_SUCCESS == m_pSender->sendVideoFrame((char*)pImage->GetYBuffer(), (int)pImage->GetWidth(), (int)pImage->GetHeight(), (int)pImage->GetSize(), 0))
+			MediaAtomicIncrement64(&m_nSent);
+	}
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,81 @@
+#pragma once
+#include "rawdata_rgba_converter.h"
+#include "rawdata_rgba_mailbox.h"
+#include "zoom_sdk_def.h"
+#include "rawdata/rawdata_video_source_helper_interface.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+//External video source fed with RGBA frames rendered by the host, e.g. Unity's avatar camera, so attendees in
+//regular Zoom clients see the 3D view as this user's video.
+//PushFrame() only copies the pixels into a free slot of a triple buffer and returns, a worker thread converts the
+//newest frame to I420, scales it down to the negotiated capability if needed and sends it. Frames pushed faster
+//than they can be sent replace each other. PushFrame() is meant for a single producer thread.
+//Register it with IZoomSDKVideoSourceHelperWrap::setExternalVideoSource().
+class CRawDataVirtualCamera : public IZoomSDKVideoSource
+{
+public:
+	static CRawDataVirtualCamera& GetInst();
+
+	//size and frame rate the host renders at, the capability closest to it is requested from the sdk
+	void SetTargetSize(unsigned int width, unsigned int height, unsigned int fps);
+	//caps what is sent below the capability, e.g. while the network is congested. Frames are scaled down to fit
+	//width x height and skipped to stay at fps. 0 lifts a limit.
+	void SetSendLimit(unsigned int width, unsigned int height, unsigned int fps);
+	bool Start();
+	void Stop();
+	bool IsStarted() const { return m_thread.IsStarted(); }
+
+	//returns false when the sdk is not taking frames, the host can skip the gpu readback then.
+	//stride is in bytes, see CRawDataRGBAConverter::Convert() for bFlipVertical.
+	bool PushFrame(const unsigned char* pRGBA, unsigned int width, unsigned int height, unsigned int stride, RawDataPixelFormat format, bool bFlipVertical);
+	//capability in use, 0x0 until the sdk initialized the source
+	VideoSourceCapability GetCapability();
+	//true between onStartSend and onStopSend
+	bool IsSending() const { return 0 != MediaAtomicLoad(&m_bSending); }
+	unsigned long long GetSentCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nSent); }
+	//frames replaced by a newer one before the worker got to them
+	unsigned long long GetDroppedCount() const { return m_mailbox.GetDroppedCount(); }
+	//frames skipped to stay within the frame rate limit
+	unsigned long long GetThrottledCount() const { return (unsigned long long)MediaAtomicLoad64(&m_nThrottled); }
+
+	//smallest capability covering the target with the closest aspect ratio, or the largest one when none covers it
+	static bool SelectCapability(IList<VideoSourceCapability >* pList, unsigned int width, unsigned int height, unsigned int fps, VideoSourceCapability& cap);
+
+	virtual void onInitialize(IZoomSDKVideoSender* sender, IList<VideoSourceCapability >* support_cap_list, VideoSourceCapability& suggest_cap);
+	virtual void onPropertyChange(IList<VideoSourceCapability >* support_cap_list, VideoSourceCapability suggest_cap);
+	virtual void onStartSend();
+	virtual void onStopSend();
+	virtual void onUninitialized();
+
+private:
+	CRawDataVirtualCamera();
+	CRawDataVirtualCamera(const CRawDataVirtualCamera&);
+	CRawDataVirtualCamera& operator=(const CRawDataVirtualCamera&);
+	static void WorkerProc(void* pParam);
+	void WorkerLoop();
+	void SendFrame(const RawDataRGBAFrame& frame);
+
+	CRawDataRGBAMailbox m_mailbox;
+	CMediaThread m_thread;
+	CMediaEvent m_event;
+	volatile LONG m_bQuit;
+	volatile LONG m_bSending;
+	volatile LONGLONG m_nSent;
+	volatile LONGLONG m_nThrottled;
+	long long m_nNextSendUs;///<Earliest time the worker sends again under the frame rate limit.
+
+	CMediaLock m_lock;///<Guards the sender, the capability, the target size and the send limit.
+	IZoomSDKVideoSender* m_pSender;
+	VideoSourceCapability m_capability;
+	unsigned int m_nTargetWidth;
+	unsigned int m_nTargetHeight;
+	unsigned int m_nTargetFps;
+	unsigned int m_nLimitWidth;
+	unsigned int m_nLimitHeight;
+	unsigned int m_nLimitFps;
+
+	CRawDataRGBAConverter m_converter;
+	CRawDataYUVScaler m_scaler;
+	CRawDataI420Image m_image;
+	CRawDataI420Image m_scaled;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,416 @@
+#include "rawdata_yuv_converter.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//rows converted per pass when the output is rotated by 90/270. They are transposed in 4x4 blocks, and 16 rows
+//make every store in the target a full 64 byte cache line.
+#define YUV_ROTATE_STRIP_ROWS 16
+
+//BT.601 in 6 bit fixed point, sized so every intermediate fits a signed 16 bit lane
+struct YuvConstants
+{
+	short yOffset;
+	short yGain;
+	short vr;
+	short ug;
+	short vg;
+	short ub;
+};
+
+static const YuvConstants s_yuvLimited = { 16, 75, 102, 25, 52, 129 };
+static const YuvConstants s_yuvFull = { 0, 64, 90, 22, 46, 113 };
+
+typedef void(*YuvRowFunc)(const unsigned char* pY, const unsigned char* pU, const unsigned char* pV, unsigned char* pDst, int width, const YuvConstants* k, bool bBGRA);
+
+static inline int SatShort(int v)
+{
+	return v < -32768 ? -32768 : (v > 32767 ? 32767 : v);
+}
+
+static inline unsigned char ClampByte(int v)
+{
+	return (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+//mirrors the saturating 16 bit math of the simd kernels so every level produces the same bytes
+static inline void YuvPixel(int y, int u, int v, unsigned char* pDst, const YuvConstants* k, bool bBGRA)
+{
+	int yy = SatShort((y - k->yOffset) * k->yGain);
+	u -= 128;
+	v -= 128;
+	int r = SatShort(SatShort(yy + v * k->vr) + 32) >> 6;
+	int g = SatShort(SatShort(SatShort(yy - u * k->ug) - v * k->vg) + 32) >> 6;
+	int b = SatShort(SatShort(yy + u * k->ub) + 32) >> 6;
+	pDst[0] = ClampByte(bBGRA ? b : r);
+	pDst[1] = ClampByte(g);
+	pDst[2] = ClampByte(bBGRA ? r : b);
+	pDst[3] = 255;
+}
+
+static void YuvRow_Scalar(const unsigned char* pY, const unsigned char* pU, const unsigned char* pV, unsigned char* pDst, int width, const YuvConstants* k, bool bBGRA)
+{
+	for (int x = 0; x < width; ++x)
+		YuvPixel(pY[x], pU[x >> 1], pV[x >> 1], pDst + x * 4, k, bBGRA);
+}
+
+static inline __m128i LoadChroma4(const unsigned char* p)
+{
+	int v;
+	memcpy(&v, p, sizeof(v));
+	return _mm_cvtsi32_si128(v);
+}
+
+static MEDIA_TARGET_SSE41 void YuvRow_SSE41(const unsigned char* pY, const unsigned char* pU, const unsigned char* pV, unsigned char* pDst, int width, const YuvConstants* k, bool bBGRA)
+{
+	const __m128i yOffset = _mm_set1_epi16(k->yOffset);
+	const __m128i yGain = _mm_set1_epi16(k->yGain);
+	const __m128i vr = _mm_set1_epi16(k->vr);
+	const __m128i ug = _mm_set1_epi16(k->ug);
+	const __m128i vg = _mm_set1_epi16(k->vg);
+	const __m128i ub = _mm_set1_epi16(k->ub);
+	const __m128i bias = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi16(32);
+	const __m128i alpha = _mm_set1_epi8((char)0xFF);
+
+	int x = 0;
+	for (; x + 8 <= width; x += 8)
+	{
+		__m128i y = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(pY + x)));
+		__m128i u = LoadChroma4(pU + (x >> 1));
+		__m128i v = LoadChroma4(pV + (x >> 1));
+		u = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_unpacklo_epi8(u, u)), bias);
+		v = _mm_sub_epi16(_mm_cvtepu8_epi16(_mm_unpacklo_epi8(v, v)), bias);
+
+		y = _mm_mullo_epi16(_mm_sub_epi16(y, yOffset), yGain);
+		__m128i r = _mm_adds_epi16(y, _mm_mullo_epi16(v, vr));
+		__m128i g = _mm_subs_epi16(_mm_subs_epi16(y, _mm_mullo_epi16(u, ug)), _mm_mullo_epi16(v, vg));
+		__m128i b = _mm_adds_epi16(y, _mm_mullo_epi16(u, ub));
+		r = _mm_srai_epi16(_mm_adds_epi16(r, round), 6);
+		g = _mm_srai_epi16(_mm_adds_epi16(g, round), 6);
+		b = _mm_srai_epi16(_mm_adds_epi16(b, round), 6);
+
+		__m128i c0 = _mm_packus_epi16(bBGRA ? b : r, bBGRA ? b : r);
+		__m128i c1 = _mm_packus_epi16(g, g);
+		__m128i c2 = _mm_packus_epi16(bBGRA ? r : b, bBGRA ? r : b);
+		__m128i c01 = _mm_unpacklo_epi8(c0, c1);
+		__m128i c23 = _mm_unpacklo_epi8(c2, alpha);
+		_mm_storeu_si128((__m128i*)(pDst + x * 4), _mm_unpacklo_epi16(c01, c23));
+		_mm_storeu_si128((__m128i*)(pDst + x * 4 + 16), _mm_unpackhi_epi16(c01, c23));
+	}
+	for (; x < width; ++x)
+		YuvPixel(pY[x], pU[x >> 1], pV[x >> 1], pDst + x * 4, k, bBGRA);
+}
+
+static MEDIA_TARGET_AVX2 void YuvRow_AVX2(const unsigned char* pY, const unsigned char* pU, const unsigned char* pV, unsigned char* pDst, int width, const YuvConstants* k, bool bBGRA)
+{
+	const __m256i yOffset = _mm256_set1_epi16(k->yOffset);
+	const __m256i yGain = _mm256_set1_epi16(k->yGain);
+	const __m256i vr = _mm256_set1_epi16(k->vr);
+	const __m256i ug = _mm256_set1_epi16(k->ug);
+	const __m256i vg = _mm256_set1_epi16(k->vg);
+	const __m256i ub = _mm256_set1_epi16(k->ub);
+	const __m256i bias = _mm256_set1_epi16(128);
+	const __m256i round = _mm256_set1_epi16(32);
+	const __m256i alpha = _mm256_set1_epi16(255);
+
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(pY + x)));
+		__m128i u8 = _mm_loadl_epi64((const __m128i*)(pU + (x >> 1)));
+		__m128i v8 = _mm_loadl_epi64((const __m128i*)(pV + (x >> 1)));
+		__m256i u = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(u8, u8)), bias);
+		__m256i v = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm_unpacklo_epi8(v8, v8)), bias);
+
+		y = _mm256_mullo_epi16(_mm256_sub_epi16(y, yOffset), yGain);
+		__m256i r = _mm256_adds_epi16(y, _mm256_mullo_epi16(v, vr));
+		__m256i g = _mm256_subs_epi16(_mm256_subs_epi16(y, _mm256_mullo_epi16(u, ug)), _mm256_mullo_epi16(v, vg));
+		__m256i b = _mm256_adds_epi16(y, _mm256_mullo_epi16(u, ub));
+		r = _mm256_srai_epi16(_mm256_adds_epi16(r, round), 6);
+		g = _mm256_srai_epi16(_mm256_adds_epi16(g, round), 6);
+		b = _mm256_srai_epi16(_mm256_adds_epi16(b, round), 6);
+
+		//per 128 bit lane: c01 = first channel bytes | g bytes, c23 = third channel bytes | alpha
+		__m256i c01 = _mm256_packus_epi16(bBGRA ? b : r, g);
+		__m256i c23 = _mm256_packus_epi16(bBGRA ? r : b, alpha);
+		c01 = _mm256_unpacklo_epi8(c01, _mm256_shuffle_epi32(c01, 0x4E));
+		c23 = _mm256_unpacklo_epi8(c23, _mm256_shuffle_epi32(c23, 0x4E));
+		__m256i lo = _mm256_unpacklo_epi16(c01, c23);//pixels 0-3 | 8-11
+		__m256i hi = _mm256_unpackhi_epi16(c01, c23);//pixels 4-7 | 12-15
+		_mm256_storeu_si256((__m256i*)(pDst + x * 4), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256((__m256i*)(pDst + x * 4 + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+	for (; x < width; ++x)
+		YuvPixel(pY[x], pU[x >> 1], pV[x >> 1], pDst + x * 4, k, bBGRA);
+}
+
+static void CpuId(int info[4], int leaf, int subLeaf)
+{
+#ifdef _MSC_VER
+	__cpuidex(info, leaf, subLeaf);
+#else
+	__cpuid_count(leaf, subLeaf, info[0], info[1], info[2], info[3]);
+#endif
+}
+
+//register state the os saves on a context switch, bits 1 and 2 are xmm and ymm
+static unsigned long long GetXcr0()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	unsigned int lo = 0, hi = 0;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+static CRawDataYUVConverter::SimdLevel DetectSimdLevel()
+{
+	int info[4] = { 0 };
+	CpuId(info, 0, 0);
+	int maxLeaf = info[0];
+	if (maxLeaf < 1)
+		return CRawDataYUVConverter::SimdLevel_Scalar;
+
+	CpuId(info, 1, 0);
+	bool bSSE41 = 0 != (info[2] & (1 << 19));
+	bool bOSXSave = 0 != (info[2] & (1 << 27));
+	bool bAVX = 0 != (info[2] & (1 << 28));
+	if (bOSXSave && bAVX && maxLeaf >= 7 && 0x6 == (GetXcr0() & 0x6))
+	{
+		CpuId(info, 7, 0);
+		if (info[1] & (1 << 5))
+			return CRawDataYUVConverter::SimdLevel_AVX2;
+	}
+	return bSSE41 ? CRawDataYUVConverter::SimdLevel_SSE41 : CRawDataYUVConverter::SimdLevel_Scalar;
+}
+
+static YuvRowFunc GetRowFunc(CRawDataYUVConverter::SimdLevel level)
+{
+	switch (level)
+	{
+	case CRawDataYUVConverter::SimdLevel_AVX2:
+		return YuvRow_AVX2;
+	case CRawDataYUVConverter::SimdLevel_SSE41:
+		return YuvRow_SSE41;
+	default:
+		return YuvRow_Scalar;
+	}
+}
+
+//reverses a row of 32 bit pixels into pDst
+static void ReverseRow32(const unsigned char* pSrc, unsigned char* pDst, int width)
+{
+	int x = 0;
+	for (; x + 4 <= width; x += 4)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i*)(pSrc + x * 4));
+		_mm_storeu_si128((__m128i*)(pDst + (width - 4 - x) * 4), _mm_shuffle_epi32(p, 0x1B));
+	}
+	for (; x < width; ++x)
+		memcpy(pDst + (width - 1 - x) * 4, pSrc + x * 4, 4);
+}
+
+unsigned int RawDataRotationToDegrees(unsigned int rotation)
+{
+	if (rotation < 4)
+		return rotation * 90;
+	if (90 == rotation || 180 == rotation || 270 == rotation)
+		return rotation;
+	return 0;
+}
+
+I420PlaneView MakeI420PlaneView(YUVRawDataI420* data)
+{
+	I420PlaneView view;
+	if (NULL == data)
+		return view;
+	view.pY = (const unsigned char*)data->GetYBuffer();
+	view.pU = (const unsigned char*)data->GetUBuffer();
+	view.pV = (const unsigned char*)data->GetVBuffer();
+	view.width = data->GetStreamWidth();
+	view.height = data->GetStreamHeight();
+	view.yStride = view.width;
+	view.uStride = (view.width + 1) / 2;
+	view.vStride = view.uStride;
+	view.bLimited = data->IsLimitedI420();
+	view.rotation = data->GetRotation();
+	return view;
+}
+
+I420PlaneView MakeI420PlaneView(const CRawDataFrame* pFrame)
+{
+	I420PlaneView view;
+	if (NULL == pFrame)
+		return view;
+	view.pY = pFrame->GetYBuffer();
+	view.pU = pFrame->GetUBuffer();
+	view.pV = pFrame->GetVBuffer();
+	view.width = pFrame->GetStreamWidth();
+	view.height = pFrame->GetStreamHeight();
+	view.yStride = pFrame->GetYStride();
+	view.uStride = pFrame->GetUVStride();
+	view.vStride = pFrame->GetUVStride();
+	view.bLimited = pFrame->IsLimitedI420();
+	view.rotation = pFrame->GetRotation();
+	return view;
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataYUVConverter::CRawDataYUVConverter()
+{
+	m_maxLevel = SimdLevel_AVX2;
+}
+
+CRawDataYUVConverter::~CRawDataYUVConverter()
+{
+}
+
+CRawDataYUVConverter::SimdLevel CRawDataYUVConverter::GetSimdLevel()
+{
+	static SimdLevel s_level = DetectSimdLevel();
+	return s_level;
+}
+
+void CRawDataYUVConverter::GetOutputSize(const I420PlaneView& src, unsigned int& width, unsigned int& height)
+{
+	unsigned int degrees = RawDataRotationToDegrees(src.rotation);
+	if (90 == degrees || 270 == degrees)
+	{
+		width = src.height;
+		height = src.width;
+	}
+	else
+	{
+		width = src.width;
+		height = src.height;
+	}
+}
+
+bool CRawDataYUVConverter::Convert(YUVRawDataI420* data, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	return Convert(MakeI420PlaneView(data), pDst, dstStride, format, bFlipVertical);
+}
+
+bool CRawDataYUVConverter::Convert(const CRawDataFrame* pFrame, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	return Convert(MakeI420PlaneView(pFrame), pDst, dstStride, format, bFlipVertical);
+}
+
+bool CRawDataYUVConverter::Convert(const I420PlaneView& src, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical)
+{
+	if (!src.IsValid() || NULL == pDst)
+		return false;
+
+	unsigned int outWidth = 0, outHeight = 0;
+	GetOutputSize(src, outWidth, outHeight);
+	if (dstStride < outWidth * 4)
+		return false;
+
+	SimdLevel level = GetSimdLevel();
+	if (level > m_maxLevel)
+		level = m_maxLevel;
+	YuvRowFunc rowFunc = GetRowFunc(level);
+	const YuvConstants* k = src.bLimited ? &s_yuvLimited : &s_yuvFull;
+	bool bBGRA = RawDataPixelFormat_BGRA32 == format;
+	unsigned int degrees = RawDataRotationToDegrees(src.rotation);
+	int width = (int)src.width;
+	int height = (int)src.height;
+
+#define YUV_SRC_ROW(r) src.pY + (size_t)(r) * src.yStride, src.pU + (size_t)((r) >> 1) * src.uStride, src.pV + (size_t)((r) >> 1) * src.vStride
+#define YUV_DST_ROW(r) (pDst + (size_t)(bFlipVertical ? (int)outHeight - 1 - (r) : (r)) * dstStride)
+
+	if (0 == degrees)
+	{
+		for (int r = 0; r < height; ++r)
+			rowFunc(YUV_SRC_ROW(r), YUV_DST_ROW(r), width, k, bBGRA);
+		return true;
+	}
+
+	if (180 == degrees)
+	{
+		if (!m_scratch.Resize((size_t)width * 4))
+			return false;
+		for (int r = 0; r < height; ++r)
+		{
+			rowFunc(YUV_SRC_ROW(r), m_scratch.GetData(), width, k, bBGRA);
+			ReverseRow32(m_scratch.GetData(), YUV_DST_ROW(height - 1 - r), width);
+		}
+		return true;
+	}
+
+	//90: source (x, y) lands on output (height - 1 - y, x). 270: on output (y, width - 1 - x).
+	size_t scratchStride = ((size_t)width * 4 + MEDIA_BUFFER_ALIGNMENT - 1) & ~(size_t)(MEDIA_BUFFER_ALIGNMENT - 1);
+	if (!m_scratch.Resize(scratchStride * YUV_ROTATE_STRIP_ROWS))
+		return false;
+	unsigned char* pStrip = m_scratch.GetData();
+	bool bClockwise = 90 == degrees;
+
+	for (int r0 = 0; r0 < height; r0 += YUV_ROTATE_STRIP_ROWS)
+	{
+		int rows = height - r0 < YUV_ROTATE_STRIP_ROWS ? height - r0 : YUV_ROTATE_STRIP_ROWS;
+		for (int i = 0; i < rows; ++i)
+			rowFunc(YUV_SRC_ROW(r0 + i), pStrip + scratchStride * i, width, k, bBGRA);
+
+		//first output column written by this strip and the source row that goes there
+		int col = bClockwise ? height - r0 - rows : r0;
+		int x = 0;
+		int blocks = rows / 4;
+		for (; blocks > 0 && x + 4 <= width; x += 4)
+		{
+			for (int blk = 0; blk < blocks; ++blk)
+			{
+				const unsigned char* pBlock = pStrip + scratchStride * blk * 4 + x * 4;
+				__m128i a = _mm_loadu_si128((const __m128i*)pBlock);
+				__m128i b = _mm_loadu_si128((const __m128i*)(pBlock + scratchStride));
+				__m128i c = _mm_loadu_si128((const __m128i*)(pBlock + scratchStride * 2));
+				__m128i d = _mm_loadu_si128((const __m128i*)(pBlock + scratchStride * 3));
+				__m128i t0 = _mm_unpacklo_epi32(a, b);
+				__m128i t1 = _mm_unpacklo_epi32(c, d);
+				__m128i t2 = _mm_unpackhi_epi32(a, b);
+				__m128i t3 = _mm_unpackhi_epi32(c, d);
+				__m128i cols[4];
+				cols[0] = _mm_unpacklo_epi64(t0, t1);
+				cols[1] = _mm_unpackhi_epi64(t0, t1);
+				cols[2] = _mm_unpacklo_epi64(t2, t3);
+				cols[3] = _mm_unpackhi_epi64(t2, t3);
+				//clockwise output runs bottom-up through the strip, so the blocks and their pixels are reversed
+				int blockCol = bClockwise ? col + rows - 4 * (blk + 1) : col + 4 * blk;
+				for (int j = 0; j < 4; ++j)
+				{
+					int outRow = bClockwise ? x + j : width - 1 - x - j;
+					__m128i p = bClockwise ? _mm_shuffle_epi32(cols[j], 0x1B) : cols[j];
+					_mm_storeu_si128((__m128i*)(YUV_DST_ROW(outRow) + blockCol * 4), p);
+				}
+			}
+			//rows left over at the bottom of the image
+			for (int i = blocks * 4; i < rows; ++i)
+			{
+				for (int j = 0; j < 4; ++j)
+				{
+					int outRow = bClockwise ? x + j : width - 1 - x - j;
+					int outCol = bClockwise ? col + rows - 1 - i : col + i;
+					memcpy(YUV_DST_ROW(outRow) + outCol * 4, pStrip + scratchStride * i + (x + j) * 4, 4);
+				}
+			}
+		}
+		for (; x < width; ++x)
+		{
+			int outRow = bClockwise ? x : width - 1 - x;
+			unsigned char* pOut = YUV_DST_ROW(outRow) + col * 4;
+			for (int i = 0; i < rows; ++i)
+			{
+				int srcRow = bClockwise ? rows - 1 - i : i;
+				memcpy(pOut + i * 4, pStrip + scratchStride * srcRow + x * 4, 4);
+			}
+		}
+	}
+#undef YUV_SRC_ROW
+#undef YUV_DST_ROW
+	return true;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,92 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include "rawdata_frame_ring.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+typedef enum
+{
+	RawDataPixelFormat_RGBA32,///<R,G,B,A byte order, Unity TextureFormat.RGBA32.
+	RawDataPixelFormat_BGRA32,///<B,G,R,A byte order, Unity TextureFormat.BGRA32.
+}RawDataPixelFormat;
+
+//Read-only view of the three planes of an I420 image.
+struct I420PlaneView
+{
+	const unsigned char* pY;
+	const unsigned char* pU;
+	const unsigned char* pV;
+	unsigned int yStride;
+	unsigned int uStride;
+	unsigned int vStride;
+	unsigned int width;
+	unsigned int height;
+	bool bLimited;///<BT.601 limited (16-235) range when true, full range otherwise.
+	unsigned int rotation;///<Clockwise rotation to apply, see RawDataRotationToDegrees().
+
+	I420PlaneView()
+	{
+		Reset();
+	}
+
+	void Reset()
+	{
+		pY = NULL;
+		pU = NULL;
+		pV = NULL;
+		yStride = 0;
+		uStride = 0;
+		vStride = 0;
+		width = 0;
+		height = 0;
+		bLimited = true;
+		rotation = 0;
+	}
+
+	bool IsValid() const
+	{
+		return pY && pU && pV && width > 0 && height > 0 && yStride >= width && uStride >= (width + 1) / 2 && vStride >= (width + 1) / 2;
+	}
+};
+
+//GetRotation() reports either a LocalVideoDeviceRotation index (0-3) or degrees. Both are mapped to 0/90/180/270.
+unsigned int RawDataRotationToDegrees(unsigned int rotation);
+I420PlaneView MakeI420PlaneView(YUVRawDataI420* data);
+I420PlaneView MakeI420PlaneView(const CRawDataFrame* pFrame);
+
+//Converts I420 to 32 bit RGBA/BGRA with BT.601 coefficients, picking limited or full range per frame and
+//applying the frame rotation in the same pass. AVX2 or SSE4.1 kernels are selected at runtime with a
+//scalar fallback. An instance keeps the scratch rows needed for rotation, so use one converter per thread.
+class CRawDataYUVConverter
+{
+public:
+	typedef enum
+	{
+		SimdLevel_Scalar,
+		SimdLevel_SSE41,
+		SimdLevel_AVX2,
+	}SimdLevel;
+
+	CRawDataYUVConverter();
+	~CRawDataYUVConverter();
+
+	//output size after rotation
+	static void GetOutputSize(const I420PlaneView& src, unsigned int& width, unsigned int& height);
+	static SimdLevel GetSimdLevel();
+
+	//dstStride is in bytes and must be at least width * 4 of the rotated output.
+	//bFlipVertical writes the rows bottom-up, which is what Texture2D.LoadRawTextureData expects.
+	bool Convert(const I420PlaneView& src, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical = false);
+	bool Convert(YUVRawDataI420* data, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical = false);
+	bool Convert(const CRawDataFrame* pFrame, unsigned char* pDst, unsigned int dstStride, RawDataPixelFormat format, bool bFlipVertical = false);
+
+	//limits the kernels to the given level, mainly to compare them against each other
+	void SetMaxSimdLevel(SimdLevel level) { m_maxLevel = level; }
+
+private:
+	CRawDataYUVConverter(const CRawDataYUVConverter&);
+	CRawDataYUVConverter& operator=(const CRawDataYUVConverter&);
+
+	CMediaBuffer m_scratch;
+	SimdLevel m_maxLevel;
+};
+END_ZOOM_SDK_NAMESPACE
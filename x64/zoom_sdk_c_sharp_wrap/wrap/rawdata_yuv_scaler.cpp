@@ -0,0 +1,364 @@
+#include "rawdata_yuv_scaler.h"
+#include <immintrin.h>
+BEGIN_ZOOM_SDK_NAMESPACE
+//rows of the source plane reduced per band, enough for one row of the deepest mip
+#define YUV_SCALER_BAND_ROWS (1 << YUV_SCALER_MAX_MIP_LEVELS)
+
+typedef void(*HalveRowFunc)(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int srcWidth);
+
+//2x2 box with rounding. The last column is repeated when the width is odd.
+static void HalveRow_Scalar(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int srcWidth)
+{
+	int dstWidth = (srcWidth + 1) / 2;
+	for (int x = 0; x < dstWidth; ++x)
+	{
+		int x0 = x * 2;
+		int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+		pDst[x] = (unsigned char)((pRow0[x0] + pRow0[x1] + pRow1[x0] + pRow1[x1] + 2) >> 2);
+	}
+}
+
+static MEDIA_TARGET_SSE41 void HalveRow_SSE41(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int srcWidth)
+{
+	const __m128i ones = _mm_set1_epi8(1);
+	const __m128i two = _mm_set1_epi16(2);
+	int x = 0;
+	for (; x + 32 <= srcWidth; x += 32)
+	{
+		__m128i lo = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(pRow0 + x)), ones),
+			_mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(pRow1 + x)), ones));
+		__m128i hi = _mm_add_epi16(_mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(pRow0 + x + 16)), ones),
+			_mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(pRow1 + x + 16)), ones));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+		_mm_storeu_si128((__m128i*)(pDst + x / 2), _mm_packus_epi16(lo, hi));
+	}
+	if (x < srcWidth)
+		HalveRow_Scalar(pRow0 + x, pRow1 + x, pDst + x / 2, srcWidth - x);
+}
+
+static MEDIA_TARGET_AVX2 void HalveRow_AVX2(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int srcWidth)
+{
+	const __m256i ones = _mm256_set1_epi8(1);
+	const __m256i two = _mm256_set1_epi16(2);
+	int x = 0;
+	for (; x + 64 <= srcWidth; x += 64)
+	{
+		__m256i lo = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(pRow0 + x)), ones),
+			_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(pRow1 + x)), ones));
+		__m256i hi = _mm256_add_epi16(_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(pRow0 + x + 32)), ones),
+			_mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(pRow1 + x + 32)), ones));
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, two), 2);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, two), 2);
+		//packus works per 128 bit lane, put the quarters back in order
+		_mm256_storeu_si256((__m256i*)(pDst + x / 2), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8));
+	}
+	if (x < srcWidth)
+		HalveRow_SSE41(pRow0 + x, pRow1 + x, pDst + x / 2, srcWidth - x);
+}
+
+//fraction is in 1/128 steps and 1 to 127, so both weights fit the signed bytes of maddubs
+typedef void(*BlendRowFunc)(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int width, int fraction);
+
+//pDst = pRow0 + (pRow1 - pRow0) * fraction / 128
+static void BlendRow_Scalar(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int width, int fraction)
+{
+	for (int x = 0; x < width; ++x)
+		pDst[x] = (unsigned char)((pRow0[x] * (128 - fraction) + pRow1[x] * fraction + 64) >> 7);
+}
+
+static MEDIA_TARGET_SSE41 void BlendRow_SSE41(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int width, int fraction)
+{
+	const __m128i weights = _mm_set1_epi16((short)((fraction << 8) | (128 - fraction)));
+	const __m128i round = _mm_set1_epi16(64);
+	int x = 0;
+	for (; x + 16 <= width; x += 16)
+	{
+		__m128i a = _mm_loadu_si128((const __m128i*)(pRow0 + x));
+		__m128i b = _mm_loadu_si128((const __m128i*)(pRow1 + x));
+		__m128i lo = _mm_maddubs_epi16(_mm_unpacklo_epi8(a, b), weights);
+		__m128i hi = _mm_maddubs_epi16(_mm_unpackhi_epi8(a, b), weights);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, round), 7);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, round), 7);
+		_mm_storeu_si128((__m128i*)(pDst + x), _mm_packus_epi16(lo, hi));
+	}
+	if (x < width)
+		BlendRow_Scalar(pRow0 + x, pRow1 + x, pDst + x, width - x, fraction);
+}
+
+static MEDIA_TARGET_AVX2 void BlendRow_AVX2(const unsigned char* pRow0, const unsigned char* pRow1, unsigned char* pDst, int width, int fraction)
+{
+	const __m256i weights = _mm256_set1_epi16((short)((fraction << 8) | (128 - fraction)));
+	const __m256i round = _mm256_set1_epi16(64);
+	int x = 0;
+	for (; x + 32 <= width; x += 32)
+	{
+		__m256i a = _mm256_loadu_si256((const __m256i*)(pRow0 + x));
+		__m256i b = _mm256_loadu_si256((const __m256i*)(pRow1 + x));
+		//unpack and pack both stay within their lanes, so the byte order survives
+		__m256i lo = _mm256_maddubs_epi16(_mm256_unpacklo_epi8(a, b), weights);
+		__m256i hi = _mm256_maddubs_epi16(_mm256_unpackhi_epi8(a, b), weights);
+		lo = _mm256_srli_epi16(_mm256_add_epi16(lo, round), 7);
+		hi = _mm256_srli_epi16(_mm256_add_epi16(hi, round), 7);
+		_mm256_storeu_si256((__m256i*)(pDst + x), _mm256_packus_epi16(lo, hi));
+	}
+	if (x < width)
+		BlendRow_SSE41(pRow0 + x, pRow1 + x, pDst + x, width - x, fraction);
+}
+
+//one plane of every mip level, row pointers and sizes
+struct MipPlane
+{
+	unsigned char* pData;
+	const unsigned char* pSrc;
+	unsigned int stride;
+	unsigned int width;
+	unsigned int height;
+};
+
+static void BuildPlaneMips(MipPlane* planes, unsigned int levels, HalveRowFunc halve)
+{
+	//planes[0] is the source, planes[n] mip n. A band of source rows is carried down through every level.
+	unsigned int bandRows = YUV_SCALER_BAND_ROWS;
+	for (unsigned int band = 0; band * bandRows < planes[0].height; ++band)
+	{
+		for (unsigned int level = 1; level <= levels; ++level)
+		{
+			const MipPlane& src = planes[level - 1];
+			MipPlane& dst = planes[level];
+			unsigned int rows = bandRows >> level;
+			unsigned int first = band * rows;
+			for (unsigned int row = first; row < first + rows && row < dst.height; ++row)
+			{
+				unsigned int r0 = row * 2;
+				unsigned int r1 = r0 + 1 < src.height ? r0 + 1 : r0;
+				halve(src.pSrc + (size_t)r0 * src.stride, src.pSrc + (size_t)r1 * src.stride, dst.pData + (size_t)row * dst.stride, (int)src.width);
+			}
+		}
+	}
+}
+
+static void ScalePlane(const unsigned char* pSrc, unsigned int srcStride, unsigned int srcWidth, unsigned int srcHeight,
+	unsigned char* pDst, unsigned int dstStride, unsigned int dstWidth, unsigned int dstHeight,
+	unsigned char* pRow, unsigned int* pCols, BlendRowFunc blend)
+{
+	//16.16 source positions with pixel centers aligned. Columns keep 8 bits of fraction, rows 7 for the simd blend.
+	unsigned int stepX = (unsigned int)(((unsigned long long)srcWidth << 16) / dstWidth);
+	unsigned int stepY = (unsigned int)(((unsigned long long)srcHeight << 16) / dstHeight);
+	long long maxX = ((long long)srcWidth - 1) << 16;
+	long long maxY = ((long long)srcHeight - 1) << 16;
+	for (unsigned int x = 0; x < dstWidth; ++x)
+	{
+		long long pos = (long long)x * stepX + (stepX >> 1) - 0x8000;
+		pCols[x] = (unsigned int)(pos < 0 ? 0 : (pos > maxX ? maxX : pos));
+	}
+
+	for (unsigned int y = 0; y < dstHeight; ++y)
+	{
+		long long pos = (long long)y * stepY + (stepY >> 1) - 0x8000;
+		pos = pos < 0 ? 0 : (pos > maxY ? maxY : pos);
+		unsigned int row0 = (unsigned int)(pos >> 16);
+		unsigned int row1 = row0 + 1 < srcHeight ? row0 + 1 : row0;
+		int fraction = (int)((pos >> 9) & 0x7F);
+		const unsigned char* pLine = pSrc + (size_t)row0 * srcStride;
+		if (fraction > 0 && row1 != row0)
+		{
+			blend(pLine, pSrc + (size_t)row1 * srcStride, pRow, (int)srcWidth, fraction);
+			pLine = pRow;
+		}
+
+		unsigned char* pOut = pDst + (size_t)y * dstStride;
+		for (unsigned int x = 0; x < dstWidth; ++x)
+		{
+			unsigned int col = pCols[x] >> 16;
+			unsigned int next = col + 1 < srcWidth ? col + 1 : col;
+			unsigned int fraction = (pCols[x] >> 8) & 0xFF;
+			pOut[x] = (unsigned char)((pLine[col] * (256 - fraction) + pLine[next] * fraction + 128) >> 8);
+		}
+	}
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataI420Image::CRawDataI420Image()
+{
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+
+bool CRawDataI420Image::Resize(unsigned int width, unsigned int height)
+{
+	if (0 == width || 0 == height)
+		return false;
+	size_t uvSize = (size_t)((width + 1) / 2) * ((height + 1) / 2);
+	if (!m_buffer.Resize((size_t)width * height + uvSize * 2))
+		return false;
+	m_nWidth = width;
+	m_nHeight = height;
+	m_view.pY = GetYBuffer();
+	m_view.pU = GetUBuffer();
+	m_view.pV = GetVBuffer();
+	m_view.yStride = GetYStride();
+	m_view.uStride = GetUVStride();
+	m_view.vStride = GetUVStride();
+	m_view.width = width;
+	m_view.height = height;
+	return true;
+}
+
+void CRawDataI420Image::Free()
+{
+	m_buffer.Free();
+	m_view.Reset();
+	m_nWidth = 0;
+	m_nHeight = 0;
+}
+/////////////////////////////////////////////////////////////////////////
+CRawDataYUVScaler::CRawDataYUVScaler()
+{
+	m_nLevels = 0;
+	m_maxLevel = CRawDataYUVConverter::SimdLevel_AVX2;
+}
+
+CRawDataYUVConverter::SimdLevel CRawDataYUVScaler::GetLevel() const
+{
+	CRawDataYUVConverter::SimdLevel level = CRawDataYUVConverter::GetSimdLevel();
+	return level > m_maxLevel ? m_maxLevel : level;
+}
+
+bool CRawDataYUVScaler::BuildMips(const CRawDataFrame* pFrame, unsigned int levels)
+{
+	return BuildMips(MakeI420PlaneView(pFrame), levels);
+}
+
+bool CRawDataYUVScaler::BuildMips(YUVRawDataI420* data, unsigned int levels)
+{
+	return BuildMips(MakeI420PlaneView(data), levels);
+}
+
+bool CRawDataYUVScaler::BuildMips(const I420PlaneView& src, unsigned int levels)
+{
+	m_nLevels = 0;
+	if (!src.IsValid() || 0 == levels || levels > YUV_SCALER_MAX_MIP_LEVELS)
+		return false;
+
+	unsigned int width = src.width;
+	unsigned int height = src.height;
+	for (unsigned int level = 0; level < levels; ++level)
+	{
+		width = (width + 1) / 2;
+		height = (height + 1) / 2;
+		if (!m_mips[level].Resize(width, height))
+			return false;
+		m_mips[level].m_view.bLimited = src.bLimited;
+		m_mips[level].m_view.rotation = src.rotation;
+	}
+
+	HalveRowFunc halve = HalveRow_Scalar;
+	if (CRawDataYUVConverter::SimdLevel_AVX2 == GetLevel())
+		halve = HalveRow_AVX2;
+	else if (CRawDataYUVConverter::SimdLevel_SSE41 == GetLevel())
+		halve = HalveRow_SSE41;
+
+	MipPlane planes[YUV_SCALER_MAX_MIP_LEVELS + 1];
+	for (int plane = 0; plane < 3; ++plane)
+	{
+		planes[0].pData = NULL;
+		planes[0].pSrc = 0 == plane ? src.pY : (1 == plane ? src.pU : src.pV);
+		planes[0].stride = 0 == plane ? src.yStride : (1 == plane ? src.uStride : src.vStride);
+		planes[0].width = 0 == plane ? src.width : (src.width + 1) / 2;
+		planes[0].height = 0 == plane ? src.height : (src.height + 1) / 2;
+		for (unsigned int level = 1; level <= levels; ++level)
+		{
+			CRawDataI420Image& mip = m_mips[level - 1];
+			planes[level].pData = 0 == plane ? mip.GetYBuffer() : (1 == plane ? mip.GetUBuffer() : mip.GetVBuffer());
+			planes[level].pSrc = planes[level].pData;
+			planes[level].stride = 0 == plane ? mip.GetYStride() : mip.GetUVStride();
+			planes[level].width = 0 == plane ? mip.GetWidth() : mip.GetUVStride();
+			planes[level].height = 0 == plane ? mip.GetHeight() : (mip.GetHeight() + 1) / 2;
+		}
+		BuildPlaneMips(planes, levels, halve);
+	}
+	m_nLevels = levels;
+	return true;
+}
+
+const CRawDataI420Image* CRawDataYUVScaler::GetMip(unsigned int level) const
+{
+	if (0 == level || level > m_nLevels)
+		return NULL;
+	return &m_mips[level - 1];
+}
+
+bool CRawDataYUVScaler::Scale(const I420PlaneView& src, CRawDataI420Image& dst, unsigned int width, unsigned int height)
+{
+	if (!src.IsValid() || 0 == width || 0 == height || width > src.width || height > src.height)
+		return false;
+
+	//a bilinear tap only sees 2 pixels, go down the mips until the step is at most 2:1
+	unsigned int levels = 0;
+	unsigned int mipWidth = src.width;
+	unsigned int mipHeight = src.height;
+	while (levels < YUV_SCALER_MAX_MIP_LEVELS && (mipWidth + 1) / 2 >= width && (mipHeight + 1) / 2 >= height)
+	{
+		mipWidth = (mipWidth + 1) / 2;
+		mipHeight = (mipHeight + 1) / 2;
+		++levels;
+	}
+	const I420PlaneView* pSrc = &src;
+	if (levels > 0)
+	{
+		if (!BuildMips(src, levels))
+			return false;
+		pSrc = &m_mips[levels - 1].GetView();
+	}
+
+	if (!dst.Resize(width, height))
+		return false;
+	dst.m_view.bLimited = src.bLimited;
+	dst.m_view.rotation = src.rotation;
+	if (pSrc->width == width && pSrc->height == height)
+	{
+		memcpy(dst.GetYBuffer(), pSrc->pY, (size_t)width * height);
+		memcpy(dst.GetUBuffer(), pSrc->pU, (size_t)dst.GetUVStride() * ((height + 1) / 2));
+		memcpy(dst.GetVBuffer(), pSrc->pV, (size_t)dst.GetUVStride() * ((height + 1) / 2));
+		return true;
+	}
+
+	if (!m_rowBuffer.Resize(pSrc->width + 64) || !m_colBuffer.Resize((size_t)width * sizeof(unsigned int)))
+		return false;
+	BlendRowFunc blend = BlendRow_Scalar;
+	if (CRawDataYUVConverter::SimdLevel_AVX2 == GetLevel())
+		blend = BlendRow_AVX2;
+	else if (CRawDataYUVConverter::SimdLevel_SSE41 == GetLevel())
+		blend = BlendRow_SSE41;
+
+	unsigned int* pCols = (unsigned int*)m_colBuffer.GetData();
+	unsigned int srcUVWidth = (pSrc->width + 1) / 2;
+	unsigned int srcUVHeight = (pSrc->height + 1) / 2;
+	unsigned int dstUVHeight = (height + 1) / 2;
+	ScalePlane(pSrc->pY, pSrc->yStride, pSrc->width, pSrc->height, dst.GetYBuffer(), dst.GetYStride(), width, height, m_rowBuffer.GetData(), pCols, blend);
+	ScalePlane(pSrc->pU, pSrc->uStride, srcUVWidth, srcUVHeight, dst.GetUBuffer(), dst.GetUVStride(), dst.GetUVStride(), dstUVHeight, m_rowBuffer.GetData(), pCols, blend);
+	ScalePlane(pSrc->pV, pSrc->vStride, srcUVWidth, srcUVHeight, dst.GetVBuffer(), dst.GetUVStride(), dst.GetUVStride(), dstUVHeight, m_rowBuffer.GetData(), pCols, blend);
+	return true;
+}
+
+CRawDataI420Image* CRawDataYUVScaler::ScaleToFit(CRawDataI420Image& src, CRawDataI420Image& dst, unsigned int maxWidth, unsigned int maxHeight)
+{
+	unsigned int srcWidth = src.GetWidth();
+	unsigned int srcHeight = src.GetHeight();
+	if (0 == maxWidth)
+		maxWidth = srcWidth;
+	if (0 == maxHeight)
+		maxHeight = srcHeight;
+	if (0 == srcWidth || 0 == srcHeight || (srcWidth <= maxWidth && srcHeight <= maxHeight))
+		return &src;
+
+	double scale = (double)maxWidth / srcWidth;
+	if ((double)maxHeight / srcHeight < scale)
+		scale = (double)maxHeight / srcHeight;
+	unsigned int width = ((unsigned int)(srcWidth * scale)) & ~1u;
+	unsigned int height = ((unsigned int)(srcHeight * scale)) & ~1u;
+	if (width < 2 || height < 2 || !Scale(src.GetView(), dst, width, height))
+		return &src;
+	return &dst;
+}
+END_ZOOM_SDK_NAMESPACE
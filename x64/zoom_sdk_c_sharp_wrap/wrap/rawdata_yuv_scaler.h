@@ -0,0 +1,78 @@
+#pragma once
+#include "rawdata_yuv_converter.h"
+
+BEGIN_ZOOM_SDK_NAMESPACE
+//I420 image owning its planes, tightly packed like the sdk frames.
+class CRawDataI420Image
+{
+public:
+	CRawDataI420Image();
+
+	bool Resize(unsigned int width, unsigned int height);
+	void Free();
+
+	unsigned char* GetYBuffer() { return m_buffer.GetData(); }
+	unsigned char* GetUBuffer() { return m_buffer.GetData() + (size_t)m_nWidth * m_nHeight; }
+	unsigned char* GetVBuffer() { return GetUBuffer() + (size_t)GetUVStride() * ((m_nHeight + 1) / 2); }
+	unsigned int GetWidth() const { return m_nWidth; }
+	unsigned int GetHeight() const { return m_nHeight; }
+	unsigned int GetYStride() const { return m_nWidth; }
+	unsigned int GetUVStride() const { return (m_nWidth + 1) / 2; }
+	//bytes of the three planes, which follow each other without padding
+	size_t GetSize() const { return (size_t)m_nWidth * m_nHeight + (size_t)GetUVStride() * ((m_nHeight + 1) / 2) * 2; }
+	//the view carries limited range and rotation over from the source the image was made from
+	const I420PlaneView& GetView() const { return m_view; }
+
+private:
+	friend class CRawDataYUVScaler;
+	friend class CRawDataRGBAConverter;
+	CRawDataI420Image(const CRawDataI420Image&);
+	CRawDataI420Image& operator=(const CRawDataI420Image&);
+
+	CMediaBuffer m_buffer;
+	I420PlaneView m_view;
+	unsigned int m_nWidth;
+	unsigned int m_nHeight;
+};
+
+#define YUV_SCALER_MAX_MIP_LEVELS 3
+
+//Downscales I420 frames, so one subscription can feed several on-screen sizes.
+//BuildMips() makes the half, quarter and eighth size 2x2 box mips in a single banded pass over the source,
+//each band is reduced through all levels while it is still in cache. Scale() resizes to any smaller size
+//with a bilinear filter, starting from the smallest mip that is still at least the target size.
+//Kernels use the SIMD level reported by CRawDataYUVConverter::GetSimdLevel(). Not thread safe.
+class CRawDataYUVScaler
+{
+public:
+	CRawDataYUVScaler();
+
+	//levels is 1 to YUV_SCALER_MAX_MIP_LEVELS, mip n is 1/2^n of the source size (rounded up)
+	bool BuildMips(const I420PlaneView& src, unsigned int levels = YUV_SCALER_MAX_MIP_LEVELS);
+	bool BuildMips(const CRawDataFrame* pFrame, unsigned int levels = YUV_SCALER_MAX_MIP_LEVELS);
+	bool BuildMips(YUVRawDataI420* data, unsigned int levels = YUV_SCALER_MAX_MIP_LEVELS);
+	unsigned int GetMipLevels() const { return m_nLevels; }
+	//level 1 to GetMipLevels(), NULL otherwise
+	const CRawDataI420Image* GetMip(unsigned int level) const;
+
+	//bilinear resize to width x height, which must not be larger than the source
+	bool Scale(const I420PlaneView& src, CRawDataI420Image& dst, unsigned int width, unsigned int height);
+	//shrinks src to fit into maxWidth x maxHeight keeping the aspect ratio, with even sizes so the chroma planes stay
+	//exact. Returns dst, or src when it already fits or cannot be scaled. A 0 bound does not limit.
+	CRawDataI420Image* ScaleToFit(CRawDataI420Image& src, CRawDataI420Image& dst, unsigned int maxWidth, unsigned int maxHeight);
+
+	//limits the kernels to the given level, mainly to compare them against each other
+	void SetMaxSimdLevel(CRawDataYUVConverter::SimdLevel level) { m_maxLevel = level; }
+
+private:
+	CRawDataYUVScaler(const CRawDataYUVScaler&);
+	CRawDataYUVScaler& operator=(const CRawDataYUVScaler&);
+	CRawDataYUVConverter::SimdLevel GetLevel() const;
+
+	CRawDataI420Image m_mips[YUV_SCALER_MAX_MIP_LEVELS];
+	CMediaBuffer m_rowBuffer;
+	CMediaBuffer m_colBuffer;
+	unsigned int m_nLevels;
+	CRawDataYUVConverter::SimdLevel m_maxLevel;
+};
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,87 @@
+#include "sdk_event_queue.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+CSDKEventQueue& CSDKEventQueue::GetInst()
+{
+	static CSDKEventQueue inst;
+	return inst;
+}
+
+CSDKEventQueue::CSDKEventQueue()
+{
+	Reset();
+}
+
+void CSDKEventQueue::Reset()
+{
+	for (LONG i = 0; i < SDK_EVENT_QUEUE_SIZE; ++i)
+		MediaAtomicStore(&m_cells[i].sequence, i);
+	MediaAtomicStore(&m_nEnqueue, 0);
+	m_nDequeue = 0;
+	MediaAtomicStore(&m_nDropped, 0);
+}
+
+bool CSDKEventQueue::Push(SDKEventType type, int value, int result, uint32_t userId)
+{
+	//a producer claims the cell at m_nEnqueue once the consumer has emptied it, and hands it over by moving its
+	//sequence on, see CRawDataAudioRecorder::Queue()
+	LONG pos = MediaAtomicLoad(&m_nEnqueue);
+	for (;;)
+	{
+		SDKEventCell& cell = m_cells[(ULONG)pos & (SDK_EVENT_QUEUE_SIZE - 1)];
+		LONG diff = (LONG)((ULONG)MediaAtomicLoad(&cell.sequence) - (ULONG)pos);
+		if (diff < 0)
+		{
+			MediaAtomicIncrement(&m_nDropped);
+			return false;
+		}
+		if (diff > 0)
+		{
+			pos = MediaAtomicLoad(&m_nEnqueue);
+			continue;
+		}
+		LONG previous = MediaAtomicCompareExchange(&m_nEnqueue, (LONG)((ULONG)pos + 1), pos);
+		if (previous != pos)
+		{
+			pos = previous;
+			continue;
+		}
+
+		cell.event.type = (uint32_t)type;
+		cell.event.value = value;
+		cell.event.result = result;
+		cell.event.userId = userId;
+		cell.event.timestampUs = MediaGetTimeUs();
+		MediaAtomicStore(&cell.sequence, (LONG)((ULONG)pos + 1));
+		return true;
+	}
+}
+
+unsigned int CSDKEventQueue::Drain(SDKEvent* pEvents, unsigned int capacity)
+{
+	if (NULL == pEvents)
+		return 0;
+	unsigned int count = 0;
+	while (count < capacity)
+	{
+		SDKEventCell& cell = m_cells[(ULONG)m_nDequeue & (SDK_EVENT_QUEUE_SIZE - 1)];
+		if ((ULONG)MediaAtomicLoad(&cell.sequence) != (ULONG)m_nDequeue + 1)
+		{
+			//the losses happened after everything still queued
+			LONG dropped = MediaAtomicExchange(&m_nDropped, 0);
+			if (dropped > 0)
+			{
+				SDKEvent& event = pEvents[count++];
+				memset(&event, 0, sizeof(event));
+				event.type = SDKEvent_Dropped;
+				event.value = dropped;
+				event.timestampUs = MediaGetTimeUs();
+			}
+			break;
+		}
+		pEvents[count++] = cell.event;
+		MediaAtomicStore(&cell.sequence, (LONG)((ULONG)m_nDequeue + SDK_EVENT_QUEUE_SIZE));
+		m_nDequeue = (LONG)((ULONG)m_nDequeue + 1);
+	}
+	return count;
+}
+END_ZOOM_SDK_NAMESPACE
@@ -0,0 +1,61 @@
+#pragma once
+#include "rawdata_media_common.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define SDK_EVENT_QUEUE_SIZE 1024
+
+typedef enum
+{
+	SDKEvent_Dropped,///<Events were lost to a full queue, value is how many. Re-read whatever state the host keeps.
+	SDKEvent_AuthResult,///<value is the AuthResult.
+	SDKEvent_MeetingStatus,///<value is the MeetingStatus, result the code that came with it.
+	SDKEvent_UserJoin,///<One event per user that joined.
+	SDKEvent_UserLeft,///<One event per user that left.
+	SDKEvent_HostChange,///<userId is the new host.
+	SDKEvent_HandStatus,///<value is 1 when userId raised the hand, 0 when lowered.
+	SDKEvent_UserNameChanged,///<userId has a new name, value is its CSDKStringTable handle.
+	SDKEvent_StatisticsWarning,///<value is the StatisticsWarningType.
+}SDKEventType;
+
+//One sdk callback as handed to the host. Layout is shared with the C# side.
+typedef struct tagSDKEvent
+{
+	uint32_t type;///<SDKEventType.
+	int32_t value;
+	int32_t result;
+	uint32_t userId;
+	int64_t timestampUs;///<When the sdk called back, on the MediaGetTimeUs() clock.
+}SDKEvent;
+
+//Bounded multi-producer/single-consumer queue of the sdk callbacks, so the host drains everything that happened
+//since its last frame in one call instead of polling a getter per state, and sees every transition, not just
+//the latest state. Push() never waits, a full queue drops the event and Drain() reports how many were lost.
+class CSDKEventQueue
+{
+public:
+	static CSDKEventQueue& GetInst();
+
+	//any thread. Returns false when the queue was full.
+	bool Push(SDKEventType type, int value = 0, int result = 0, uint32_t userId = 0);
+	//one consumer thread. Copies up to capacity events in the order they were pushed, followed by an
+	//SDKEvent_Dropped once the queue is empty if events were lost. Returns how many were written.
+	unsigned int Drain(SDKEvent* pEvents, unsigned int capacity);
+	//forgets the pending events, only while nothing pushes
+	void Reset();
+
+private:
+	CSDKEventQueue();
+	CSDKEventQueue(const CSDKEventQueue&);
+	CSDKEventQueue& operator=(const CSDKEventQueue&);
+
+	typedef struct tagSDKEventCell
+	{
+		volatile LONG sequence;///<Which lap of the queue the cell is free or filled for.
+		SDKEvent event;
+	}SDKEventCell;
+
+	SDKEventCell m_cells[SDK_EVENT_QUEUE_SIZE];
+	volatile LONG m_nEnqueue;
+	LONG m_nDequeue;
+	volatile LONG m_nDropped;
+};
+END_ZOOM_SDK_NAMESPACE
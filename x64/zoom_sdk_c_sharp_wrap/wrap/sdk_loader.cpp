@@ -41,6 +41,7 @@ void CSDKImpl::Reset()
 	m_fnCreateCustomizedUIMgr = NULL;
 	m_fnDestroyCustomizedUIMgr = NULL;
 	m_fnGetRawdataVideoSourceHelper = NULL;
+	m_fnGetRawdataShareSourceHelper = NULL;
 	m_fnGetAudioRawdataHelper = NULL;
 	m_fncreateRenderer = NULL;
 	m_fndestroyRenderer = NULL;
@@ -131,6 +132,8 @@ bool CSDKImpl::ConfigSDKModule(std::wstring& path)
 		m_fnDestroyCustomizedUIMgr = (fnDestroyCustomizedUIMgr)GetProcAddress(m_hSdk, "DestroyCustomizedUIMgr");
 
 		m_fnGetRawdataVideoSourceHelper = (fnGetRawdataVideoSourceHelper)GetProcAddress(m_hSdk, "GetRawdataVideoSourceHelper");
+		//optional, sdk builds without external share still load
+		m_fnGetRawdataShareSourceHelper = (fnGetRawdataShareSourceHelper)GetProcAddress(m_hSdk, "GetRawdataShareSourceHelper");
 		m_fnGetAudioRawdataHelper = (fnGetAudioRawdataHelper)GetProcAddress(m_hSdk, "GetAudioRawdataHelper");
 		m_fncreateRenderer = (fncreateRenderer)GetProcAddress(m_hSdk, "createRenderer");
 		m_fndestroyRenderer = (fndestroyRenderer)GetProcAddress(m_hSdk, "destroyRenderer");
@@ -374,6 +377,14 @@ ZOOM_SDK_NAMESPACE::IZoomSDKVideoSourceHelper*(CSDKImpl::GetRawdataVideoSourceHe
 	}
 	return NULL;
 }
+ZOOM_SDK_NAMESPACE::IZoomSDKShareSourceHelper*(CSDKImpl::GetRawdataShareSourceHelper)()
+{
+	if (m_fnGetRawdataShareSourceHelper)
+	{
+		return m_fnGetRawdataShareSourceHelper();
+	}
+	return NULL;
+}
 ZOOM_SDK_NAMESPACE::IZoomSDKAudioRawDataHelper* (CSDKImpl::GetAudioRawdataHelper)()
 {
 	if (m_fnGetAudioRawdataHelper)
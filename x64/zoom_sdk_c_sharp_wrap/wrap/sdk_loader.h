@@ -19,6 +19,7 @@ typedef ZOOM_SDK_NAMESPACE::SDKError(*fnCreateCustomizedUIMgr)(ZOOM_SDK_NAMESPAC
 typedef ZOOM_SDK_NAMESPACE::SDKError(*fnDestroyCustomizedUIMgr)(ZOOM_SDK_NAMESPACE::ICustomizedUIMgr* pCustomizedUIMgr);
 
 typedef ZOOM_SDK_NAMESPACE::IZoomSDKVideoSourceHelper*(*fnGetRawdataVideoSourceHelper)();
+typedef ZOOM_SDK_NAMESPACE::IZoomSDKShareSourceHelper*(*fnGetRawdataShareSourceHelper)();
 typedef ZOOM_SDK_NAMESPACE::IZoomSDKAudioRawDataHelper*(*fnGetAudioRawdataHelper)();
 typedef ZOOM_SDK_NAMESPACE::SDKError(*fncreateRenderer)(ZOOM_SDK_NAMESPACE::IZoomSDKRenderer** ppRenderer, ZOOM_SDK_NAMESPACE::IZoomSDKRendererDelegate* pDelegate);
 typedef ZOOM_SDK_NAMESPACE::SDKError(*fndestroyRenderer)(ZOOM_SDK_NAMESPACE::IZoomSDKRenderer* pRenderer);
@@ -52,6 +53,7 @@ public:
 	virtual ZOOM_SDK_NAMESPACE::SDKError(DestroyCustomizedUIMgr)(ZOOM_SDK_NAMESPACE::ICustomizedUIMgr* pCustomizedUIMgr);
 
 	virtual ZOOM_SDK_NAMESPACE::IZoomSDKVideoSourceHelper*(GetRawdataVideoSourceHelper)();
+	virtual ZOOM_SDK_NAMESPACE::IZoomSDKShareSourceHelper*(GetRawdataShareSourceHelper)();
 	virtual ZOOM_SDK_NAMESPACE::IZoomSDKAudioRawDataHelper*(GetAudioRawdataHelper)();
 	virtual ZOOM_SDK_NAMESPACE::SDKError(createRenderer)(ZOOM_SDK_NAMESPACE::IZoomSDKRenderer** ppRenderer, ZOOM_SDK_NAMESPACE::IZoomSDKRendererDelegate* pDelegate);
 	virtual ZOOM_SDK_NAMESPACE::SDKError(destroyRenderer)(ZOOM_SDK_NAMESPACE::IZoomSDKRenderer* pRenderer);
@@ -81,6 +83,7 @@ private:
 	fnDestroyCustomizedUIMgr m_fnDestroyCustomizedUIMgr;
 
 	fnGetRawdataVideoSourceHelper m_fnGetRawdataVideoSourceHelper;
+	fnGetRawdataShareSourceHelper m_fnGetRawdataShareSourceHelper;
 	fnGetAudioRawdataHelper m_fnGetAudioRawdataHelper;
 	fncreateRenderer m_fncreateRenderer;
 	fndestroyRenderer m_fndestroyRenderer;
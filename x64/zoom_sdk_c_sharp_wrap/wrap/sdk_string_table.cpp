@@ -0,0 +1,213 @@
+#include "sdk_string_table.h"
+BEGIN_ZOOM_SDK_NAMESPACE
+#define SDK_STRING_MIN_BUCKETS 256
+
+static uint32_t HashString(const char* pData, unsigned int length)
+{
+	//FNV-1a
+	uint32_t hash = 2166136261u;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		hash ^= (unsigned char)pData[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+CSDKStringTable& CSDKStringTable::GetInst()
+{
+	static CSDKStringTable inst;
+	return inst;
+}
+
+CSDKStringTable::CSDKStringTable()
+{
+	m_pCursor = NULL;
+	m_nBlockLeft = 0;
+	m_nArenaBytes = 0;
+	m_nFirstHandle = 1;
+	m_buckets.assign(SDK_STRING_MIN_BUCKETS, 0);
+}
+
+CSDKStringTable::~CSDKStringTable()
+{
+	FreeBlocks();
+}
+
+void CSDKStringTable::FreeBlocks()
+{
+	for (size_t i = 0; i < m_blocks.size(); ++i)
+		free(m_blocks[i]);
+	m_blocks.clear();
+	m_pCursor = NULL;
+	m_nBlockLeft = 0;
+	m_nArenaBytes = 0;
+}
+
+void CSDKStringTable::Reset()
+{
+	CMediaAutoLock lock(m_lock);
+	m_nFirstHandle += (uint32_t)m_entries.size();
+	m_entries.clear();
+	m_buckets.assign(SDK_STRING_MIN_BUCKETS, 0);
+	FreeBlocks();
+}
+
+char* CSDKStringTable::Allocate(unsigned int bytes)
+{
+	if (bytes > m_nBlockLeft)
+	{
+		unsigned int blockSize = bytes > SDK_STRING_BLOCK_SIZE ? bytes : SDK_STRING_BLOCK_SIZE;
+		char* pBlock = (char*)malloc(blockSize);
+		if (NULL == pBlock)
+			return NULL;
+		m_blocks.push_back(pBlock);
+		m_nArenaBytes += blockSize;
+		//a long string alone in its block leaves the current one to fill
+		if (blockSize > SDK_STRING_BLOCK_SIZE)
+			return pBlock;
+		m_pCursor = pBlock;
+		m_nBlockLeft = blockSize;
+	}
+	char* p = m_pCursor;
+	m_pCursor += bytes;
+	m_nBlockLeft -= bytes;
+	return p;
+}
+
+void CSDKStringTable::Rehash(size_t bucketCount)
+{
+	m_buckets.assign(bucketCount, 0);
+	size_t mask = bucketCount - 1;
+	for (size_t i = 0; i < m_entries.size(); ++i)
+	{
+		size_t bucket = m_entries[i].hash & mask;
+		while (m_buckets[bucket])
+			bucket = (bucket + 1) & mask;
+		m_buckets[bucket] = (uint32_t)i + 1;
+	}
+}
+
+uint32_t CSDKStringTable::Insert(const char* utf8, unsigned int length)
+{
+	uint32_t hash = HashString(utf8, length);
+	size_t mask = m_buckets.size() - 1;
+	size_t bucket = hash & mask;
+	while (m_buckets[bucket])
+	{
+		const SDKStringEntry& entry = m_entries[m_buckets[bucket] - 1];
+		if (entry.hash == hash && entry.length == length && 0 == memcmp(entry.pData, utf8, length))
+			return m_nFirstHandle + m_buckets[bucket] - 1;
+		bucket = (bucket + 1) & mask;
+	}
+
+	char* pData = Allocate(length + 1);
+	if (NULL == pData)
+		return 0;
+	memcpy(pData, utf8, length);
+	pData[length] = 0;
+	SDKStringEntry entry;
+	entry.pData = pData;
+	entry.length = length;
+	entry.hash = hash;
+	m_entries.push_back(entry);
+	m_buckets[bucket] = (uint32_t)m_entries.size();
+	//kept at most half full so the probes stay short
+	if (m_entries.size() * 2 > m_buckets.size())
+		Rehash(m_buckets.size() * 2);
+	return m_nFirstHandle + (uint32_t)m_entries.size() - 1;
+}
+
+uint32_t CSDKStringTable::Intern(const char* utf8, unsigned int length)
+{
+	if (NULL == utf8)
+		return 0;
+	CMediaAutoLock lock(m_lock);
+	return Insert(utf8, length);
+}
+
+uint32_t CSDKStringTable::Intern(const wchar_t* str)
+{
+	if (NULL == str)
+		return 0;
+	CMediaAutoLock lock(m_lock);
+	//UTF-16 on Windows, UTF-32 elsewhere, both take at most 4 bytes of UTF-8 per wchar_t
+	size_t chars = wcslen(str);
+	if (m_convert.size() < chars * 4)
+		m_convert.resize(chars * 4);
+	char* pOut = m_convert.empty() ? NULL : &m_convert[0];
+	unsigned int length = 0;
+	for (size_t i = 0; i < chars; ++i)
+	{
+		uint32_t code = (uint32_t)str[i];
+		if (code >= 0xD800 && code <= 0xDBFF && i + 1 < chars && (uint32_t)str[i + 1] >= 0xDC00 && (uint32_t)str[i + 1] <= 0xDFFF)
+		{
+			code = 0x10000 + ((code - 0xD800) << 10) + ((uint32_t)str[i + 1] - 0xDC00);
+			++i;
+		}
+		else if ((code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF)
+		{
+			//unpaired surrogate
+			code = 0xFFFD;
+		}
+
+		if (code < 0x80)
+		{
+			pOut[length++] = (char)code;
+		}
+		else if (code < 0x800)
+		{
+			pOut[length++] = (char)(0xC0 | (code >> 6));
+			pOut[length++] = (char)(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000)
+		{
+			pOut[length++] = (char)(0xE0 | (code >> 12));
+			pOut[length++] = (char)(0x80 | ((code >> 6) & 0x3F));
+			pOut[length++] = (char)(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			pOut[length++] = (char)(0xF0 | (code >> 18));
+			pOut[length++] = (char)(0x80 | ((code >> 12) & 0x3F));
+			pOut[length++] = (char)(0x80 | ((code >> 6) & 0x3F));
+			pOut[length++] = (char)(0x80 | (code & 0x3F));
+		}
+	}
+	return Insert(pOut ? pOut : "", length);
+}
+
+const char* CSDKStringTable::GetString(uint32_t handle, unsigned int* pLength)
+{
+	CMediaAutoLock lock(m_lock, true);
+	if (handle < m_nFirstHandle || handle - m_nFirstHandle >= m_entries.size())
+		return NULL;
+	const SDKStringEntry& entry = m_entries[handle - m_nFirstHandle];
+	if (pLength)
+		*pLength = entry.length;
+	return entry.pData;
+}
+
+int CSDKStringTable::CopyString(uint32_t handle, char* pBuffer, unsigned int capacity)
+{
+	CMediaAutoLock lock(m_lock, true);
+	if (handle < m_nFirstHandle || handle - m_nFirstHandle >= m_entries.size())
+		return -1;
+	const SDKStringEntry& entry = m_entries[handle - m_nFirstHandle];
+	if (pBuffer)
+		memcpy(pBuffer, entry.pData, entry.length < capacity ? entry.length : capacity);
+	return (int)entry.length;
+}
+
+unsigned int CSDKStringTable::GetCount()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return (unsigned int)m_entries.size();
+}
+
+unsigned long long CSDKStringTable::GetArenaBytes()
+{
+	CMediaAutoLock lock(m_lock, true);
+	return m_nArenaBytes;
+}
+END_ZOOM_SDK_NAMESPACE
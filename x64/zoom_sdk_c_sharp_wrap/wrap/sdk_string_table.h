@@ -0,0 +1,62 @@
+#pragma once
+#include "rawdata_media_common.h"
+#include <wchar.h>
+#include <vector>
+BEGIN_ZOOM_SDK_NAMESPACE
+//strings are packed into blocks of this size, longer ones get a block of their own
+#define SDK_STRING_BLOCK_SIZE (64 * 1024)
+
+//Session table of the names and device labels handed to the host, as UTF-8 with a stable integer handle per
+//distinct text. The host keeps its own strings by handle and fetches the bytes only for a handle it has not seen,
+//instead of getting a freshly allocated copy on every call. The bytes live in large blocks that are freed together
+//by Reset() when a new session starts. Handles are never reused, so one cached from an earlier session is simply
+//unknown afterwards.
+//Thread safe. Pointers from GetString() stay valid until Reset().
+class CSDKStringTable
+{
+public:
+	static CSDKStringTable& GetInst();
+
+	//handle of the text, 0 for NULL. The same text gets the same handle for the whole session.
+	uint32_t Intern(const wchar_t* str);
+	uint32_t Intern(const char* utf8, unsigned int length);
+	//NUL terminated UTF-8 of the handle, NULL when it is 0 or from an earlier session
+	const char* GetString(uint32_t handle, unsigned int* pLength = NULL);
+	//copies up to capacity bytes without a NUL, returns the length of the string or -1 when the handle is unknown
+	int CopyString(uint32_t handle, char* pBuffer, unsigned int capacity);
+	//frees every string of the session
+	void Reset();
+
+	unsigned int GetCount();
+	//bytes held by the blocks
+	unsigned long long GetArenaBytes();
+
+private:
+	typedef struct tagSDKStringEntry
+	{
+		const char* pData;
+		uint32_t length;
+		uint32_t hash;
+	}SDKStringEntry;
+
+	CSDKStringTable();
+	~CSDKStringTable();
+	CSDKStringTable(const CSDKStringTable&);
+	CSDKStringTable& operator=(const CSDKStringTable&);
+	//with m_lock held
+	uint32_t Insert(const char* utf8, unsigned int length);
+	char* Allocate(unsigned int bytes);
+	void Rehash(size_t bucketCount);
+	void FreeBlocks();
+
+	CMediaLock m_lock;
+	std::vector<char*> m_blocks;
+	char* m_pCursor;
+	unsigned int m_nBlockLeft;
+	unsigned long long m_nArenaBytes;
+	std::vector<SDKStringEntry> m_entries;///<Handle m_nFirstHandle + i.
+	std::vector<uint32_t> m_buckets;///<Open addressed, entry index + 1, 0 when free.
+	uint32_t m_nFirstHandle;
+	std::vector<char> m_convert;///<Scratch for the UTF-8 of wide strings.
+};
+END_ZOOM_SDK_NAMESPACE
@@ -54,11 +54,71 @@ IZoomSDKVideoSourceHelperWrap& CSDKWrap::GetRawdataVideoSourceHelperWrap()
 	return IZoomSDKVideoSourceHelperWrap::GetInst();
 }
 
+CRawDataVirtualCamera& CSDKWrap::GetVirtualCamera()
+{
+	return CRawDataVirtualCamera::GetInst();
+}
+
+CRawDataVideoSendController& CSDKWrap::GetVideoSendController()
+{
+	return CRawDataVideoSendController::GetInst();
+}
+
+CRawDataPreprocessPipeline& CSDKWrap::GetPreprocessPipeline()
+{
+	return CRawDataPreprocessPipeline::GetInst();
+}
+
+IZoomSDKShareSourceHelperWrap& CSDKWrap::GetRawdataShareSourceHelperWrap()
+{
+	return IZoomSDKShareSourceHelperWrap::GetInst();
+}
+
+CRawDataShareSource& CSDKWrap::GetShareSource()
+{
+	return CRawDataShareSource::GetInst();
+}
+
 IZoomSDKAudioRawDataHelperWrap& CSDKWrap::GetAudioRawdataHelperWrap()
 {
 	return IZoomSDKAudioRawDataHelperWrap::GetInst();
 }
 
+CRawDataAudioRingManager& CSDKWrap::GetAudioRingManager()
+{
+	return CRawDataAudioRingManager::GetInst();
+}
+
+CRawDataSpatialMixer& CSDKWrap::GetSpatialMixer()
+{
+	return CRawDataSpatialMixer::GetInst();
+}
+
+CRawDataAudioRecorder& CSDKWrap::GetAudioRecorder()
+{
+	return CRawDataAudioRecorder::GetInst();
+}
+
+CRawDataFixtureWriter& CSDKWrap::GetFixtureWriter()
+{
+	return CRawDataFixtureWriter::GetInst();
+}
+
+CSDKEventQueue& CSDKWrap::GetEventQueue()
+{
+	return CSDKEventQueue::GetInst();
+}
+
+CMeetingParticipantsRoster& CSDKWrap::GetParticipantsRoster()
+{
+	return CMeetingParticipantsRoster::GetInst();
+}
+
+CSDKStringTable& CSDKWrap::GetStringTable()
+{
+	return CSDKStringTable::GetInst();
+}
+
 INetworkConnectionHelperWrap& CSDKWrap::GetNetworkConnectionHelperWrap()
 {
 	return INetworkConnectionHelperWrap::GetInst();
@@ -146,5 +206,27 @@ IZoomSDKRendererWrap& CSDKRendererWrap::GetRendererWrap()
 	return IZoomSDKRendererWrap::GetInst();
 }
 
+CRawDataRendererManager& CSDKRendererWrap::GetRendererManager()
+{
+	return CRawDataRendererManager::GetInst();
+}
+
+CRawDataLODScheduler& CSDKRendererWrap::GetLODScheduler()
+{
+	return CRawDataLODScheduler::GetInst();
+}
+
+CRawDataShareTileStream& CSDKRendererWrap::GetShareTileStream()
+{
+	static CRawDataShareTileStream inst;
+	return inst;
+}
+
+CRawDataAtlasCompositor& CSDKRendererWrap::GetAtlasCompositor()
+{
+	static CRawDataAtlasCompositor inst;
+	return inst;
+}
+
 
 END_ZOOM_SDK_NAMESPACE
\ No newline at end of file
@@ -9,7 +9,21 @@
 #include "customized_resource_helper_wrap.h"
 #include "rawdata_audio_helper_wrap.h"
 #include "rawdata_render_wrap.h"
+#include "rawdata_renderer_manager.h"
+#include "rawdata_lod_scheduler.h"
+#include "rawdata_share_tile_stream.h"
+#include "rawdata_atlas_compositor.h"
 #include "rawdata_video_helper_wrap.h"
+#include "rawdata_share_source_helper_wrap.h"
+#include "rawdata_virtual_camera.h"
+#include "rawdata_video_send_controller.h"
+#include "rawdata_share_source.h"
+#include "rawdata_video_filters.h"
+#include "rawdata_spatial_mixer.h"
+#include "sdk_event_queue.h"
+#include "meeting_participants_roster.h"
+#include "sdk_string_table.h"
+#include "rawdata_fixture.h"
 
 BEGIN_ZOOM_SDK_NAMESPACE
 class CSDKWrap
@@ -25,7 +39,30 @@ public:
 	ISettingServiceWrap& GetSettingServiceWrap();
 
 	IZoomSDKVideoSourceHelperWrap& GetRawdataVideoSourceHelperWrap();
+	//external video source sending frames rendered by the host
+	CRawDataVirtualCamera& GetVirtualCamera();
+	//backs the external video source off while the network is congested
+	CRawDataVideoSendController& GetVideoSendController();
+	//filters applied to the outgoing camera frames
+	CRawDataPreprocessPipeline& GetPreprocessPipeline();
+	IZoomSDKShareSourceHelperWrap& GetRawdataShareSourceHelperWrap();
+	//external share source sending frames rendered by the host
+	CRawDataShareSource& GetShareSource();
 	IZoomSDKAudioRawDataHelperWrap& GetAudioRawdataHelperWrap();
+	//per speaker audio for the host to play from each avatar's position
+	CRawDataAudioRingManager& GetAudioRingManager();
+	//the speakers mixed to stereo from their avatars' positions
+	CRawDataSpatialMixer& GetSpatialMixer();
+	//the meeting mix and the speakers written to WAV files
+	CRawDataAudioRecorder& GetAudioRecorder();
+	//the received video, share and audio recorded to a fixture for replaying without a meeting
+	CRawDataFixtureWriter& GetFixtureWriter();
+	//the sdk callbacks queued for the host to drain once per frame
+	CSDKEventQueue& GetEventQueue();
+	//the participants kept up to date from the callbacks, with the changes since a version
+	CMeetingParticipantsRoster& GetParticipantsRoster();
+	//names and device labels as UTF-8 with a handle per text, for the session
+	CSDKStringTable& GetStringTable();
 
 private:
 	CSDKWrap();
@@ -58,6 +95,14 @@ class CSDKRendererWrap
 public:
 	static CSDKRendererWrap& GetInst();
 	IZoomSDKRendererWrap& GetRendererWrap();
+	//pooled renderers for subscribing to many users at once
+	CRawDataRendererManager& GetRendererManager();
+	//picks the resolution of the manager's subscriptions from on-screen size
+	CRawDataLODScheduler& GetLODScheduler();
+	//the received screen share as dirty tiles
+	CRawDataShareTileStream& GetShareTileStream();
+	//the manager's subscriptions packed into one texture
+	CRawDataAtlasCompositor& GetAtlasCompositor();
 private:
 	CSDKRendererWrap();
 };